@@ -33,12 +33,31 @@ g++ -std=c++17 -DUSE_SFML -Isrc -I"%SFML_PATH%\include" ^
 src/main.cpp ^
 src/Core/Cell.cpp ^
 src/Core/Grid.cpp ^
+src/Core/GridArena.cpp ^
+src/Core/ObstacleMask.cpp ^
+src/Core/StepKernel.cpp ^
+src/Core/QuadTree.cpp ^
 src/Core/GameRules.cpp ^
+src/Core/SoupGenerator.cpp ^
 src/Services/GameService.cpp ^
+src/Services/StepProfiler.cpp ^
+src/Services/AsyncWriter.cpp ^
+src/Services/CheckpointService.cpp ^
+src/Services/ThreadPool.cpp ^
+src/Services/TileQueue.cpp ^
+src/Services/DistributedService.cpp ^
+src/Services/BatchService.cpp ^
+src/Services/CensusService.cpp ^
 src/Services/SoundService.cpp ^
 src/UI/ConsoleUI.cpp ^
+src/UI/HeadlessUI.cpp ^
 src/Input/ConsoleInput.cpp ^
 src/Services/FileService.cpp ^
+src/Services/BlockCodec.cpp ^
+src/Services/GenerationArchive.cpp ^
+src/Services/PatternLibrary.cpp ^
+src/Services/Deflate.cpp ^
+src/Services/FrameExporter.cpp ^
 src/UI/SFMLUI.cpp ^
 src/Input/SFMLInput.cpp ^
 -o bin/GameOfLife.exe ^
@@ -89,12 +108,31 @@ if %errorlevel% equ 0 (
     src/main.cpp ^
     src/Core/Cell.cpp ^
     src/Core/Grid.cpp ^
+    src/Core/GridArena.cpp ^
+    src/Core/ObstacleMask.cpp ^
+    src/Core/StepKernel.cpp ^
+    src/Core/QuadTree.cpp ^
     src/Core/GameRules.cpp ^
+    src/Core/SoupGenerator.cpp ^
     src/Services/GameService.cpp ^
+    src/Services/StepProfiler.cpp ^
+    src/Services/AsyncWriter.cpp ^
+    src/Services/CheckpointService.cpp ^
+    src/Services/ThreadPool.cpp ^
+    src/Services/TileQueue.cpp ^
+    src/Services/DistributedService.cpp ^
+    src/Services/BatchService.cpp ^
+    src/Services/CensusService.cpp ^
     src/Services/SoundService.cpp ^
     src/UI/ConsoleUI.cpp ^
+    src/UI/HeadlessUI.cpp ^
     src/Input/ConsoleInput.cpp ^
     src/Services/FileService.cpp ^
+    src/Services/BlockCodec.cpp ^
+    src/Services/GenerationArchive.cpp ^
+    src/Services/PatternLibrary.cpp ^
+    src/Services/Deflate.cpp ^
+    src/Services/FrameExporter.cpp ^
     src/UI/SFMLUI.cpp ^
     src/Input/SFMLInput.cpp ^
     -o bin/GameOfLife.exe ^
@@ -120,13 +158,22 @@ REM Ensure Catch2 header is available for tests
 echo Ensuring Catch2 header `tests\catch.hpp` is present...
 powershell -Command "if(-not (Test-Path 'tests\\catch.hpp')) { Write-Host 'Downloading catch.hpp...'; Invoke-WebRequest -Uri 'https://raw.githubusercontent.com/catchorg/Catch2/v2.13.10/single_include/catch2/catch.hpp' -OutFile 'tests\\catch.hpp' -UseBasicParsing } else { Write-Host 'catch.hpp already present' }"
 
-g++ -std=c++17 -Isrc -Itests tests/test_game.cpp src/Core/Cell.cpp src/Core/Grid.cpp src/Core/GameRules.cpp src/Services/GameService.cpp src/Services/FileService.cpp -o bin/test_game.exe
+g++ -std=c++17 -Isrc -Itests tests/test_game.cpp src/Core/Cell.cpp src/Core/Grid.cpp src/Core/GridArena.cpp src/Core/ObstacleMask.cpp src/Core/StepKernel.cpp src/Core/QuadTree.cpp src/Core/GameRules.cpp src/Core/SoupGenerator.cpp src/Services/GameService.cpp src/Services/StepProfiler.cpp src/Services/AsyncWriter.cpp src/Services/CheckpointService.cpp src/Services/ThreadPool.cpp src/Services/TileQueue.cpp src/Services/DistributedService.cpp src/Services/BatchService.cpp src/Services/CensusService.cpp src/Services/FileService.cpp src/Services/BlockCodec.cpp src/Services/GenerationArchive.cpp src/Services/PatternLibrary.cpp src/Services/Deflate.cpp src/Services/FrameExporter.cpp -o bin/test_game.exe
 if %errorlevel% equ 0 (
     echo [OK] Unit tests built: bin/test_game.exe
 ) else (
     echo [ERREUR] Unit test build failed
 )
 
+echo.
+echo Building benchmarks...
+g++ -std=c++17 -O2 -Isrc tests/bench_game.cpp src/Core/Cell.cpp src/Core/Grid.cpp src/Core/GridArena.cpp src/Core/ObstacleMask.cpp src/Core/StepKernel.cpp src/Core/QuadTree.cpp src/Core/GameRules.cpp src/Core/SoupGenerator.cpp src/Services/GameService.cpp src/Services/StepProfiler.cpp src/Services/AsyncWriter.cpp src/Services/CheckpointService.cpp src/Services/ThreadPool.cpp src/Services/TileQueue.cpp src/Services/DistributedService.cpp src/Services/BatchService.cpp src/Services/CensusService.cpp src/Services/FileService.cpp src/Services/BlockCodec.cpp src/Services/GenerationArchive.cpp src/Services/PatternLibrary.cpp src/Services/Deflate.cpp src/Services/FrameExporter.cpp -o bin/bench_game.exe
+if %errorlevel% equ 0 (
+    echo [OK] Benchmarks built: bin/bench_game.exe ^(bin\bench_game.exe ^> bench_output.txt^)
+) else (
+    echo [ERREUR] Benchmark build failed
+)
+
 REM Run tests and capture output to a log file
 echo.
 echo Running unit tests and saving output to bin\test_results.txt ...
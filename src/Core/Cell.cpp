@@ -1,4 +1,5 @@
 #include "Cell.h"
+#include <atomic>
 #include <utility>
 #include <stdexcept>
 
@@ -26,8 +27,29 @@ void ObstacleCell::setAlive(bool a) { alive_ = a; }
 Cell::Type ObstacleCell::getType() const { return Type::Obstacle; }
 std::string ObstacleCell::toString() const { return alive_ ? "A" : "D"; }
 
+// Flyweights
+const Cell &Cell::shared(bool alive, Type t) {
+	static const AliveCell aliveCell;
+	static const DeadCell deadCell;
+	static const ObstacleCell aliveObstacle(true);
+	static const ObstacleCell deadObstacle(false);
+	if (t == Type::Obstacle) return alive ? static_cast<const Cell&>(aliveObstacle) : deadObstacle;
+	return alive ? static_cast<const Cell&>(aliveCell) : deadCell;
+}
+
 // Factory implementations
+static thread_local uint64_t tlAllocations = 0;
+static std::atomic<int> countingUsers{0};
+
+static inline void countAllocation() {
+	if (countingUsers.load(std::memory_order_relaxed) > 0) ++tlAllocations;
+}
+
+uint64_t Cell::threadAllocationCount() { return tlAllocations; }
+void Cell::countAllocations(bool on) { countingUsers.fetch_add(on ? 1 : -1, std::memory_order_relaxed); }
+
 std::unique_ptr<Cell> Cell::createDefault(bool alive, Type t) {
+	countAllocation();
 	if (t == Type::Obstacle) {
 		return std::make_unique<ObstacleCell>(alive);
 	}
@@ -35,6 +57,6 @@ std::unique_ptr<Cell> Cell::createDefault(bool alive, Type t) {
 	return std::make_unique<DeadCell>();
 }
 
-std::unique_ptr<Cell> Cell::createAlive() { return std::make_unique<AliveCell>(); }
-std::unique_ptr<Cell> Cell::createDead() { return std::make_unique<DeadCell>(); }
-std::unique_ptr<Cell> Cell::createObstacle(bool alive) { return std::make_unique<ObstacleCell>(alive); }
+std::unique_ptr<Cell> Cell::createAlive() { countAllocation(); return std::make_unique<AliveCell>(); }
+std::unique_ptr<Cell> Cell::createDead() { countAllocation(); return std::make_unique<DeadCell>(); }
+std::unique_ptr<Cell> Cell::createObstacle(bool alive) { countAllocation(); return std::make_unique<ObstacleCell>(alive); }
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <cstdint>
 
 class Cell {
 public:
@@ -13,11 +14,22 @@ public:
     virtual Type getType() const = 0;
     virtual std::string toString() const = 0;
 
-    // Factories
+    // Shared immutable instances (flyweights): one per (alive, type) state,
+    // never freed. Grids store pointers to these instead of owning cells.
+    static const Cell &shared(bool alive, Type t = Type::Normal);
+
+    // Factories (owning copies, for callers that need a mutable cell)
     static std::unique_ptr<Cell> createDefault(bool alive = false, Type t = Type::Normal);
     static std::unique_ptr<Cell> createAlive();
     static std::unique_ptr<Cell> createDead();
     static std::unique_ptr<Cell> createObstacle(bool alive = false);
+
+    // Number of cells allocated by the factories on the calling thread
+    // (thread-local so parallel workers never contend on a shared counter).
+    // Only counted while someone asks for it (an enabled StepProfiler): every
+    // countAllocations(true) is matched by a countAllocations(false).
+    static uint64_t threadAllocationCount();
+    static void countAllocations(bool on);
 };
 
 // Concrete AliveCell - always alive (declaration only)
@@ -1,21 +1,21 @@
 #include "GameRules.h"
+#include <cctype>
 
-static int countAliveNeighbors(const Grid &g, int r, int c) {
+// bit i of a Neighborhood mask -> (row, column) offset
+static const int kNeighborOffsets[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+
+static int countAliveNeighbors(const Grid &g, int r, int c, uint8_t mask = 0xFF) {
 	int rows = g.getR();
 	int cols = g.getC();
 	int cnt = 0;
-	for (int dr = -1; dr <= 1; ++dr) {
-		for (int dc = -1; dc <= 1; ++dc) {
-			if (dr == 0 && dc == 0) continue;
-			int nr = r + dr, nc = c + dc;
-			if (g.isToric()) {
-				// wrap coordinates
-				int wr = ((nr % rows) + rows) % rows;
-				int wc = ((nc % cols) + cols) % cols;
-				if (g.getCell(wr, wc)) ++cnt;
-			} else {
-				if (nr >= 0 && nr < rows && nc >= 0 && nc < cols) if (g.getCell(nr, nc)) ++cnt;
-			}
+	for (int i = 0; i < 8; ++i) {
+		if (!((mask >> i) & 1u)) continue;
+		int nr = r + kNeighborOffsets[i][0], nc = c + kNeighborOffsets[i][1];
+		if (g.getTopology() != Topology::Bounded) {
+			// getCell maps outside positions through the topology
+			if (g.getCell(nr, nc)) ++cnt;
+		} else {
+			if (nr >= 0 && nr < rows && nc >= 0 && nc < cols) if (g.getCell(nr, nc)) ++cnt;
 		}
 	}
 	return cnt;
@@ -30,3 +30,108 @@ bool ConwayRules::computeNextState(const Grid &src, int r, int c) const {
 	if (!cur) return (alive == 3);
 	return (alive == 2 || alive == 3);
 }
+
+bool ConwayRules::lifeLikeMasks(uint16_t &birthMask, uint16_t &surviveMask) const {
+	birthMask = LifeLikeRules::kConwayBirth;
+	surviveMask = LifeLikeRules::kConwaySurvive;
+	return true;
+}
+
+bool LifeLikeRules::computeNextState(const Grid &src, int r, int c) const {
+	if (src.isObstacle(r, c)) return src.getCell(r, c);
+
+	int alive = countAliveNeighbors(src, r, c, hood.maskAt(r, c));
+	uint16_t mask = src.getCell(r, c) ? survive : birth;
+	return (mask >> alive) & 1u;
+}
+
+bool LifeLikeRules::lifeLikeMasks(uint16_t &birthMask, uint16_t &surviveMask) const {
+	birthMask = birth;
+	surviveMask = survive;
+	return true;
+}
+
+static bool parseDigits(const std::string &s, size_t &i, uint16_t &mask) {
+	mask = 0;
+	while (i < s.size() && std::isdigit((unsigned char)s[i])) {
+		int d = s[i] - '0';
+		if (d > 8) return false;
+		mask |= (uint16_t)(1u << d);
+		++i;
+	}
+	return true;
+}
+
+bool Neighborhood::fits(int rows, int cols, Topology t) const {
+	if (layout == Layout::Square) return true;
+	switch (t) {
+		case Topology::Torus: return rows % 2 == 0 && (layout == Layout::Hexagonal || cols % 2 == 0);
+		case Topology::KleinBottle:
+		case Topology::ProjectivePlane: return false;
+		default: return true;
+	}
+}
+
+static int hexDigit(char ch) {
+	if (ch >= '0' && ch <= '9') return ch - '0';
+	if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+	return -1;
+}
+
+// neighbourhood suffix after the last digit group ("" = Moore)
+static bool parseNeighborhood(const std::string &s, size_t i, Neighborhood &n) {
+	std::string rest = s.substr(i);
+	if (rest.empty()) n = Neighborhood::moore();
+	else if (rest == "H" || rest == "h") n = Neighborhood::hexagonal();
+	else if (rest == "V" || rest == "v") n = Neighborhood::vonNeumann();
+	else if (rest == "T" || rest == "t") n = Neighborhood::triangular();
+	else if (rest.size() == 3 && (rest[0] == 'N' || rest[0] == 'n') && hexDigit(rest[1]) >= 0 && hexDigit(rest[2]) >= 0) {
+		n = Neighborhood::custom((uint8_t)(hexDigit(rest[1]) * 16 + hexDigit(rest[2])));
+	}
+	else return false;
+	return true;
+}
+
+bool LifeLikeRules::parse(const std::string &rule, uint16_t &birthMask, uint16_t &surviveMask) {
+	Neighborhood n;
+	return parse(rule, birthMask, surviveMask, n) && n.isMoore();
+}
+
+bool LifeLikeRules::parse(const std::string &rule, uint16_t &birthMask, uint16_t &surviveMask, Neighborhood &n) {
+	size_t slash = rule.find('/');
+	if (slash == std::string::npos) return false;
+	std::string a = rule.substr(0, slash), b = rule.substr(slash + 1);
+	size_t i = 0;
+	if (!a.empty() && (a[0] == 'B' || a[0] == 'b')) {
+		// B.../S...
+		if (b.empty() || (b[0] != 'S' && b[0] != 's')) return false;
+		i = 1;
+		if (!parseDigits(a, i, birthMask) || i != a.size()) return false;
+		i = 1;
+		if (!parseDigits(b, i, surviveMask)) return false;
+		return parseNeighborhood(b, i, n);
+	}
+	// S/B notation: survive digits first
+	if (!parseDigits(a, i, surviveMask) || i != a.size()) return false;
+	i = 0;
+	if (!parseDigits(b, i, birthMask)) return false;
+	return parseNeighborhood(b, i, n);
+}
+
+std::string LifeLikeRules::format(uint16_t birthMask, uint16_t surviveMask, Neighborhood hood) {
+	std::string out = "B";
+	for (int n = 0; n <= 8; ++n) if ((birthMask >> n) & 1u) out += char('0' + n);
+	out += "/S";
+	for (int n = 0; n <= 8; ++n) if ((surviveMask >> n) & 1u) out += char('0' + n);
+	if (hood == Neighborhood::hexagonal()) out += 'H';
+	else if (hood == Neighborhood::triangular()) out += 'T';
+	else if (hood == Neighborhood::vonNeumann()) out += 'V';
+	else if (!hood.isMoore()) {
+		static const char digits[] = "0123456789ABCDEF";
+		out += 'N';
+		out += digits[hood.even >> 4];
+		out += digits[hood.even & 15];
+	}
+	return out;
+}
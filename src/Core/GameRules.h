@@ -1,18 +1,93 @@
 #pragma once
 #include "Grid.h"
+#include <cstdint>
+#include <string>
+
+// Cells counted as neighbours, as masks over the 3x3 block around a cell:
+// bit 0 up-left, 1 up, 2 up-right, 3 left, 4 right, 5 down-left, 6 down,
+// 7 down-right. Square layouts use one mask everywhere (Moore = 0xFF, von
+// Neumann = 0x5A, or any custom mask). Hexagonal boards use the offset-row
+// layout on the square grid (odd rows shifted half a cell right), so even
+// and odd rows see different masks; triangular boards alternate up-pointing
+// (row + column even) and down-pointing triangles, each with its 3 edge
+// neighbours.
+struct Neighborhood {
+    enum class Layout : uint8_t { Square, Hexagonal, Triangular };
+    Layout layout = Layout::Square;
+    uint8_t even = 0xFF;   // even rows (hexagonal), up-pointing cells (triangular)
+    uint8_t odd = 0xFF;
+
+    static Neighborhood moore() { return Neighborhood(); }
+    static Neighborhood vonNeumann() { return custom(0x5A); }
+    static Neighborhood custom(uint8_t mask) { return Neighborhood{Layout::Square, mask, mask}; }
+    static Neighborhood hexagonal() { return Neighborhood{Layout::Hexagonal, 0x7B, 0xDE}; }
+    static Neighborhood triangular() { return Neighborhood{Layout::Triangular, 0x58, 0x1A}; }
+
+    bool isMoore() const { return layout == Layout::Square && even == 0xFF; }
+    // Whether a rows x cols board with topology `t` is still a valid tiling of
+    // this layout. Bounded, reflective and alive borders only fill the halo,
+    // so every size fits. The torus joins opposite edges: hexagonal rows
+    // alternate, so it needs an even row count, and triangles alternate along
+    // both axes, so both counts must be even. The Klein bottle and the
+    // projective plane join edges mirrored, which turns an even hexagonal row
+    // or an up triangle into its opposite: neither layout fits them.
+    // Square layouts fit everything.
+    bool fits(int rows, int cols, Topology t) const;
+    // mask of cell (r, c)
+    uint8_t maskAt(int r, int c) const {
+        int parity = layout == Layout::Triangular ? (r + c) & 1 : layout == Layout::Hexagonal ? r & 1 : 0;
+        return parity ? odd : even;
+    }
+    bool operator==(const Neighborhood &o) const { return layout == o.layout && even == o.even && odd == o.odd; }
+    bool operator!=(const Neighborhood &o) const { return !(*this == o); }
+};
 
 class GameRules {
 public:
     virtual ~GameRules() = default;
     // compute next state for position (r,c) based on `src` grid
     virtual bool computeNextState(const Grid &src, int r, int c) const = 0;
-    
+    // Rules that only depend on the alive-neighbour count report their birth /
+    // survive masks here so whole rows can go through the row kernels (StepKernel::ruleRow)
+    virtual bool lifeLikeMasks(uint16_t &birthMask, uint16_t &surviveMask) const { (void)birthMask; (void)surviveMask; return false; }
+    // cells counted by the masks above; anything but Moore runs the
+    // mask-specialised kernels (StepKernel::maskRow / triangleRow)
+    virtual Neighborhood neighborhood() const { return Neighborhood::moore(); }
 };
 
 // Concrete implementation: Conway's Game of Life
 class ConwayRules : public GameRules {
 public:
     bool computeNextState(const Grid &src, int r, int c) const override;
+    bool lifeLikeMasks(uint16_t &birthMask, uint16_t &surviveMask) const override;
 };
 
+// Generic life-like rule "B<digits>/S<digits>": bit n of `birth` / `survive`
+// is set when a cell with n alive neighbours is born / survives. A suffix
+// picks the neighbourhood: H hexagonal, V von Neumann, T triangular, N<hex>
+// custom mask (e.g. "B2/S34H", "B1/S1V", "B3/S23N5F"); none = Moore.
+class LifeLikeRules : public GameRules {
+public:
+    LifeLikeRules(uint16_t birthMask, uint16_t surviveMask, Neighborhood n = Neighborhood::moore())
+        : birth(birthMask), survive(surviveMask), hood(n) {}
+    bool computeNextState(const Grid &src, int r, int c) const override;
+    bool lifeLikeMasks(uint16_t &birthMask, uint16_t &surviveMask) const override;
+    Neighborhood neighborhood() const override { return hood; }
+
+    uint16_t getBirthMask() const { return birth; }
+    uint16_t getSurviveMask() const { return survive; }
+
+    // Parse "B3/S23" (also accepts "b3/s23" and the "23/3" S/B notation);
+    // the 3-argument form only accepts Moore rules
+    static bool parse(const std::string &rule, uint16_t &birthMask, uint16_t &surviveMask);
+    static bool parse(const std::string &rule, uint16_t &birthMask, uint16_t &surviveMask, Neighborhood &n);
+    static std::string format(uint16_t birthMask, uint16_t surviveMask, Neighborhood n = Neighborhood::moore());
 
+    static constexpr uint16_t kConwayBirth = 1u << 3;
+    static constexpr uint16_t kConwaySurvive = (1u << 2) | (1u << 3);
+
+private:
+    uint16_t birth;
+    uint16_t survive;
+    Neighborhood hood;
+};
@@ -1,145 +1,376 @@
-
 #include "Grid.h"
 #include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
 
-// helper to allocate grid storage
-static std::vector<std::vector<std::unique_ptr<Cell>>> makeCellMatrix(int rows, int cols) {
-    std::vector<std::vector<std::unique_ptr<Cell>>> m;
-    m.resize(rows);
-    for (int r = 0; r < rows; ++r) {
-        m[r].resize(cols);
-        for (int c = 0; c < cols; ++c) {
-            m[r][c] = Cell::createDead();
-        }
+uint64_t Grid::matrixAllocationCount() { return GridArena::allocationCount(); }
+
+// pas d'une ligne : colonnes + 2 cellules de halo, arrondi à 16 octets
+static int strideFor(int c) { return c > 0 ? (c + 2 + 15) / 16 * 16 : 0; }
+
+// taille du bloc : lignes + 2 lignes de halo
+static size_t blockSize(int r, int stride) { return (r > 0 && stride > 0) ? (size_t)(r + 2) * (size_t)stride : 0; }
+
+// (ré)allocation du bloc : l'arène garde l'ancien bloc s'il est assez grand,
+// les cellules (et le halo) repartent toutes mortes
+void Grid::allocate(int r, int c) {
+    rows = r; cols = c;
+    stride = strideFor(c);
+    size_t n = blockSize(r, stride);
+    cells = arena.acquire(n);
+    if (n) std::memset(cells, 0, n);
+    obstacles.reset();
+}
+
+void Grid::allocateUntouched(int r, int c) {
+    rows = r; cols = c;
+    stride = strideFor(c);
+    // un bloc neuf : des pages jamais écrites, placées par le premier thread qui les touche
+    arena.release();
+    cells = arena.acquire(blockSize(r, stride));
+    obstacles.reset();
+}
+
+bool Grid::mapStorage(const std::string &path, int r, int c) {
+    // les pages d'un fichier neuf se lisent à zéro : pas de memset, qui les
+    // rendrait toutes résidentes et sales
+    int s = strideFor(c);
+    obstacles.reset();
+    cells = arena.mapFile(path, blockSize(r, s));
+    if (!cells) {
+        rows = cols = stride = 0;
+        return false;
     }
-    return m;
+    rows = r; cols = c; stride = s;
+    return true;
 }
 
-// Constructeur par défaut (grille NORMAL 20x20)
-Grid::Grid() : rows(20), cols(20), cells(makeCellMatrix(20,20)), toric(false) {}
+void Grid::adviseRows(int r0, int r1, bool needed) const {
+    r0 = std::max(r0, -1);
+    r1 = std::min(r1, rows + 1);
+    if (r0 >= r1) return;
+    arena.advise((size_t)(r0 + 1) * (size_t)stride, (size_t)(r1 - r0) * (size_t)stride, needed);
+}
 
-// Constructeur avec taille prédéfinie
-Grid::Grid(GridSize size) : toric(false) {
+void Grid::release() {
+    arena.release();
+    rows = cols = stride = 0;
+    cells = nullptr;
+    obstacles.reset();
+}
+
+static void dimensionsOf(GridSize size, int &r, int &c) {
     switch (size) {
-        case GridSize::SMALL: rows = 10; cols = 10; break;
-        case GridSize::NORMAL: rows = 20; cols = 20; break;
-        case GridSize::LARGE: rows = 50; cols = 50; break;
-        default: rows = 20; cols = 20; break;
+        case GridSize::SMALL: r = 10; c = 10; break;
+        case GridSize::NORMAL: r = 20; c = 20; break;
+        case GridSize::LARGE: r = 50; c = 50; break;
+        default: r = 20; c = 20; break;
     }
-    cells = makeCellMatrix(rows, cols);
+}
+
+// Constructeur par défaut (grille NORMAL 20x20)
+Grid::Grid() : rows(20), cols(20) { allocate(20, 20); }
+
+// Constructeur avec taille prédéfinie
+Grid::Grid(GridSize size) {
+    dimensionsOf(size, rows, cols);
+    allocate(rows, cols);
 }
 
 // Constructeur avec dimensions personnalisées
-Grid::Grid(int r, int c) : rows(r), cols(c), cells(makeCellMatrix(r,c)), toric(false) {}
+Grid::Grid(int r, int c) : rows(r), cols(c) { allocate(r, c); }
 
 Grid::~Grid() {}
 
 int Grid::getR() const { return rows; }
 int Grid::getC() const { return cols; }
 
-void Grid::setR(int r) { rows = r; cells = makeCellMatrix(rows, cols); }
-void Grid::setC(int c) { cols = c; cells = makeCellMatrix(rows, cols); }
+void Grid::setR(int r) { allocate(r, cols); }
+void Grid::setC(int c) { allocate(rows, c); }
 
 // Redimensionner avec une taille prédéfinie
 void Grid::setGridSize(GridSize size) {
-    switch (size) {
-        case GridSize::SMALL: rows = 10; cols = 10; break;
-        case GridSize::NORMAL: rows = 20; cols = 20; break;
-        case GridSize::LARGE: rows = 50; cols = 50; break;
-        default: rows = 20; cols = 20; break;
-    }
-    cells = makeCellMatrix(rows, cols);
+    int r, c;
+    dimensionsOf(size, r, c);
+    allocate(r, c);
 }
 
 // Redimensionner avec des dimensions précises
-void Grid::setGridDimensions(int r, int c) {
-    rows = r; cols = c; cells = makeCellMatrix(rows, cols);
-}
+void Grid::setGridDimensions(int r, int c) { allocate(r, c); }
 
-// copy ctor / assignment (deep copy)
-Grid::Grid(const Grid &other) : rows(other.rows), cols(other.cols), toric(other.toric) {
-    cells = makeCellMatrix(rows, cols);
-    for (int r = 0; r < rows; ++r) for (int c = 0; c < cols; ++c) {
-        bool alive = other.getCell(r,c);
-        if (other.isObstacle(r,c)) cells[r][c] = Cell::createObstacle(alive);
-        else cells[r][c] = Cell::createDefault(alive, Cell::Type::Normal);
-    }
+// copie : une seule copie en bloc des octets d'état (le bloc de destination est
+// réutilisé si possible) ; la couche d'obstacles est partagée, pas copiée
+Grid::Grid(const Grid &other) : rows(other.rows), cols(other.cols), stride(other.stride), topology(other.topology), obstacles(other.obstacles) {
+    size_t n = blockSize(rows, stride);
+    cells = arena.acquire(n);
+    if (n) std::memcpy(cells, other.cells, n);
 }
 
 Grid& Grid::operator=(const Grid &other) {
     if (this == &other) return *this;
-    rows = other.rows; cols = other.cols; toric = other.toric;
-    cells = makeCellMatrix(rows, cols);
-    for (int r = 0; r < rows; ++r) for (int c = 0; c < cols; ++c) {
-        bool alive = other.getCell(r,c);
-        if (other.isObstacle(r,c)) cells[r][c] = Cell::createObstacle(alive);
-        else cells[r][c] = Cell::createDefault(alive, Cell::Type::Normal);
-    }
+    rows = other.rows; cols = other.cols; stride = other.stride; topology = other.topology;
+    obstacles = other.obstacles;
+    size_t n = blockSize(rows, stride);
+    cells = arena.acquire(n);
+    if (n) std::memcpy(cells, other.cells, n);
+    return *this;
+}
+
+Grid::Grid(Grid &&other) noexcept
+    : rows(other.rows), cols(other.cols), stride(other.stride), arena(std::move(other.arena)), cells(other.cells), topology(other.topology),
+      obstacles(std::move(other.obstacles)) {
+    other.rows = 0; other.cols = 0; other.stride = 0; other.cells = nullptr;
+}
+
+Grid& Grid::operator=(Grid &&other) noexcept {
+    if (this == &other) return *this;
+    rows = other.rows; cols = other.cols; stride = other.stride; topology = other.topology;
+    arena = std::move(other.arena);
+    cells = other.cells;
+    obstacles = std::move(other.obstacles);
+    other.rows = 0; other.cols = 0; other.stride = 0; other.cells = nullptr;
     return *this;
 }
 
+void Grid::swap(Grid &other) noexcept {
+    std::swap(rows, other.rows);
+    std::swap(cols, other.cols);
+    std::swap(stride, other.stride);
+    arena.swap(other.arena);
+    std::swap(cells, other.cells);
+    std::swap(topology, other.topology);
+    obstacles.swap(other.obstacles);
+}
+
+static int wrapIndex(int v, int n) { return ((v % n) + n) % n; }
+
+// nombre de traversées du bord (arrondi vers le bas) : sa parité dit s'il y a miroir
+static int crossings(int v, int n) { return v >= 0 ? v / n : -((n - 1 - v) / n); }
+
+// miroir de période 2n : ..., 1, 0 | 0, 1, ..., n-1 | n-1, n-2, ...
+static int reflectIndex(int v, int n) {
+    int m = wrapIndex(v, 2 * n);
+    return m < n ? m : 2 * n - 1 - m;
+}
+
+bool Grid::wrap(int &x, int &y) const {
+    if (x >= 0 && x < rows && y >= 0 && y < cols) return true;
+    if (rows <= 0 || cols <= 0) return false;
+    switch (topology) {
+        case Topology::Torus:
+            x = wrapIndex(x, rows);
+            y = wrapIndex(y, cols);
+            return true;
+        case Topology::KleinBottle: {
+            bool flip = crossings(x, rows) & 1;
+            x = wrapIndex(x, rows);
+            y = wrapIndex(y, cols);
+            if (flip) y = cols - 1 - y;
+            return true;
+        }
+        case Topology::ProjectivePlane: {
+            bool flipCols = crossings(x, rows) & 1, flipRows = crossings(y, cols) & 1;
+            x = wrapIndex(x, rows);
+            y = wrapIndex(y, cols);
+            if (flipRows) x = rows - 1 - x;
+            if (flipCols) y = cols - 1 - y;
+            return true;
+        }
+        case Topology::Reflective:
+            x = reflectIndex(x, rows);
+            y = reflectIndex(y, cols);
+            return true;
+        default:
+            return false;
+    }
+}
+
 bool Grid::getCell(int x, int y) const {
     if (rows <= 0 || cols <= 0) return false;
-    if (toric) {
-        int rx = ((x % rows) + rows) % rows;
-        int ry = ((y % cols) + cols) % cols;
-        return cells[rx][ry]->isAlive();
+    if (!wrap(x, y)) {
+        if (topology == Topology::AliveBorder) return true;
+        throw std::out_of_range("Grid::getCell index out of range");
     }
-    if (x < 0 || x >= rows || y < 0 || y >= cols) throw std::out_of_range("Grid::getCell index out of range");
-    return cells[x][y]->isAlive();
+    return cells[index(x, y)] & kAlive;
+}
+
+const Cell &Grid::getCellObject(int x, int y) const {
+    if (!wrap(x, y)) throw std::out_of_range("Grid::getCellObject index out of range");
+    bool obs = obstacles && obstacles->test(x, y);
+    return Cell::shared(cells[index(x, y)] & kAlive, obs ? Cell::Type::Obstacle : Cell::Type::Normal);
 }
 
 void Grid::setCell(int x, int y, bool state) {
-    if (toric) {
-        int rx = ((x % rows) + rows) % rows;
-        int ry = ((y % cols) + cols) % cols;
-        x = rx; y = ry;
-    }
-    if (x < 0 || x >= rows || y < 0 || y >= cols) throw std::out_of_range("Grid::setCell index out of range");
-    // if obstacle, modify its alive flag
-    if (cells[x][y]->getType() == Cell::Type::Obstacle) {
-        cells[x][y]->setAlive(state);
-        return;
+    if (!wrap(x, y)) throw std::out_of_range("Grid::setCell index out of range");
+    // obstacles live in their own layer and keep their flag
+    cells[index(x, y)] = state ? kAlive : 0;
+}
+
+void Grid::setToric(bool t) { topology = t ? Topology::Torus : Topology::Bounded; }
+bool Grid::isToric() const { return topology == Topology::Torus; }
+
+bool Grid::parseTopology(const std::string &name, Topology &out) {
+    static const std::pair<const char *, Topology> names[] = {
+        {"bounded", Topology::Bounded}, {"torus", Topology::Torus}, {"toric", Topology::Torus},
+        {"klein", Topology::KleinBottle}, {"projective", Topology::ProjectivePlane},
+        {"reflective", Topology::Reflective}, {"alive", Topology::AliveBorder},
+    };
+    for (const auto &n : names) {
+        if (name == n.first) {
+            out = n.second;
+            return true;
+        }
     }
-    // replace the cell with an appropriate Alive/Dead cell
-    cells[x][y] = Cell::createDefault(state, Cell::Type::Normal);
+    return false;
 }
 
-void Grid::setToric(bool t) { toric = t; }
-bool Grid::isToric() const { return toric; }
+const char *Grid::topologyName(Topology t) {
+    switch (t) {
+        case Topology::Torus: return "torus";
+        case Topology::KleinBottle: return "klein";
+        case Topology::ProjectivePlane: return "projective";
+        case Topology::Reflective: return "reflective";
+        case Topology::AliveBorder: return "alive";
+        default: return "bounded";
+    }
+}
 
 void Grid::setObstacle(int x, int y, bool obs) {
-    if (toric) {
-        int rx = ((x % rows) + rows) % rows;
-        int ry = ((y % cols) + cols) % cols;
-        x = rx; y = ry;
+    if (!wrap(x, y)) throw std::out_of_range("Grid::setObstacle index out of range");
+    if (!obstacles) {
+        if (!obs) return;
+        obstacles = std::make_shared<ObstacleMask>(rows, cols);
+    } else if (obstacles->test(x, y) == obs) {
+        return;
+    } else if (obstacles.use_count() > 1) {
+        // copie sur écriture : une grille qui partage la couche (le tampon de
+        // step(), une copie) garde l'ancienne
+        obstacles = std::make_shared<ObstacleMask>(*obstacles);
     }
-    if (x < 0 || x >= rows || y < 0 || y >= cols) throw std::out_of_range("Grid::setObstacle index out of range");
-    bool alive = cells[x][y]->isAlive();
-    if (obs) cells[x][y] = Cell::createObstacle(alive);
-    else cells[x][y] = Cell::createDefault(alive, Cell::Type::Normal);
+    // la couche n'est visible que par cette grille : elle peut être modifiée en place
+    std::const_pointer_cast<ObstacleMask>(obstacles)->set(x, y, obs);
+    if (obstacles->count() == 0) obstacles.reset();
 }
 
 bool Grid::isObstacle(int x, int y) const {
-    if (toric) {
-        int rx = ((x % rows) + rows) % rows;
-        int ry = ((y % cols) + cols) % cols;
-        return cells[rx][ry]->getType() == Cell::Type::Obstacle;
-    }
-    if (x < 0 || x >= rows || y < 0 || y >= cols) throw std::out_of_range("Grid::isObstacle index out of range");
-    return cells[x][y]->getType() == Cell::Type::Obstacle;
+    if (!wrap(x, y)) throw std::out_of_range("Grid::isObstacle index out of range");
+    return obstacles && obstacles->test(x, y);
+}
+
+void Grid::shareObstacles(const Grid &other) {
+    if (rows != other.rows || cols != other.cols) throw std::invalid_argument("Grid::shareObstacles size mismatch");
+    obstacles = other.obstacles;
 }
 
-// deep equality check
+void Grid::setObstacleLayer(std::shared_ptr<const ObstacleMask> layer) {
+    if (layer && (layer->getR() != rows || layer->getC() != cols)) throw std::invalid_argument("Grid::setObstacleLayer size mismatch");
+    obstacles = layer && layer->count() > 0 ? std::move(layer) : nullptr;
+}
+
+// comparaison octet à octet du bloc d'états
 bool Grid::equals(const Grid &other) const {
     if (rows != other.rows || cols != other.cols) return false;
+    // le halo est dérivé de l'intérieur : seules les cellules réelles sont comparées
     for (int r = 0; r < rows; ++r) {
-        for (int c = 0; c < cols; ++c) {
-            if (isObstacle(r,c) != other.isObstacle(r,c)) return false;
-            if (getCell(r,c) != other.getCell(r,c)) return false;
+        if (std::memcmp(rowPtr(r), other.rowPtr(r), (size_t)cols) != 0) return false;
+    }
+    // entre deux générations la couche est partagée : le test de pointeur suffit
+    if (obstacles == other.obstacles) return true;
+    if (!obstacles || !other.obstacles) return false;
+    return *obstacles == *other.obstacles;
+}
+
+void Grid::loadPackedRows(const uint64_t *words, size_t wordsPerRow, int row0, int col0, int height, int width) {
+    if (row0 < 0 || col0 < 0 || row0 + height > rows || col0 + width > cols) throw std::out_of_range("Grid::loadPackedRows region out of range");
+    for (int r = 0; r < height; ++r) {
+        const uint64_t *src = words + (size_t)r * wordsPerRow;
+        uint8_t *row = rowPtr(row0 + r) + col0;
+        const uint8_t *mask = obstacles ? obstacles->row(row0 + r) : nullptr;
+        for (int c = 0; c < width; ++c) {
+            if (mask && mask[col0 + c]) continue;
+            row[c] = (uint8_t)((src[c / 64] >> (c % 64)) & 1u);
         }
     }
-    return true;
+}
+
+int Grid::population() const {
+    int n = 0;
+    for (int r = 0; r < rows; ++r) {
+        const uint8_t *row = rowPtr(r);
+        for (int c = 0; c < cols; ++c) n += row[c] & kAlive;
+    }
+    return n;
+}
+
+uint64_t Grid::hash() const {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](uint64_t v) { h ^= v; h *= 1099511628211ull; };
+    mix((uint64_t)rows);
+    mix((uint64_t)cols);
+    for (int r = 0; r < rows; ++r) {
+        const uint8_t *row = rowPtr(r);
+        const uint8_t *mask = obstacles ? obstacles->row(r) : nullptr;
+        if (!mask) {
+            for (int c = 0; c < cols; ++c) mix(row[c]);
+        } else {
+            for (int c = 0; c < cols; ++c) mix((uint8_t)(row[c] | (mask[c] & kObstacle)));
+        }
+    }
+    return h;
+}
+
+// halo : le remplissage propre à la topologie, coins compris, pour que le
+// noyau lise les 8 voisins sans test ni modulo ; coût en O(lignes + colonnes)
+void Grid::refreshHalo() {
+    if (rows <= 0 || cols <= 0) return;
+    const size_t width = (size_t)cols + 2;
+    if (topology == Topology::Bounded || topology == Topology::AliveBorder) {
+        const uint8_t v = topology == Topology::AliveBorder ? kAlive : 0;
+        std::memset(rowPtr(-1) - 1, v, width);
+        std::memset(rowPtr(rows) - 1, v, width);
+        for (int r = 0; r < rows; ++r) {
+            uint8_t *row = rowPtr(r);
+            row[-1] = v;
+            row[cols] = v;
+        }
+        return;
+    }
+    // colonnes de halo : bord opposé de la même ligne (tore, Klein), de la
+    // ligne symétrique (projectif) ou la cellule du bord elle-même (miroir)
+    if (topology == Topology::ProjectivePlane) {
+        for (int r = 0; r < rows; ++r) {
+            const uint8_t *mirror = rowPtr(rows - 1 - r);
+            uint8_t *row = rowPtr(r);
+            row[-1] = mirror[cols - 1];
+            row[cols] = mirror[0];
+        }
+    } else if (topology == Topology::Reflective) {
+        for (int r = 0; r < rows; ++r) {
+            uint8_t *row = rowPtr(r);
+            row[-1] = row[0];
+            row[cols] = row[cols - 1];
+        }
+    } else {
+        for (int r = 0; r < rows; ++r) {
+            uint8_t *row = rowPtr(r);
+            row[-1] = row[cols - 1];
+            row[cols] = row[0];
+        }
+    }
+    // lignes de halo : une ligne de bord copiée avec ses colonnes de halo, à
+    // l'envers quand le recollement haut/bas est en miroir ; les coins suivent
+    const bool reflective = topology == Topology::Reflective;
+    const uint8_t *above = rowPtr(reflective ? 0 : rows - 1) - 1;
+    const uint8_t *below = rowPtr(reflective ? rows - 1 : 0) - 1;
+    if (topology == Topology::KleinBottle || topology == Topology::ProjectivePlane) {
+        std::reverse_copy(above, above + width, rowPtr(-1) - 1);
+        std::reverse_copy(below, below + width, rowPtr(rows) - 1);
+    } else {
+        std::memcpy(rowPtr(-1) - 1, above, width);
+        std::memcpy(rowPtr(rows) - 1, below, width);
+    }
 }
 
 // affichage console
@@ -2,7 +2,11 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <string>
 #include "Cell.h"
+#include "GridArena.h"
+#include "ObstacleMask.h"
 
 // Énumération pour les trois tailles de grille prédéfinies
 enum class GridSize {
@@ -11,31 +15,106 @@ enum class GridSize {
     LARGE     // Grande grille: 50x50
 };
 
+// Topologie du plan : ce que voient les cellules du bord au-delà de la grille.
+// Chaque topologie est une façon de remplir le halo (voir refreshHalo), le
+// noyau de calcul ne fait aucune différence entre elles.
+enum class Topology : uint8_t {
+    Bounded = 0,          // cellules mortes autour de la grille
+    Torus = 1,            // bords opposés recollés
+    KleinBottle = 2,      // gauche/droite recollés, haut/bas recollés en miroir (colonnes inversées)
+    ProjectivePlane = 3,  // les deux paires de bords recollées en miroir
+    Reflective = 4,       // miroir sur chaque bord : la cellule du bord se voit elle-même
+    AliveBorder = 5       // cellules vivantes autour de la grille
+};
+
 class Grid {
 
 private:
 
     int rows;
     int cols;
-    std::vector<std::vector<std::unique_ptr<Cell>>> cells;
-    // toric (wrap-around) behavior
-    bool toric = false;
-
-    // Méthode privée pour initialiser la grille
-    void initializeGrid();
+    // un octet d'état par cellule (0 ou kAlive), ligne par ligne, dans un
+    // bloc contigu aligné fourni par l'arène ; l'objet Cell correspondant est
+    // l'instance partagée Cell::shared(état, type).
+    // Le bloc contient (rows + 2) lignes de `stride` octets : une ligne et une
+    // colonne de halo de chaque côté (voir refreshHalo), la cellule (x, y) est
+    // à l'indice (x + 1) * stride + (y + 1).
+    int stride = 0;
+    GridArena arena;
+    uint8_t *cells = nullptr;
+    Topology topology = Topology::Bounded;
+    // obstacles (nullptr = aucun) : couche immuable partagée entre copies,
+    // recopiée à la première modification (voir setObstacle)
+    std::shared_ptr<const ObstacleMask> obstacles;
+
+    // (ré)alloue le bloc pour rows x cols (réutilisé si assez grand) et le remet à zéro
+    void allocate(int r, int c);
+    size_t index(int x, int y) const { return (size_t)(x + 1) * (size_t)stride + (size_t)(y + 1); }
+    // ramène (x, y) dans la grille selon la topologie ; false si la position
+    // reste dehors (grille bornée ou à bord vivant)
+    bool wrap(int &x, int &y) const;
 
 public:
-    // toric control
+    static constexpr uint8_t kAlive = 1;
+    // bit obstacle des encodages d'une cellule sur un octet (fichiers, archives,
+    // hash) ; les octets de la grille elle-même n'ont que kAlive
+    static constexpr uint8_t kObstacle = 2;
+
+    // topologie ; setToric(true / false) = Torus / Bounded
+    void setTopology(Topology t) { topology = t; }
+    Topology getTopology() const { return topology; }
     void setToric(bool t);
     bool isToric() const;
+    // "bounded", "torus", "klein", "projective", "reflective", "alive"
+    static bool parseTopology(const std::string &name, Topology &out);
+    static const char *topologyName(Topology t);
 
     // obstacle accessors
     void setObstacle(int x, int y, bool obs);
     bool isObstacle(int x, int y) const;
+    // couche d'obstacles pour les noyaux (nullptr si la grille n'en a aucun)
+    const ObstacleMask *obstacleMask() const { return obstacles.get(); }
+    std::shared_ptr<const ObstacleMask> obstacleLayer() const { return obstacles; }
+    // reprend la couche de `other` sans la copier (mêmes dimensions requises)
+    void shareObstacles(const Grid &other);
+    void setObstacleLayer(std::shared_ptr<const ObstacleMask> layer);
+    void clearObstacles() { obstacles.reset(); }
 
     // deep equality check for stabilization detection
     bool equals(const Grid &other) const;
 
+    // chargement en bloc depuis des bits compactés (bit c%64 du mot [r*wordsPerRow + c/64]
+    // = cellule (row0+r, col0+c)); les cellules obstacles ne sont pas modifiées
+    void loadPackedRows(const uint64_t *words, size_t wordsPerRow, int row0, int col0, int height, int width);
+
+    // accès direct aux lignes pour les noyaux de calcul : rowPtr(r)[c] est la
+    // cellule (r, c) ; r va de -1 à rows et c de -1 à cols (halo compris)
+    uint8_t *rowPtr(int r) { return cells + (size_t)(r + 1) * (size_t)stride + 1; }
+    const uint8_t *rowPtr(int r) const { return cells + (size_t)(r + 1) * (size_t)stride + 1; }
+    int getStride() const { return stride; }
+    // réserve un bloc neuf pour rows x cols SANS l'initialiser (placement NUMA
+    // « first touch ») : l'appelant doit écrire toutes les lignes de -1 à rows,
+    // sur getStride() octets à partir de rowPtr(r) - 1
+    void allocateUntouched(int r, int c);
+    // place rows x cols (cellules mortes) dans un fichier projeté en mémoire
+    // (GridArena::mapFile) plutôt que sur le tas, pour les grilles plus
+    // grandes que la RAM ; false si la projection échoue (grille alors 0x0)
+    bool mapStorage(const std::string &path, int r, int c);
+    bool isMapped() const { return arena.isMapped(); }
+    // conseils de pagination pour les lignes [r0, r1) d'un bloc projeté (sans
+    // effet sinon) : bientôt lues (needed) ou terminées (écrites puis libérées)
+    void adviseRows(int r0, int r1, bool needed) const;
+    // libère le bloc : la grille devient 0x0
+    void release();
+    // remplit le halo selon la topologie (bords recollés, éventuellement en
+    // miroir, ou valeur fixe) ; à appeler avant de lire les voisins via rowPtr
+    void refreshHalo();
+
+    // nombre de cellules vivantes
+    int population() const;
+    // empreinte (FNV-1a) de l'état vivant/obstacle, pour la détection de période
+    uint64_t hash() const;
+
 public:
     
     // Constructeur par défaut (grille NORMAL 20x20)
@@ -61,14 +140,25 @@ public:
     // Méthode pour redimensionner la grille avec des dimensions précises
     void setGridDimensions(int r, int c);
 
-    bool getCell(int x, int y) const;       // retourne l'état d'une cellule
+    // retourne l'état d'une cellule ; hors de la grille, la position est
+    // ramenée dedans selon la topologie (toujours vivante pour AliveBorder,
+    // std::out_of_range pour Bounded)
+    bool getCell(int x, int y) const;
+    const Cell &getCellObject(int x, int y) const; // cellule partagée (immuable) à cette position
     void setCell(int x, int y, bool state); // modifie l'état d'une cellule
     
-    // copy semantics (deep copy)
+    // copie : une copie en bloc des états
     Grid(const Grid &other);
     Grid& operator=(const Grid &other);
+    // déplacement : le bloc est transféré sans copie, la source devient une grille 0x0
+    Grid(Grid &&other) noexcept;
+    Grid& operator=(Grid &&other) noexcept;
+    void swap(Grid &other) noexcept;
     void print() const;                     // affichage console pour test
 
+    // nombre total de blocs de cellules alloués (instrumentation, voir GridArena)
+    static uint64_t matrixAllocationCount();
+
 };
 
 
@@ -0,0 +1,163 @@
+#include "GridArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<bool> hugePages{false};
+std::atomic<int> countingUsers{0};
+
+void countAllocation(size_t bytes) {
+    if (countingUsers.load(std::memory_order_relaxed) == 0) return;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void *alignedAlloc(size_t alignment, size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, alignment);
+#else
+    void *p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0) return nullptr;
+    return p;
+#endif
+}
+
+void alignedFree(void *p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+GridArena::~GridArena() { release(); }
+
+GridArena::GridArena(GridArena &&other) noexcept : block(other.block), cap(other.cap), mapped(other.mapped) {
+    other.block = nullptr;
+    other.cap = 0;
+    other.mapped = false;
+}
+
+GridArena &GridArena::operator=(GridArena &&other) noexcept {
+    if (this != &other) {
+        release();
+        block = other.block;
+        cap = other.cap;
+        mapped = other.mapped;
+        other.block = nullptr;
+        other.cap = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+void GridArena::swap(GridArena &other) noexcept {
+    std::swap(block, other.block);
+    std::swap(cap, other.cap);
+    std::swap(mapped, other.mapped);
+}
+
+uint8_t *GridArena::acquire(size_t bytes) {
+    if (bytes <= cap && block) return block;
+    release();
+    bool huge = hugePages.load(std::memory_order_relaxed) && bytes >= kHugePage;
+    size_t alignment = huge ? kHugePage : kCacheLine;
+    // round up so the block ends on an alignment boundary too
+    size_t size = (bytes + alignment - 1) / alignment * alignment;
+    if (size == 0) size = alignment;
+    void *p = alignedAlloc(alignment, size);
+    if (!p) throw std::bad_alloc();
+#ifdef __linux__
+    if (huge) madvise(p, size, MADV_HUGEPAGE);
+#endif
+    block = static_cast<uint8_t *>(p);
+    cap = size;
+    countAllocation(size);
+    return block;
+}
+
+void GridArena::release() {
+    if (block && mapped) {
+#ifndef _WIN32
+        munmap(block, cap);
+#endif
+    } else if (block) {
+        alignedFree(block);
+    }
+    block = nullptr;
+    cap = 0;
+    mapped = false;
+}
+
+uint8_t *GridArena::mapFile(const std::string &path, size_t bytes) {
+    release();
+#ifdef _WIN32
+    (void)path;
+    (void)bytes;
+    return nullptr;
+#else
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (bytes + page - 1) / page * page;
+    if (size == 0) size = page;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return nullptr;
+    void *p = MAP_FAILED;
+    // a sparse file: pages read as zero and take disk space only once written
+    if (ftruncate(fd, (off_t)size) == 0) p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ::unlink(path.c_str());
+    if (p == MAP_FAILED) return nullptr;
+    block = static_cast<uint8_t *>(p);
+    cap = size;
+    mapped = true;
+    countAllocation(size);
+    return block;
+#endif
+}
+
+void GridArena::advise(size_t offset, size_t len, bool needed) const {
+#ifdef _WIN32
+    (void)offset;
+    (void)len;
+    (void)needed;
+#else
+    if (!mapped || offset >= cap || len == 0) return;
+    // madvise/msync work on whole pages
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset / page * page;
+    size_t end = std::min(cap, (offset + len + page - 1) / page * page);
+    void *p = block + begin;
+    if (needed) {
+        madvise(p, end - begin, MADV_WILLNEED);
+    } else {
+        // shared file pages stay in the page cache: nothing written is lost
+        msync(p, end - begin, MS_ASYNC);
+        madvise(p, end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+void GridArena::setHugePages(bool enabled) { hugePages.store(enabled, std::memory_order_relaxed); }
+bool GridArena::hugePagesEnabled() { return hugePages.load(std::memory_order_relaxed); }
+
+uint64_t GridArena::allocationCount() { return allocations.load(std::memory_order_relaxed); }
+uint64_t GridArena::bytesAllocated() { return allocatedBytes.load(std::memory_order_relaxed); }
+void GridArena::countAllocations(bool on) { countingUsers.fetch_add(on ? 1 : -1, std::memory_order_relaxed); }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Owner of the single contiguous block backing a Grid.
+// The block is aligned on a cache line (or on a huge page when huge pages are
+// enabled and the block is large enough) and is kept across resizes: acquire()
+// only allocates when the requested size exceeds the current capacity.
+// Global counters record every real allocation so benchmarks can check that
+// steady-state simulation does not allocate.
+class GridArena {
+public:
+    static constexpr size_t kCacheLine = 64;
+    static constexpr size_t kHugePage = 2u * 1024u * 1024u;
+
+    GridArena() = default;
+    ~GridArena();
+    GridArena(const GridArena &) = delete;
+    GridArena &operator=(const GridArena &) = delete;
+    // moving transfers the block, the source is left empty
+    GridArena(GridArena &&other) noexcept;
+    GridArena &operator=(GridArena &&other) noexcept;
+    void swap(GridArena &other) noexcept;
+
+    // Block of at least `bytes` bytes; contents are unspecified after a reallocation
+    uint8_t *acquire(size_t bytes);
+    void release();
+
+    // Replace the block with a zero-filled shared mapping of a new file at
+    // `path` (POSIX mmap), so the operating system pages the grid to disk
+    // instead of needing it all in RAM. The file is unlinked once mapped: its
+    // space is returned when the block is released. Returns null (arena left
+    // empty) if the file cannot be created or mapped, and always on Windows.
+    uint8_t *mapFile(const std::string &path, size_t bytes);
+    bool isMapped() const { return mapped; }
+    // Paging hints for bytes [offset, offset + len) of a mapped block (no-op
+    // otherwise): `needed` starts reading them in ahead of use; !needed starts
+    // writing them back and drops them from this process's resident set.
+    void advise(size_t offset, size_t len, bool needed) const;
+
+    uint8_t *data() { return block; }
+    const uint8_t *data() const { return block; }
+    size_t capacity() const { return cap; }
+
+    // Request transparent huge pages for blocks of at least kHugePage bytes
+    // (Linux madvise; ignored elsewhere). Applies to later allocations.
+    static void setHugePages(bool enabled);
+    static bool hugePagesEnabled();
+
+    // Process-wide counters (all arenas, all threads), only advanced while
+    // counting is on: countAllocations(true) / (false) calls nest, an enabled
+    // StepProfiler holds one
+    static uint64_t allocationCount();
+    static uint64_t bytesAllocated();
+    static void countAllocations(bool on);
+
+private:
+    uint8_t *block = nullptr;
+    size_t cap = 0;
+    bool mapped = false;
+};
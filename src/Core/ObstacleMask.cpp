@@ -0,0 +1,25 @@
+#include "ObstacleMask.h"
+
+ObstacleMask::ObstacleMask(int r, int c)
+    : rows(r > 0 ? r : 0), cols(c > 0 ? c : 0), rowMasks((size_t)rows), rowCounts((size_t)rows, 0) {}
+
+void ObstacleMask::set(int r, int c, bool obstacle) {
+    std::vector<uint8_t> &mask = rowMasks[(size_t)r];
+    if (mask.empty()) {
+        if (!obstacle) return;
+        mask.assign((size_t)cols, 0);
+    }
+    uint8_t &m = mask[(size_t)c];
+    if ((m != 0) == obstacle) return;
+    m = obstacle ? 0xFF : 0;
+    int &n = rowCounts[(size_t)r];
+    n += obstacle ? 1 : -1;
+    if (obstacle) ++total;
+    else --total;
+    // une ligne redevenue libre repasse par le noyau sans masque
+    if (n == 0) std::vector<uint8_t>().swap(mask);
+}
+
+bool ObstacleMask::operator==(const ObstacleMask &other) const {
+    return rows == other.rows && cols == other.cols && total == other.total && rowMasks == other.rowMasks;
+}
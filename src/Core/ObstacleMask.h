@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Couche d'obstacles d'une grille, séparée des états des cellules. Les
+// obstacles ne bougent pas pendant une partie : la couche est partagée telle
+// quelle par la grille courante et le tampon de la génération suivante (voir
+// Grid::shareObstacles) et n'est recopiée qu'au moment où on la modifie.
+// Chaque ligne qui contient au moins un obstacle a un masque d'un octet par
+// colonne (0xFF = obstacle, 0 sinon), aligné sur Grid::rowPtr pour que le
+// noyau l'applique en un seul ET/OU ; les autres lignes n'ont pas de masque
+// et passent par le noyau sans obstacle.
+class ObstacleMask {
+public:
+    ObstacleMask(int rows, int cols);
+
+    int getR() const { return rows; }
+    int getC() const { return cols; }
+
+    // masque de la ligne r (colonnes 0 à cols-1), nullptr si elle n'a aucun obstacle
+    const uint8_t *row(int r) const { return rowMasks[(size_t)r].empty() ? nullptr : rowMasks[(size_t)r].data(); }
+    bool test(int r, int c) const { const uint8_t *m = row(r); return m && m[c]; }
+    void set(int r, int c, bool obstacle);
+    // nombre total d'obstacles
+    size_t count() const { return total; }
+
+    bool operator==(const ObstacleMask &other) const;
+
+private:
+    int rows;
+    int cols;
+    std::vector<std::vector<uint8_t>> rowMasks;
+    std::vector<int> rowCounts;
+    size_t total = 0;
+};
@@ -0,0 +1,189 @@
+#include "QuadTree.h"
+#include "Grid.h"
+
+#include <algorithm>
+
+QuadTree::QuadTree() { clear(); }
+
+void QuadTree::clear() {
+    nodes.assign(1, Node{});
+    index.clear();
+    popCache.assign(1, 0);
+    boxCache.assign(1, Box{});
+    rootId = 0;
+    rootLvl = kLeafLevel;
+}
+
+size_t QuadTree::KeyHash::operator()(const Node &n) const {
+    uint64_t h = n.bits * 0x9e3779b97f4a7c15ull ^ (uint64_t)n.level;
+    for (Id c : n.child) h = (h ^ c) * 0x100000001b3ull;
+    return (size_t)(h ^ (h >> 29));
+}
+
+bool QuadTree::KeyEq::operator()(const Node &a, const Node &b) const {
+    return a.level == b.level && a.bits == b.bits && a.child[0] == b.child[0] && a.child[1] == b.child[1]
+        && a.child[2] == b.child[2] && a.child[3] == b.child[3];
+}
+
+QuadTree::Id QuadTree::intern(const Node &n) {
+    auto it = index.find(n);
+    if (it != index.end()) return it->second;
+    Id id = (Id)nodes.size();
+    nodes.push_back(n);
+    popCache.push_back(UINT64_MAX);
+    boxCache.push_back(Box{});
+    index.emplace(n, id);
+    return id;
+}
+
+QuadTree::Id QuadTree::leaf(uint64_t bits) {
+    if (bits == 0) return 0;
+    Node n;
+    n.bits = bits;
+    return intern(n);
+}
+
+QuadTree::Id QuadTree::node(int lvl, Id nw, Id ne, Id sw, Id se) {
+    if ((nw | ne | sw | se) == 0) return 0;
+    Node n;
+    n.level = lvl;
+    n.child[0] = nw;
+    n.child[1] = ne;
+    n.child[2] = sw;
+    n.child[3] = se;
+    return intern(n);
+}
+
+uint64_t QuadTree::population(Id id) const {
+    if (id == 0) return 0;
+    uint64_t &cached = popCache[id];
+    if (cached != UINT64_MAX) return cached;
+    const Node &n = nodes[id];
+    uint64_t pop = 0;
+    if (n.level == kLeafLevel) {
+        for (uint64_t b = n.bits; b; b &= b - 1) ++pop;
+    } else {
+        for (Id c : n.child) pop += population(c);
+    }
+    cached = pop;
+    return pop;
+}
+
+bool QuadTree::cell(uint64_t row, uint64_t col) const {
+    Id id = rootId;
+    int lvl = rootLvl;
+    if (lvl < 64 && ((row >> lvl) != 0 || (col >> lvl) != 0)) return false;
+    while (id != 0 && lvl > kLeafLevel) {
+        --lvl;
+        int q = (int)(((row >> lvl) & 1) * 2 + ((col >> lvl) & 1));
+        id = nodes[id].child[q];
+    }
+    if (id == 0) return false;
+    return (nodes[id].bits >> ((row & 7) * 8 + (col & 7))) & 1;
+}
+
+const QuadTree::Box &QuadTree::box(Id id) const {
+    Box &cached = boxCache[id];
+    if (cached.valid) return cached;
+    const Node &n = nodes[id];
+    Box b;
+    b.minY = b.minX = UINT64_MAX;
+    if (n.level == kLeafLevel) {
+        for (int r = 0; r < 8; ++r) {
+            uint64_t line = (n.bits >> (r * 8)) & 0xff;
+            if (!line) continue;
+            int first = 0, last = 7;
+            while (!((line >> first) & 1)) ++first;
+            while (!((line >> last) & 1)) --last;
+            b.minY = std::min<uint64_t>(b.minY, r);
+            b.maxY = std::max<uint64_t>(b.maxY, r);
+            b.minX = std::min<uint64_t>(b.minX, first);
+            b.maxX = std::max<uint64_t>(b.maxX, last);
+        }
+    } else {
+        uint64_t half = 1ull << (n.level - 1);
+        for (int q = 0; q < 4; ++q) {
+            if (n.child[q] == 0) continue;
+            const Box &c = box(n.child[q]);
+            uint64_t dy = q >= 2 ? half : 0, dx = (q & 1) ? half : 0;
+            b.minY = std::min(b.minY, c.minY + dy);
+            b.maxY = std::max(b.maxY, c.maxY + dy);
+            b.minX = std::min(b.minX, c.minX + dx);
+            b.maxX = std::max(b.maxX, c.maxX + dx);
+        }
+    }
+    b.valid = true;
+    cached = b;
+    return cached;
+}
+
+bool QuadTree::boundingBox(uint64_t &row0, uint64_t &col0, uint64_t &rows, uint64_t &cols) const {
+    if (rootId == 0) return false;
+    // memoised per node, so shared subtrees are measured once
+    const Box &b = box(rootId);
+    row0 = b.minY;
+    col0 = b.minX;
+    rows = b.maxY - b.minY + 1;
+    cols = b.maxX - b.minX + 1;
+    return true;
+}
+
+QuadTree::Id QuadTree::build(const Grid &g, int r0, int c0, int rows, int cols, int lvl, long long y, long long x) {
+    long long side = 1LL << lvl;
+    if (y >= rows || x >= cols || y + side <= 0 || x + side <= 0) return 0;
+    if (lvl == kLeafLevel) {
+        uint64_t bits = 0;
+        for (int r = 0; r < 8; ++r) {
+            long long gy = y + r;
+            if (gy >= rows) break;
+            const uint8_t *row = g.rowPtr(r0 + (int)gy) + c0;
+            for (int c = 0; c < 8 && x + c < cols; ++c) {
+                if (row[x + c] & Grid::kAlive) bits |= 1ull << (r * 8 + c);
+            }
+        }
+        return leaf(bits);
+    }
+    long long half = side / 2;
+    Id nw = build(g, r0, c0, rows, cols, lvl - 1, y, x);
+    Id ne = build(g, r0, c0, rows, cols, lvl - 1, y, x + half);
+    Id sw = build(g, r0, c0, rows, cols, lvl - 1, y + half, x);
+    Id se = build(g, r0, c0, rows, cols, lvl - 1, y + half, x + half);
+    return node(lvl, nw, ne, sw, se);
+}
+
+void QuadTree::fromGrid(const Grid &g, int r0, int c0, int rows, int cols) {
+    clear();
+    int lvl = kLeafLevel;
+    while ((1LL << lvl) < rows || (1LL << lvl) < cols) ++lvl;
+    setRoot(build(g, r0, c0, rows, cols, lvl, 0, 0), lvl);
+}
+
+void QuadTree::paintNode(Grid &g, Id id, uint64_t y, uint64_t x, uint64_t originRow, uint64_t originCol) const {
+    if (id == 0) return;
+    const Node &n = nodes[id];
+    // inclusive last row / column, so a level-63 node does not overflow
+    uint64_t last = (1ull << n.level) - 1;
+    if (y + last < originRow || x + last < originCol) return;
+    if (y >= originRow + (uint64_t)g.getR() || x >= originCol + (uint64_t)g.getC()) return;
+    if (n.level == kLeafLevel) {
+        for (uint64_t b = n.bits; b; b &= b - 1) {
+            int bit = __builtin_ctzll(b);
+            uint64_t ty = y + (uint64_t)(bit / 8), tx = x + (uint64_t)(bit % 8);
+            if (ty < originRow || tx < originCol) continue;
+            uint64_t gy = ty - originRow, gx = tx - originCol;
+            if (gy < (uint64_t)g.getR() && gx < (uint64_t)g.getC()) g.setCell((int)gy, (int)gx, true);
+        }
+        return;
+    }
+    uint64_t half = (last >> 1) + 1;
+    paintNode(g, n.child[0], y, x, originRow, originCol);
+    paintNode(g, n.child[1], y, x + half, originRow, originCol);
+    paintNode(g, n.child[2], y + half, x, originRow, originCol);
+    paintNode(g, n.child[3], y + half, x + half, originRow, originCol);
+}
+
+bool QuadTree::paint(Grid &g, uint64_t originRow, uint64_t originCol) const {
+    if (rootLvl < kLeafLevel || rootLvl > 63) return false;
+    paintNode(g, rootId, 0, 0, originRow, originCol);
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Grid;
+
+// Hash-consed quadtree of a two-state board (the structure behind the
+// macrocell format). A node of level L covers 2^L x 2^L cells; level 3 nodes
+// are 8x8 leaves stored as one 64-bit mask (bit r * 8 + c). Every distinct
+// subtree exists once: node() and leaf() return the id of an existing
+// identical node when there is one, so repeated structure costs nothing.
+// Id 0 is the empty node of any level.
+class QuadTree {
+public:
+    using Id = uint32_t;
+    static constexpr int kLeafLevel = 3;
+
+    QuadTree();
+
+    // canonical ids (0 when empty)
+    Id leaf(uint64_t bits);
+    Id node(int level, Id nw, Id ne, Id sw, Id se);
+
+    int level(Id id) const { return nodes[id].level; }
+    uint64_t leafBits(Id id) const { return nodes[id].bits; }
+    Id child(Id id, int quadrant) const { return nodes[id].child[quadrant]; }   // 0 nw, 1 ne, 2 sw, 3 se
+
+    // the whole pattern: root id and its level (its side is 2^rootLevel)
+    void setRoot(Id id, int lvl) { rootId = id; rootLvl = lvl; }
+    Id root() const { return rootId; }
+    int rootLevel() const { return rootLvl; }
+
+    // distinct nodes, the empty node included
+    size_t nodeCount() const { return nodes.size(); }
+    // live cells under a node (memoised)
+    uint64_t population(Id id) const;
+    bool cell(uint64_t row, uint64_t col) const;
+
+    // Smallest rectangle holding every live cell of the root; false if empty
+    bool boundingBox(uint64_t &row0, uint64_t &col0, uint64_t &rows, uint64_t &cols) const;
+
+    // Root = rows x cols region of `g` starting at (r0, c0), at the smallest
+    // level (>= 3) that covers it; obstacles are not represented
+    void fromGrid(const Grid &g, int r0, int c0, int rows, int cols);
+    // Set the live cells of the pattern in `g`, tree cell (y, x) going to
+    // grid cell (y - originRow, x - originCol); cells outside `g` are skipped.
+    // Any root level works (the origin is usually the bounding box corner of
+    // a pattern far out on a level-63 plane); false only for an invalid level.
+    bool paint(Grid &g, uint64_t originRow, uint64_t originCol) const;
+
+    void clear();
+
+private:
+    struct Node {
+        int level = kLeafLevel;
+        Id child[4] = {0, 0, 0, 0};
+        uint64_t bits = 0;
+    };
+    struct KeyHash {
+        size_t operator()(const Node &n) const;
+    };
+    struct KeyEq {
+        bool operator()(const Node &a, const Node &b) const;
+    };
+
+    Id intern(const Node &n);
+    Id build(const Grid &g, int r0, int c0, int rows, int cols, int lvl, long long y, long long x);
+    // (y, x): the node's corner in tree coordinates
+    void paintNode(Grid &g, Id id, uint64_t y, uint64_t x, uint64_t originRow, uint64_t originCol) const;
+    // bounding box of the live cells of a node, relative to its corner
+    struct Box {
+        bool valid = false;
+        uint64_t minY = 0, minX = 0, maxY = 0, maxX = 0;
+    };
+    const Box &box(Id id) const;
+
+    std::vector<Node> nodes;
+    std::unordered_map<Node, Id, KeyHash, KeyEq> index;
+    mutable std::vector<uint64_t> popCache;     // UINT64_MAX = not computed yet
+    mutable std::vector<Box> boxCache;
+    Id rootId = 0;
+    int rootLvl = kLeafLevel;
+};
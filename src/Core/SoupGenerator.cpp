@@ -0,0 +1,153 @@
+#include "SoupGenerator.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+inline uint64_t splitmix64(uint64_t &x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Four independent xoshiro256** streams stored lane-major (structure of
+// arrays) so the per-lane loop below compiles to SIMD on SSE2/AVX2 targets.
+struct Xoshiro4 {
+    uint64_t s0[4], s1[4], s2[4], s3[4];
+
+    Xoshiro4(uint64_t seed, uint64_t stream) {
+        uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (int l = 0; l < 4; ++l) {
+            s0[l] = splitmix64(x);
+            s1[l] = splitmix64(x);
+            s2[l] = splitmix64(x);
+            s3[l] = splitmix64(x);
+        }
+    }
+
+    void next4(uint64_t *out) {
+        for (int l = 0; l < 4; ++l) {
+            out[l] = rotl(s1[l] * 5, 7) * 9;
+            uint64_t t = s1[l] << 17;
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = rotl(s3[l], 45);
+        }
+    }
+};
+
+// Bit-sliced "random 16-bit value < threshold" for 64 cells at once.
+// planes[k] holds bit (15 - k) of the 64 random values; only the planes up to
+// the threshold's lowest set bit matter, so density 0.5 costs one word.
+inline uint64_t belowThreshold(const uint64_t *planes, uint32_t threshold, int nPlanes) {
+    uint64_t lt = 0, eq = ~0ull;
+    for (int k = 0; k < nPlanes; ++k) {
+        uint64_t r = planes[k];
+        if ((threshold >> (15 - k)) & 1u) { lt |= eq & ~r; eq &= r; }
+        else eq &= ~r;
+    }
+    return lt;
+}
+
+inline bool getBit(const std::vector<uint64_t> &bits, size_t wpr, int r, int c) {
+    return (bits[(size_t)r * wpr + (size_t)c / 64] >> (c % 64)) & 1u;
+}
+
+inline void putBit(std::vector<uint64_t> &bits, size_t wpr, int r, int c, bool v) {
+    uint64_t &w = bits[(size_t)r * wpr + (size_t)c / 64];
+    uint64_t m = 1ull << (c % 64);
+    w = v ? (w | m) : (w & ~m);
+}
+
+// Make the pattern invariant under the symmetry group: every cell copies the
+// cell of its orbit with the smallest index (visited first, hence already final).
+void symmetrize(std::vector<uint64_t> &bits, size_t wpr, int h, int w, SoupSymmetry sym) {
+    for (int r = 0; r < h; ++r) {
+        for (int c = 0; c < w; ++c) {
+            int img[8][2];
+            int n = 0;
+            img[n][0] = h - 1 - r; img[n][1] = w - 1 - c; ++n;               // 180°
+            if (sym == SoupSymmetry::C4 || sym == SoupSymmetry::D8) {
+                img[n][0] = c; img[n][1] = w - 1 - r; ++n;                   // 90°
+                img[n][0] = h - 1 - c; img[n][1] = r; ++n;                   // 270°
+            }
+            if (sym == SoupSymmetry::D8) {
+                img[n][0] = r; img[n][1] = w - 1 - c; ++n;                   // mirror columns
+                img[n][0] = h - 1 - r; img[n][1] = c; ++n;                   // mirror rows
+                img[n][0] = c; img[n][1] = r; ++n;                           // main diagonal
+                img[n][0] = w - 1 - c; img[n][1] = h - 1 - r; ++n;           // anti-diagonal
+            }
+            int br = r, bc = c;
+            for (int i = 0; i < n; ++i) {
+                if (img[i][0] < br || (img[i][0] == br && img[i][1] < bc)) { br = img[i][0]; bc = img[i][1]; }
+            }
+            if (br != r || bc != c) putBit(bits, wpr, r, c, getBit(bits, wpr, br, bc));
+        }
+    }
+}
+
+} // namespace
+
+std::vector<uint64_t> SoupGenerator::generateBits(int height, int width, uint64_t seed, double density,
+                                                  SoupSymmetry symmetry, size_t &wordsPerRow) {
+    wordsPerRow = width > 0 ? ((size_t)width + 63) / 64 : 0;
+    std::vector<uint64_t> bits(height > 0 ? (size_t)height * wordsPerRow : 0, 0);
+    if (bits.empty()) return bits;
+
+    density = std::min(1.0, std::max(0.0, density));
+    uint32_t threshold = (uint32_t)std::lround(density * 65536.0);
+    uint64_t tailMask = (width % 64) ? ((1ull << (width % 64)) - 1) : ~0ull;
+    int nPlanes = 0;
+    if (threshold > 0 && threshold < 65536) {
+        int tz = 0;
+        while (!((threshold >> tz) & 1u)) ++tz;
+        nPlanes = 16 - tz;
+    }
+
+    std::vector<uint64_t> planes(((wordsPerRow * (size_t)std::max(nPlanes, 1)) + 3) & ~(size_t)3);
+    for (int r = 0; r < height; ++r) {
+        uint64_t *row = &bits[(size_t)r * wordsPerRow];
+        if (threshold >= 65536) {
+            std::fill(row, row + wordsPerRow, ~0ull);
+        } else if (threshold > 0) {
+            Xoshiro4 rng(seed, (uint64_t)r);
+            for (size_t i = 0; i < planes.size(); i += 4) rng.next4(&planes[i]);
+            for (size_t w = 0; w < wordsPerRow; ++w) row[w] = belowThreshold(&planes[w * nPlanes], threshold, nPlanes);
+        }
+        row[wordsPerRow - 1] &= tailMask;
+    }
+
+    if (symmetry != SoupSymmetry::NONE) symmetrize(bits, wordsPerRow, height, width, symmetry);
+    return bits;
+}
+
+bool SoupGenerator::fill(Grid &g, const SoupOptions &opt) {
+    int r0 = std::max(0, opt.row), c0 = std::max(0, opt.col);
+    int h = opt.height < 0 ? g.getR() - r0 : std::min(opt.height, g.getR() - r0);
+    int w = opt.width < 0 ? g.getC() - c0 : std::min(opt.width, g.getC() - c0);
+    if (h <= 0 || w <= 0) return false;
+    if ((opt.symmetry == SoupSymmetry::C4 || opt.symmetry == SoupSymmetry::D8) && h != w) return false;
+
+    size_t wpr = 0;
+    std::vector<uint64_t> bits = generateBits(h, w, opt.seed, opt.density, opt.symmetry, wpr);
+    g.loadPackedRows(bits.data(), wpr, r0, c0, h, w);
+    return true;
+}
+
+bool SoupGenerator::parseSymmetry(const std::string &name, SoupSymmetry &out) {
+    std::string n = name;
+    for (auto &ch : n) ch = (char)std::toupper((unsigned char)ch);
+    if (n.empty() || n == "NONE" || n == "C1") out = SoupSymmetry::NONE;
+    else if (n == "C2") out = SoupSymmetry::C2;
+    else if (n == "C4") out = SoupSymmetry::C4;
+    else if (n == "D8") out = SoupSymmetry::D8;
+    else return false;
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Grid.h"
+
+// Soup symmetries: none, 180° rotation (C2), 90° rotation (C4, square region)
+// or the full dihedral group (D8, square region)
+enum class SoupSymmetry { NONE, C2, C4, D8 };
+
+struct SoupOptions {
+    uint64_t seed = 0;
+    double density = 0.5;          // probability of a live cell (1/65536 resolution)
+    SoupSymmetry symmetry = SoupSymmetry::NONE;
+    // region to fill; height/width < 0 = up to the grid edge
+    int row = 0;
+    int col = 0;
+    int height = -1;
+    int width = -1;
+};
+
+// Reproducible random soup generator.
+// Every row has its own 4-lane xoshiro256** stream (independent of the other
+// rows and of the region size), and cells are produced 64 at a time by a
+// bit-sliced comparison against the density, so packed words are written
+// directly instead of drawing one random number per cell.
+class SoupGenerator {
+public:
+    // Row-major packed bits: bit (c % 64) of word [r * wordsPerRow + c / 64] is cell (r, c)
+    static std::vector<uint64_t> generateBits(int height, int width, uint64_t seed, double density,
+                                              SoupSymmetry symmetry, size_t &wordsPerRow);
+
+    // Fill the region of `g` described by `opt` (obstacles are left untouched).
+    // Returns false for an empty region or C4/D8 on a non-square region.
+    static bool fill(Grid &g, const SoupOptions &opt);
+
+    static bool parseSymmetry(const std::string &name, SoupSymmetry &out);
+};
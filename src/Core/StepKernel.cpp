@@ -0,0 +1,157 @@
+#include "StepKernel.h"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+namespace StepKernel {
+
+namespace {
+
+template <unsigned Mask, bool Masked>
+void maskRowImpl(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out,
+                 int cols, uint32_t birthMask, uint32_t surviveMask, const uint8_t *obstacles) {
+    for (int c = 0; c < cols; ++c) {
+        // the compiler folds away every neighbour whose bit is clear
+        uint32_t n = 0;
+        if (Mask & 0x01u) n += up[c - 1];
+        if (Mask & 0x02u) n += up[c];
+        if (Mask & 0x04u) n += up[c + 1];
+        if (Mask & 0x08u) n += mid[c - 1];
+        if (Mask & 0x10u) n += mid[c + 1];
+        if (Mask & 0x20u) n += down[c - 1];
+        if (Mask & 0x40u) n += down[c];
+        if (Mask & 0x80u) n += down[c + 1];
+        uint32_t alive = mid[c];
+        uint32_t mask = birthMask ^ ((birthMask ^ surviveMask) & (0u - alive));
+        uint32_t next = (mask >> n) & 1u;
+        if (Masked) {
+            uint32_t keep = obstacles[c];
+            next = (alive & keep) | (next & ~keep);
+        }
+        out[c] = (uint8_t)next;
+    }
+}
+
+// up-pointing triangles (0x58) see left, right and the cell below; down-pointing
+// ones (0x1A) left, right and the cell above
+template <int Phase, bool Masked>
+void triangleRowImpl(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out,
+                     int cols, uint32_t birthMask, uint32_t surviveMask, const uint8_t *obstacles) {
+    for (int c = 0; c < cols; ++c) {
+        uint32_t pointsDown = (uint32_t)(c + Phase) & 1u;
+        uint32_t pick = 0u - pointsDown;
+        uint32_t n = (uint32_t)mid[c - 1] + mid[c + 1] + ((down[c] & ~pick) | (up[c] & pick));
+        uint32_t alive = mid[c];
+        uint32_t mask = birthMask ^ ((birthMask ^ surviveMask) & (0u - alive));
+        uint32_t next = (mask >> n) & 1u;
+        if (Masked) {
+            uint32_t keep = obstacles[c];
+            next = (alive & keep) | (next & ~keep);
+        }
+        out[c] = (uint8_t)next;
+    }
+}
+
+// 1 when n is one of the counts in Set: an OR of one compare per set bit,
+// expanded at compile time
+template <uint32_t Set, std::size_t... Counts>
+inline uint8_t inSet(uint8_t n, std::index_sequence<Counts...>) {
+    return (uint8_t)(0 | ... | (((Set >> Counts) & 1u) ? (uint8_t)(n == Counts) : (uint8_t)0));
+}
+
+template <uint32_t Set>
+inline uint8_t inSet(uint8_t n) {
+    return inSet<Set>(n, std::make_index_sequence<9>());
+}
+
+template <uint32_t Birth, uint32_t Survive, bool Masked>
+inline uint8_t ruleCell(const uint8_t *up, const uint8_t *mid, const uint8_t *down, const uint8_t *obstacles, int c) {
+    uint8_t n = (uint8_t)(up[c - 1] + up[c] + up[c + 1] + mid[c - 1] + mid[c + 1] + down[c - 1] + down[c] + down[c + 1]);
+    uint8_t alive = mid[c];
+    uint8_t next = (uint8_t)((inSet<Birth>(n) & (alive ^ 1u)) | (inSet<Survive>(n) & alive));
+    if (Masked) {
+        uint8_t keep = obstacles[c];
+        next = (uint8_t)((alive & keep) | (next & ~keep));
+    }
+    return next;
+}
+
+// Fixed-size blocks of 16 cells: at -O2 GCC only vectorises loops whose trip
+// count it knows, so the block loop becomes straight SIMD code and the tail
+// runs cell by cell. `out` never aliases the input rows (it is the other grid).
+template <uint32_t Birth, uint32_t Survive, bool Masked>
+void ruleRowImpl(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *__restrict out,
+                 int cols, uint32_t, uint32_t, const uint8_t *obstacles) {
+    constexpr int kBlock = 16;
+    int c = 0;
+    for (; c + kBlock <= cols; c += kBlock) {
+        for (int j = 0; j < kBlock; ++j) out[c + j] = ruleCell<Birth, Survive, Masked>(up, mid, down, obstacles, c + j);
+    }
+    for (; c < cols; ++c) out[c] = ruleCell<Birth, Survive, Masked>(up, mid, down, obstacles, c);
+}
+
+template <bool Masked>
+void genericRow(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out,
+                int cols, uint32_t birthMask, uint32_t surviveMask, const uint8_t *obstacles) {
+    lifeRowImpl<Masked>(up, mid, down, out, cols, birthMask, surviveMask, obstacles);
+}
+
+constexpr uint16_t bits(std::initializer_list<int> counts) {
+    uint16_t m = 0;
+    for (int n : counts) m |= (uint16_t)(1u << n);
+    return m;
+}
+
+struct FixedRule {
+    uint16_t birth, survive;
+    RowKernel plain, masked;
+};
+
+template <uint16_t Birth, uint16_t Survive>
+constexpr FixedRule fixedRule() {
+    return FixedRule{Birth, Survive, &ruleRowImpl<Birth, Survive, false>, &ruleRowImpl<Birth, Survive, true>};
+}
+
+const FixedRule kFixedRules[] = {
+    fixedRule<bits({3}), bits({2, 3})>(),                           // Conway, B3/S23
+    fixedRule<bits({3, 6}), bits({2, 3})>(),                        // HighLife, B36/S23
+    fixedRule<bits({2}), 0>(),                                      // Seeds, B2/S
+    fixedRule<bits({3, 6, 7, 8}), bits({3, 4, 6, 7, 8})>(),         // Day & Night, B3678/S34678
+};
+
+template <bool Masked, std::size_t... Masks>
+constexpr std::array<RowKernel, sizeof...(Masks)> makeTable(std::index_sequence<Masks...>) {
+    return {{&maskRowImpl<(unsigned)Masks, Masked>...}};
+}
+
+const std::array<RowKernel, 256> kPlain = makeTable<false>(std::make_index_sequence<256>());
+const std::array<RowKernel, 256> kMasked = makeTable<true>(std::make_index_sequence<256>());
+
+} // namespace
+
+RowKernel ruleRow(uint16_t birthMask, uint16_t surviveMask, bool masked) {
+    for (const FixedRule &rule : kFixedRules) {
+        if (rule.birth == birthMask && rule.survive == surviveMask) return masked ? rule.masked : rule.plain;
+    }
+    return masked ? &genericRow<true> : &genericRow<false>;
+}
+
+bool hasSpecialisedRule(uint16_t birthMask, uint16_t surviveMask) {
+    for (const FixedRule &rule : kFixedRules) {
+        if (rule.birth == birthMask && rule.survive == surviveMask) return true;
+    }
+    return false;
+}
+
+RowKernel maskRow(uint8_t mask, bool masked) {
+    return masked ? kMasked[mask] : kPlain[mask];
+}
+
+RowKernel triangleRow(int phase, bool masked) {
+    if (phase & 1) return masked ? &triangleRowImpl<1, true> : &triangleRowImpl<1, false>;
+    return masked ? &triangleRowImpl<0, true> : &triangleRowImpl<0, false>;
+}
+
+} // namespace StepKernel
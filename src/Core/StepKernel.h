@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+// Inner loop of a life-like generation over Grid rows with a fresh halo
+// (Grid::refreshHalo): `up`, `mid` and `down` point at column 0 of rows r-1,
+// r and r+1, and indices -1 and `cols` are valid. No modulo, no bounds checks
+// and no data-dependent branches, so compilers can vectorise it.
+//
+// Cell bytes are 0 or 1 (Grid::kAlive). Obstacles come as the row's
+// ObstacleMask bytes (0xFF = obstacle), nullptr for rows without any: they
+// keep their state through one AND/OR, and every alive cell, obstacle or
+// not, counts as a neighbour.
+namespace StepKernel {
+
+// a row kernel behind a pointer, resolved once and called for every row
+using RowKernel = void (*)(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out,
+                           int cols, uint32_t birthMask, uint32_t surviveMask, const uint8_t *obstacles);
+
+template <bool Masked>
+inline void lifeRowImpl(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out,
+                        int cols, uint32_t birthMask, uint32_t surviveMask, const uint8_t *obstacles) {
+    for (int c = 0; c < cols; ++c) {
+        uint32_t n = (uint32_t)up[c - 1] + up[c] + up[c + 1] + mid[c - 1] + mid[c + 1]
+                   + down[c - 1] + down[c] + down[c + 1];
+        uint32_t alive = mid[c];
+        // survive mask for live cells, birth mask for dead ones
+        uint32_t mask = birthMask ^ ((birthMask ^ surviveMask) & (0u - alive));
+        uint32_t next = (mask >> n) & 1u;
+        if (Masked) {
+            uint32_t keep = obstacles[c];
+            next = (alive & keep) | (next & ~keep);
+        }
+        out[c] = (uint8_t)next;
+    }
+}
+
+inline void lifeRow(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out,
+                    int cols, uint32_t birthMask, uint32_t surviveMask, const uint8_t *obstacles = nullptr) {
+    if (obstacles) lifeRowImpl<true>(up, mid, down, out, cols, birthMask, surviveMask, obstacles);
+    else lifeRowImpl<false>(up, mid, down, out, cols, birthMask, surviveMask, nullptr);
+}
+
+// Moore kernel for one rule. The common rules (B3/S23, B36/S23, B2/S,
+// B3678/S34678) get an instantiation with their masks as template arguments:
+// the birth / survive test becomes a few byte compares the compiler can
+// vectorise, and the birthMask / surviveMask arguments are ignored. Any other
+// rule gets lifeRow, which shifts the masks as a lookup table per cell.
+RowKernel ruleRow(uint16_t birthMask, uint16_t surviveMask, bool masked);
+bool hasSpecialisedRule(uint16_t birthMask, uint16_t surviveMask);
+
+// Same contract as lifeRow for the other neighbourhoods (see Neighborhood in
+// GameRules.h). Each mask gets its own instantiation, so the unused
+// neighbours drop out of the sum at compile time instead of being tested per
+// cell.
+
+// kernel counting the neighbours in `mask` (bit order of Neighborhood)
+RowKernel maskRow(uint8_t mask, bool masked);
+// triangular neighbourhood: column c is up-pointing when (c + phase) is even,
+// i.e. phase = (row + first column) & 1
+RowKernel triangleRow(int phase, bool masked);
+
+} // namespace StepKernel
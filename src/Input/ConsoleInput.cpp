@@ -80,18 +80,18 @@ bool ConsoleInput::handleInput(GameService &service, bool &quit) {
             service.reset(); return true;
 
         case '1':
-            service.setGridSize(GridSize::SMALL); return true;
+            service.postGridSize(GridSize::SMALL); return true;
 
         case '2':
-            service.setGridSize(GridSize::NORMAL); return true;
+            service.postGridSize(GridSize::NORMAL); return true;
 
         case '3':
-            service.setGridSize(GridSize::LARGE); return true;
+            service.postGridSize(GridSize::LARGE); return true;
 
         case '0': case '4': case '5':
         case '6': case '7': case '8': case '9': {
             int slot = ch - '0';
-            service.loadPreset(slot);
+            service.postPreset(slot);
             return true;
         }
 
@@ -3,6 +3,9 @@
 #include "../Services/SoundService.h"
 #include <iostream>
 #include <optional>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
 
 void SFMLInput::setUIContext(sf::RenderWindow* win,
                       const sf::RectangleShape* playBtn, const sf::RectangleShape* exitBtn,
@@ -29,6 +32,39 @@ bool SFMLInput::handleEvent(GameService& service, sf::RenderWindow& window, cons
         sf::Vector2f wp = window.mapPixelToCoords(mp);
         return rect->getGlobalBounds().contains(wp);
     };
+    // helper: grid cell under the mouse, false outside the grid
+    auto cellUnderMouse = [&](int& row, int& col) -> bool {
+        if (!gridOffsetX || !gridOffsetY || !cellSizePtr || !gridRows || !gridCols) return false;
+        sf::Vector2i mp = sf::Mouse::getPosition(window);
+        sf::Vector2f wp = window.mapPixelToCoords(mp);
+        float gx = *gridOffsetX; float gy = *gridOffsetY; float cs = *cellSizePtr;
+        int rows = *gridRows; int cols = *gridCols;
+        if (wp.x < gx || wp.x >= gx + cs * cols || wp.y < gy || wp.y >= gy + cs * rows) return false;
+        row = static_cast<int>((wp.y - gy) / cs);
+        const Neighborhood hood = service.getNeighborhood();
+        if (hood.layout == Neighborhood::Layout::Hexagonal) {
+            // odd rows are drawn half a cell to the right
+            float x = (wp.x - gx) / cs - ((row & 1) ? 0.5f : 0.0f);
+            if (x < 0) return false;
+            col = static_cast<int>(x);
+        } else if (hood.layout == Neighborhood::Layout::Triangular) {
+            // triangle c spans two half-bases from c * step; pick the one
+            // (of the two overlapping there) whose slanted edges enclose the point
+            float step = cs * cols / (cols + 1.0f);
+            float u = (wp.x - gx) / step, fy = (wp.y - gy) / cs - row;
+            int first = static_cast<int>(u);
+            col = -1;
+            for (int c = first; c >= first - 1 && col < 0; --c) {
+                if (c < 0 || c >= cols) continue;
+                float half = std::abs(u - c - 1.0f);
+                bool up = ((row + c) & 1) == 0;
+                if (half <= (up ? fy : 1.0f - fy)) col = c;
+            }
+        } else {
+            col = static_cast<int>((wp.x - gx) / cs);
+        }
+        return row >= 0 && row < rows && col >= 0 && col < cols;
+    };
 
     // Handle keyboard shortcuts and input
     if (event.is<sf::Event::KeyPressed>()) {
@@ -67,7 +103,7 @@ bool SFMLInput::handleEvent(GameService& service, sf::RenderWindow& window, cons
                 // Presets: 0-9 keys to load presets
                 if (ev.scancode >= sf::Keyboard::Scan::Num0 && ev.scancode <= sf::Keyboard::Scan::Num9) {
                     int slot = static_cast<int>(ev.scancode) - static_cast<int>(sf::Keyboard::Scan::Num0);
-                    service.loadPreset(slot);
+                    service.postPreset(slot);
                     if (soundService) soundService->playClick();
                     return;
                 }
@@ -86,7 +122,7 @@ bool SFMLInput::handleEvent(GameService& service, sf::RenderWindow& window, cons
                 if (inputActive && ev.scancode == sf::Keyboard::Scan::Enter) {
                     // Apply input (e.g., set grid dimensions)
                     if (inputValue > 0) {
-                        service.setGridDimensions(inputValue, inputValue);
+                        service.postResize(inputValue, inputValue);
                     }
                     inputActive = false;
                     return;
@@ -149,49 +185,54 @@ bool SFMLInput::handleEvent(GameService& service, sf::RenderWindow& window, cons
 
                     if (isMouseOverRect(inputBox)) { setInputActive(true); return; } else { setInputActive(false); }
 
-                    // Click on grid to toggle cells
-                    if (gridOffsetX && gridOffsetY && cellSizePtr && gridRows && gridCols) {
-                        sf::Vector2i mp = sf::Mouse::getPosition(window);
-                        sf::Vector2f wp = window.mapPixelToCoords(mp);
-                        float gx = *gridOffsetX; float gy = *gridOffsetY; float cs = *cellSizePtr;
-                        int rows = *gridRows; int cols = *gridCols;
-                        float gridWidthPixels = cs * cols;
-                        float gridHeightPixels = cs * rows;
-                        if (wp.x >= gx && wp.x < gx + gridWidthPixels && wp.y >= gy && wp.y < gy + gridHeightPixels) {
-                            int col = static_cast<int>((wp.x - gx) / cs);
-                            int row = static_cast<int>((wp.y - gy) / cs);
-                            if (row >= 0 && row < rows && col >= 0 && col < cols) {
-                                bool current = service.getCell(row, col);
-                                service.setCell(row, col, !current);
-                                if (soundService) soundService->playClick();
-                            }
-                        }
+                    // Click on grid starts a paint stroke: every cell dragged over gets
+                    // the opposite state of the first one, posted as one batch on release.
+                    // That state is read by the simulation when it applies the stroke.
+                    int row = 0, col = 0;
+                    if (cellUnderMouse(row, col)) {
+                        painting = true;
+                        stroke.clear();
+                        stroke.push_back(CellEdit{row, col, CellEdit::Op::Paint});
+                        lastPaintRow = row;
+                        lastPaintCol = col;
+                        if (soundService) soundService->playClick();
                     }
                 } else if (ev.button == sf::Mouse::Button::Right) {
                     // Right click toggles obstacle flag on that cell
-                    if (gridOffsetX && gridOffsetY && cellSizePtr && gridRows && gridCols) {
-                        sf::Vector2i mp = sf::Mouse::getPosition(window);
-                        sf::Vector2f wp = window.mapPixelToCoords(mp);
-                        float gx = *gridOffsetX; float gy = *gridOffsetY; float cs = *cellSizePtr;
-                        int rows = *gridRows; int cols = *gridCols;
-                        float gridWidthPixels = cs * cols;
-                        float gridHeightPixels = cs * rows;
-                        if (wp.x >= gx && wp.x < gx + gridWidthPixels && wp.y >= gy && wp.y < gy + gridHeightPixels) {
-                            int col = static_cast<int>((wp.x - gx) / cs);
-                            int row = static_cast<int>((wp.y - gy) / cs);
-                            if (row >= 0 && row < rows && col >= 0 && col < cols) {
-                                bool obs = service.isObstacle(row, col);
-                                service.setObstacle(row, col, !obs);
-                                if (!obs) service.setCell(row, col, false);
-                                if (soundService) soundService->playClick();
-                            }
-                        }
+                    int row = 0, col = 0;
+                    if (cellUnderMouse(row, col)) {
+                        service.postCells({CellEdit{row, col, CellEdit::Op::ToggleObstacle}});
+                        if (soundService) soundService->playClick();
                     }
                 }
             }
         });
     }
 
+    // Left button released -> the stroke is applied between two generations
+    if (event.is<sf::Event::MouseButtonReleased>() && painting) {
+        painting = false;
+        service.postCells(std::move(stroke));
+        stroke.clear();
+    }
+
+    // Dragging with the left button extends the stroke; cells skipped by a fast
+    // move are filled in along the line from the previous cell
+    if (event.is<sf::Event::MouseMoved>() && painting) {
+        int row = 0, col = 0;
+        if (cellUnderMouse(row, col) && (row != lastPaintRow || col != lastPaintCol)) {
+            int dr = row - lastPaintRow, dc = col - lastPaintCol;
+            int steps = std::max(std::abs(dr), std::abs(dc));
+            for (int i = 1; i <= steps; ++i) {
+                int r = lastPaintRow + (dr * i + (dr >= 0 ? steps / 2 : -steps / 2)) / steps;
+                int c = lastPaintCol + (dc * i + (dc >= 0 ? steps / 2 : -steps / 2)) / steps;
+                stroke.push_back(CellEdit{r, c, CellEdit::Op::Paint});
+            }
+            lastPaintRow = row;
+            lastPaintCol = col;
+        }
+    }
+
     // Mouse moved -> hover detection for buttons (play hover once per entry)
     if (event.is<sf::Event::MouseMoved>()) {
         bool overPlay = isMouseOverRect(playButton);
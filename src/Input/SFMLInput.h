@@ -1,6 +1,9 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "../Services/EditQueue.h"
 
 class GameService;
 
@@ -37,6 +40,11 @@ public:
 private:
     int inputValue = 0;
     bool inputActive = false;
+    // paint stroke in progress (left button held on the grid)
+    bool painting = false;
+    std::vector<CellEdit> stroke;
+    int lastPaintRow = -1;
+    int lastPaintCol = -1;
     // UI context pointers (set by SFMLUI)
     sf::RenderWindow* windowPtr = nullptr;
     const sf::RectangleShape* playButton = nullptr;
@@ -0,0 +1,52 @@
+#include "AsyncWriter.h"
+
+AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void AsyncWriter::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        jobs.push_back(std::move(job));
+        if (!worker.joinable()) worker = std::thread([this]() { loop(); });
+    }
+    cv.notify_one();
+}
+
+void AsyncWriter::flush() {
+    std::unique_lock<std::mutex> lk(mtx);
+    idle.wait(lk, [this]() { return jobs.empty() && active == 0; });
+}
+
+void AsyncWriter::waitBelow(size_t n) {
+    std::unique_lock<std::mutex> lk(mtx);
+    idle.wait(lk, [this, n]() { return jobs.size() + active < n; });
+}
+
+size_t AsyncWriter::pending() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return jobs.size() + active;
+}
+
+void AsyncWriter::loop() {
+    std::unique_lock<std::mutex> lk(mtx);
+    for (;;) {
+        cv.wait(lk, [this]() { return stopping || !jobs.empty(); });
+        // drain remaining jobs even when stopping so no write is lost
+        if (jobs.empty()) return;
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        ++active;
+        lk.unlock();
+        try { job(); } catch (...) {}
+        lk.lock();
+        --active;
+        // every completion may unblock a waitBelow(); flush() rechecks for empty
+        idle.notify_all();
+    }
+}
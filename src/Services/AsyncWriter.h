@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Single background thread that runs I/O jobs in submission order, so the
+// simulation thread never blocks on disk. The thread is started lazily on
+// the first submit() and joined (after draining the queue) on destruction.
+class AsyncWriter {
+public:
+    AsyncWriter() = default;
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter &) = delete;
+    AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+    void submit(std::function<void()> job);
+    // block until every submitted job has completed
+    void flush();
+    // block until fewer than `n` jobs are queued or running (back-pressure
+    // for producers that outpace the disk)
+    void waitBelow(size_t n);
+    // number of jobs queued or running
+    size_t pending() const;
+
+private:
+    void loop();
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::condition_variable idle;
+    std::deque<std::function<void()>> jobs;
+    size_t active = 0;
+    bool stopping = false;
+    std::thread worker;
+};
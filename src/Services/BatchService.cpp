@@ -0,0 +1,195 @@
+#include "BatchService.h"
+#include "GameService.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+bool BatchService::parseJobLine(const std::string &rawLine, BatchJob &job, std::string *error) {
+	std::string line = rawLine.substr(0, rawLine.find('#'));
+	std::istringstream iss(line);
+	std::string tok;
+	bool any = false;
+	while (iss >> tok) {
+		size_t eq = tok.find('=');
+		if (eq == std::string::npos) {
+			if (error) *error = "expected key=value, got '" + tok + "'";
+			return false;
+		}
+		std::string key = tok.substr(0, eq), val = tok.substr(eq + 1);
+		try {
+			if (key == "name") job.name = val;
+			else if (key == "input") job.input = val;
+			else if (key == "seed") job.seed = std::stoull(val);
+			else if (key == "density") job.density = std::stod(val);
+			else if (key == "rule") job.rule = val;
+			else if (key == "symmetry") job.symmetry = val;
+			else if (key == "gens" || key == "generations") job.generations = std::stoi(val);
+			else if (key == "toric") job.topology = (val == "1" || val == "true" || val == "yes") ? Topology::Torus : Topology::Bounded;
+			else if (key == "topology") {
+				if (!Grid::parseTopology(val, job.topology)) {
+					if (error) *error = "unknown topology '" + val + "'";
+					return false;
+				}
+			}
+			else if (key == "size") {
+				size_t x = val.find('x');
+				if (x == std::string::npos) { job.rows = job.cols = std::stoi(val); }
+				else { job.rows = std::stoi(val.substr(0, x)); job.cols = std::stoi(val.substr(x + 1)); }
+			}
+			else {
+				if (error) *error = "unknown key '" + key + "'";
+				return false;
+			}
+		} catch (...) {
+			if (error) *error = "bad value for '" + key + "'";
+			return false;
+		}
+		any = true;
+	}
+	return any;
+}
+
+bool BatchService::parseManifest(const std::string &path, std::vector<BatchJob> &jobs, std::string *error) {
+	std::ifstream ifs(path);
+	if (!ifs.is_open()) {
+		if (error) *error = "cannot open " + path;
+		return false;
+	}
+	std::string line;
+	int lineNo = 0;
+	while (std::getline(ifs, line)) {
+		++lineNo;
+		BatchJob job;
+		std::string err;
+		if (!parseJobLine(line, job, &err)) {
+			if (err.empty()) continue; // blank or comment line
+			if (error) *error = path + ":" + std::to_string(lineNo) + ": " + err;
+			return false;
+		}
+		if (job.name.empty()) job.name = "job" + std::to_string(jobs.size() + 1);
+		jobs.push_back(job);
+	}
+	return true;
+}
+
+BatchResult BatchService::runJob(const BatchJob &job, ThreadPool &pool, bool parallelStep) {
+	using clock = std::chrono::steady_clock;
+	BatchResult res;
+	res.name = job.name;
+	res.rule = job.rule;
+	res.topology = job.topology;
+
+	auto t0 = clock::now();
+	GameService svc;
+	svc.setThreadPool(&pool);
+	svc.setMaxThreads(parallelStep ? 0u : 1u);
+	if (!svc.setRule(job.rule)) {
+		res.error = "bad rule " + job.rule;
+		return res;
+	}
+	svc.setTopology(job.topology);
+	if (!job.input.empty()) {
+		if (!svc.loadInitialFromFile(job.input)) {
+			res.error = "cannot load " + job.input;
+			return res;
+		}
+	} else {
+		SoupOptions soup;
+		soup.seed = job.seed;
+		soup.density = job.density;
+		svc.setGridDimensions(job.rows, job.cols);
+		if (!SoupGenerator::parseSymmetry(job.symmetry, soup.symmetry) || !svc.loadSoup(soup)) {
+			res.error = "bad soup parameters";
+			return res;
+		}
+	}
+	if (!svc.tilingValid()) {
+		res.error = "rule " + job.rule + " does not tile this board with topology " + Grid::topologyName(job.topology);
+		return res;
+	}
+	// batch runs never write per-generation files
+	svc.setSaveIterations(0);
+	auto t1 = clock::now();
+
+	// period detection: remember the generation at which each state hash was first seen
+	std::unordered_map<uint64_t, int> seen;
+	seen.emplace(svc.getGrid().hash(), 0);
+	svc.start();
+	if (job.generations > 0) {
+		int gen = 0;
+		auto stats = svc.advanceUntil([&](const GameService &s) {
+			auto ins = seen.emplace(s.getGrid().hash(), ++gen);
+			if (ins.second) return false;
+			res.period = gen - ins.first->second;
+			res.periodStart = ins.first->second;
+			return true;
+		}, job.generations);
+		res.generations = stats.generations;
+		if (stats.stop == GameService::AdvanceStop::Stabilized) {
+			// the board stopped changing: still life reached one generation earlier
+			res.period = 1;
+			res.periodStart = stats.generations - 1;
+		}
+	}
+	auto t2 = clock::now();
+
+	res.ok = true;
+	res.rows = svc.getRows();
+	res.cols = svc.getCols();
+	res.rule = svc.getRuleString();
+	res.population = svc.getGrid().population();
+	res.loadMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	res.runMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+	return res;
+}
+
+std::vector<BatchResult> BatchService::run(const std::vector<BatchJob> &jobs, ThreadPool &pool, long long parallelThreshold) {
+	std::vector<BatchResult> results(jobs.size());
+	TaskGroup group(pool);
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		const BatchJob &job = jobs[i];
+		long long cells = job.input.empty() ? (long long)job.rows * job.cols : parallelThreshold + 1;
+		if (!job.input.empty()) {
+			// size of a file job is only known from its header
+			std::ifstream ifs(job.input);
+			int r = 0, c = 0;
+			if (ifs >> r >> c) cells = (long long)r * c;
+		}
+		bool parallelStep = cells > parallelThreshold;
+		group.run([&results, &job, &pool, i, parallelStep]() { results[i] = runJob(job, pool, parallelStep); });
+	}
+	group.wait();
+	return results;
+}
+
+std::string BatchService::formatTable(const std::vector<BatchResult> &results) {
+	std::ostringstream os;
+	os << std::left << std::setw(16) << "name" << std::right << std::setw(11) << "size" << std::setw(12) << "rule" << std::setw(12) << "topology"
+	   << std::setw(8) << "gens" << std::setw(8) << "pop" << std::setw(8) << "period" << std::setw(10) << "load_ms"
+	   << std::setw(10) << "run_ms" << "\n";
+	os << std::fixed << std::setprecision(2);
+	for (const auto &r : results) {
+		os << std::left << std::setw(16) << r.name << std::right;
+		if (!r.ok) { os << "  ERROR: " << r.error << "\n"; continue; }
+		std::string size = std::to_string(r.rows) + "x" + std::to_string(r.cols);
+		os << std::setw(11) << size << std::setw(12) << r.rule << std::setw(12) << Grid::topologyName(r.topology) << std::setw(8) << r.generations << std::setw(8) << r.population
+		   << std::setw(8) << (r.period > 0 ? std::to_string(r.period) : std::string("-"))
+		   << std::setw(10) << r.loadMs << std::setw(10) << r.runMs << "\n";
+	}
+	return os.str();
+}
+
+bool BatchService::writeResultsCsv(const std::string &path, const std::vector<BatchResult> &results) {
+	std::ofstream ofs(path);
+	if (!ofs.is_open()) return false;
+	ofs << "name,ok,rows,cols,rule,topology,generations,population,period,period_start,load_ms,run_ms,error\n";
+	ofs << std::fixed << std::setprecision(3);
+	for (const auto &r : results) {
+		ofs << r.name << ',' << (r.ok ? 1 : 0) << ',' << r.rows << ',' << r.cols << ',' << r.rule << ',' << Grid::topologyName(r.topology) << ','
+		    << r.generations << ',' << r.population << ',' << r.period << ',' << r.periodStart << ','
+		    << r.loadMs << ',' << r.runMs << ',' << r.error << '\n';
+	}
+	return static_cast<bool>(ofs);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "../Core/Grid.h"
+
+// One simulation of a parameter sweep
+struct BatchJob {
+	std::string name;
+	std::string input;          // grid file; empty = random soup from `seed`
+	uint64_t seed = 0;
+	int rows = 64;              // soup size (ignored when `input` is set)
+	int cols = 64;
+	double density = 0.5;       // soup fill ratio
+	std::string symmetry;       // soup symmetry: C2, C4 or D8 (empty = none)
+	std::string rule = "B3/S23";
+	int generations = 1000;
+	Topology topology = Topology::Bounded;   // "topology=klein", or "toric=1" for the torus
+};
+
+struct BatchResult {
+	std::string name;
+	bool ok = false;
+	std::string error;
+	int rows = 0;
+	int cols = 0;
+	std::string rule;
+	Topology topology = Topology::Bounded;
+	int generations = 0;        // generations actually run
+	int population = 0;         // final population
+	int period = 0;             // detected period (1 = still), 0 = none detected
+	int periodStart = 0;        // first generation of the detected cycle
+	double loadMs = 0.0;
+	double runMs = 0.0;
+};
+
+// Runs many independent GameService instances over a work-stealing pool.
+// Small boards run one simulation per worker (single-threaded step); boards
+// above `parallelThreshold` cells also split each step across the pool.
+class BatchService {
+public:
+	// Manifest: one job per line of key=value tokens, '#' starts a comment.
+	//   name=<id> input=<file> | seed=<n> size=<rows>x<cols> density=<0..1> symmetry=<C2|C4|D8>
+	//   rule=<B3/S23> gens=<n> toric=<0|1>
+	static bool parseManifest(const std::string &path, std::vector<BatchJob> &jobs, std::string *error = nullptr);
+	static bool parseJobLine(const std::string &line, BatchJob &job, std::string *error = nullptr);
+
+	static std::vector<BatchResult> run(const std::vector<BatchJob> &jobs, ThreadPool &pool, long long parallelThreshold = 256LL * 256LL);
+	static BatchResult runJob(const BatchJob &job, ThreadPool &pool, bool parallelStep);
+
+	// Human readable aligned table and CSV export of the results
+	static std::string formatTable(const std::vector<BatchResult> &results);
+	static bool writeResultsCsv(const std::string &path, const std::vector<BatchResult> &results);
+};
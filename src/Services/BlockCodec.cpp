@@ -0,0 +1,118 @@
+#include "BlockCodec.h"
+
+#include <cstring>
+
+namespace {
+
+const int kHashBits = 14;
+const size_t kMinMatch = 4;
+const size_t kLastLiterals = 5;     // the block always ends with literals
+const size_t kMatchSearchEnd = 12;  // no match starts this close to the end
+const size_t kMaxOffset = 65535;
+
+uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+uint32_t hash4(uint32_t v) { return (v * 2654435761u) >> (32 - kHashBits); }
+
+void putLength(std::vector<uint8_t> &out, size_t len) {
+    while (len >= 255) {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back((uint8_t)len);
+}
+
+void emitSequence(std::vector<uint8_t> &out, const uint8_t *lit, size_t litLen, size_t offset, size_t matchLen) {
+    size_t tokenAt = out.size();
+    out.push_back(0);
+    uint8_t token = (uint8_t)((litLen >= 15 ? 15 : litLen) << 4);
+    if (litLen >= 15) putLength(out, litLen - 15);
+    out.insert(out.end(), lit, lit + litLen);
+    if (matchLen > 0) {
+        out.push_back((uint8_t)(offset & 0xff));
+        out.push_back((uint8_t)(offset >> 8));
+        size_t m = matchLen - kMinMatch;
+        token |= (uint8_t)(m >= 15 ? 15 : m);
+        if (m >= 15) putLength(out, m - 15);
+    }
+    out[tokenAt] = token;
+}
+
+} // namespace
+
+void BlockCodec::compress(const uint8_t *src, size_t n, std::vector<uint8_t> &out) {
+    out.clear();
+    out.reserve(n + n / 255 + 16);
+    size_t anchor = 0;
+    if (n > kMatchSearchEnd) {
+        // positions + 1, so 0 means "no candidate"
+        std::vector<uint32_t> table((size_t)1 << kHashBits, 0);
+        const size_t searchEnd = n - kMatchSearchEnd;
+        const size_t matchEnd = n - kLastLiterals;
+        size_t ip = 0;
+        unsigned misses = 0;
+        while (ip < searchEnd) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = hash4(seq);
+            size_t ref = table[h];
+            table[h] = (uint32_t)(ip + 1);
+            if (ref == 0 || ip - (ref - 1) > kMaxOffset || read32(src + ref - 1) != seq) {
+                // incompressible stretches are skipped faster and faster
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            ref -= 1;
+            size_t len = kMinMatch;
+            while (ip + len < matchEnd && src[ref + len] == src[ip + len]) ++len;
+            emitSequence(out, src + anchor, ip - anchor, ip - ref, len);
+            ip += len;
+            anchor = ip;
+            if (ip < searchEnd && ip >= 2) table[hash4(read32(src + ip - 2))] = (uint32_t)(ip - 1);
+        }
+    }
+    emitSequence(out, src + anchor, n - anchor, 0, 0);
+}
+
+bool BlockCodec::decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t rawSize) {
+    size_t ip = 0, op = 0;
+    auto readLength = [&](size_t &len) {
+        uint8_t b;
+        do {
+            if (ip >= n) return false;
+            b = src[ip++];
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+    while (ip < n) {
+        uint8_t token = src[ip++];
+        size_t litLen = token >> 4;
+        if (litLen == 15 && !readLength(litLen)) return false;
+        if (litLen > n - ip || litLen > rawSize - op) return false;
+        std::memcpy(dst + op, src + ip, litLen);
+        ip += litLen;
+        op += litLen;
+        if (ip == n) break;   // last sequence: literals only
+        if (n - ip < 2) return false;
+        size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !readLength(matchLen)) return false;
+        matchLen += kMinMatch;
+        if (offset == 0 || offset > op || matchLen > rawSize - op) return false;
+        const uint8_t *from = dst + op - offset;
+        if (offset >= matchLen) {
+            std::memcpy(dst + op, from, matchLen);
+        } else {
+            // overlapping match (offset < length) repeats a run: byte by byte
+            for (size_t i = 0; i < matchLen; ++i) dst[op + i] = from[i];
+        }
+        op += matchLen;
+    }
+    return op == rawSize;
+}
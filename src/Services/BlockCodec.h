@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// In-tree LZ4-class byte compressor (no external dependency).
+// The output follows the LZ4 block layout: sequences of a token (literal
+// length, match length - 4), literals, a 16-bit little-endian offset, and
+// 255-continued length bytes; the last sequence is literals only. Matches are
+// found with a single-probe hash of 4-byte words, which favours speed over
+// ratio; decompression is a bounds-checked copy loop.
+class BlockCodec {
+public:
+    // Compress n bytes into `out` (replaced); worst case n + n/255 + 16 bytes
+    static void compress(const uint8_t *src, size_t n, std::vector<uint8_t> &out);
+    // Decompress exactly rawSize bytes; false on malformed or truncated input
+    static bool decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t rawSize);
+};
@@ -0,0 +1,308 @@
+#include "CensusService.h"
+#include "GameService.h"
+#include "../Core/GameRules.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using Cells = CensusService::Cells;
+
+inline int64_t key(int r, int c) { return ((int64_t)r << 32) ^ (int64_t)(uint32_t)c; }
+
+// One generation of a life-like rule on an unbounded sparse set of cells
+Cells evolve(const Cells &cells, uint16_t birth, uint16_t survive) {
+	std::unordered_map<int64_t, int> counts;
+	std::unordered_set<int64_t> alive;
+	counts.reserve(cells.size() * 9);
+	alive.reserve(cells.size());
+	for (const auto &p : cells) {
+		alive.insert(key(p.first, p.second));
+		for (int dr = -1; dr <= 1; ++dr)
+			for (int dc = -1; dc <= 1; ++dc)
+				if (dr || dc) ++counts[key(p.first + dr, p.second + dc)];
+	}
+	Cells out;
+	for (const auto &kv : counts) {
+		bool isAlive = alive.count(kv.first) != 0;
+		uint16_t mask = isAlive ? survive : birth;
+		if ((mask >> kv.second) & 1u) out.emplace_back((int)(kv.first >> 32), (int)(int32_t)(uint32_t)kv.first);
+	}
+	// survivors with 0 neighbours never appear in `counts`
+	if (survive & 1u) {
+		for (const auto &p : cells) if (!counts.count(key(p.first, p.second))) out.push_back(p);
+	}
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+// Translate so the bounding box starts at (0,0); returns the removed offset
+std::pair<int,int> normalize(Cells &cells) {
+	if (cells.empty()) return {0, 0};
+	int r0 = cells[0].first, c0 = cells[0].second;
+	for (const auto &p : cells) { r0 = std::min(r0, p.first); c0 = std::min(c0, p.second); }
+	for (auto &p : cells) { p.first -= r0; p.second -= c0; }
+	std::sort(cells.begin(), cells.end());
+	return {r0, c0};
+}
+
+// Extended Wechsler format: 5-row strips, one base-32 digit per column,
+// runs of empty columns compressed as w (2), x (3) and y<n> (4..39)
+std::string wechsler(const Cells &cells) {
+	static const char *digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+	int h = 0, w = 0;
+	for (const auto &p : cells) { h = std::max(h, p.first + 1); w = std::max(w, p.second + 1); }
+	int strips = (h + 4) / 5;
+	std::vector<int> col((size_t)strips * (size_t)w, 0);
+	for (const auto &p : cells) col[(size_t)(p.first / 5) * w + p.second] |= 1 << (p.first % 5);
+	std::string out;
+	for (int s = 0; s < strips; ++s) {
+		if (s) out += 'z';
+		int last = w - 1;
+		while (last >= 0 && col[(size_t)s * w + last] == 0) --last;
+		int zeros = 0;
+		auto flush = [&]() {
+			while (zeros > 0) {
+				if (zeros == 1) { out += '0'; zeros = 0; }
+				else if (zeros == 2) { out += 'w'; zeros = 0; }
+				else if (zeros == 3) { out += 'x'; zeros = 0; }
+				else { int n = std::min(zeros, 39); out += 'y'; out += digits[n - 4]; zeros -= n; }
+			}
+		};
+		for (int c = 0; c <= last; ++c) {
+			int v = col[(size_t)s * w + c];
+			if (v == 0) { ++zeros; continue; }
+			flush();
+			out += digits[v];
+		}
+	}
+	return out;
+}
+
+bool lessCode(const std::string &a, const std::string &b) {
+	return a.size() != b.size() ? a.size() < b.size() : a < b;
+}
+
+struct Box { int r0, c0, r1, c1; };
+
+Box boundingBox(const Cells &cells) {
+	Box b{cells[0].first, cells[0].second, cells[0].first, cells[0].second};
+	for (const auto &p : cells) {
+		b.r0 = std::min(b.r0, p.first); b.c0 = std::min(b.c0, p.second);
+		b.r1 = std::max(b.r1, p.first); b.c1 = std::max(b.c1, p.second);
+	}
+	return b;
+}
+
+int boxGap(const Box &a, const Box &b) {
+	int dr = std::max(0, std::max(a.r0 - b.r1, b.r0 - a.r1));
+	int dc = std::max(0, std::max(a.c0 - b.c1, b.c0 - a.c1));
+	return std::max(dr, dc);
+}
+
+Cells liveCells(const Grid &g) {
+	Cells out;
+	for (int r = 0; r < g.getR(); ++r)
+		for (int c = 0; c < g.getC(); ++c)
+			if (g.getCell(r, c) && !g.isObstacle(r, c)) out.emplace_back(r, c);
+	return out;
+}
+
+void tally(std::map<std::string, CensusEntry> &table, const CensusService::ObjectInfo &info, int population) {
+	CensusEntry &e = table[info.code];
+	if (e.count == 0) {
+		e.code = info.code;
+		e.kind = info.kind;
+		e.period = info.period;
+		e.population = population;
+	}
+	++e.count;
+}
+
+} // namespace
+
+std::vector<Cells> CensusService::separateObjects(const Cells &live) {
+	std::unordered_map<int64_t, int> index;
+	index.reserve(live.size());
+	for (size_t i = 0; i < live.size(); ++i) index.emplace(key(live[i].first, live[i].second), (int)i);
+	std::vector<int> comp(live.size(), -1);
+	std::vector<Cells> objects;
+	std::vector<int> stack;
+	for (size_t i = 0; i < live.size(); ++i) {
+		if (comp[i] >= 0) continue;
+		int id = (int)objects.size();
+		objects.emplace_back();
+		comp[i] = id;
+		stack.push_back((int)i);
+		while (!stack.empty()) {
+			int cur = stack.back();
+			stack.pop_back();
+			objects[id].push_back(live[cur]);
+			for (int dr = -2; dr <= 2; ++dr) {
+				for (int dc = -2; dc <= 2; ++dc) {
+					auto it = index.find(key(live[cur].first + dr, live[cur].second + dc));
+					if (it == index.end() || comp[it->second] >= 0) continue;
+					comp[it->second] = id;
+					stack.push_back(it->second);
+				}
+			}
+		}
+	}
+	return objects;
+}
+
+std::string CensusService::canonicalShape(const Cells &cells) {
+	std::string best;
+	for (int t = 0; t < 8; ++t) {
+		Cells img;
+		img.reserve(cells.size());
+		for (const auto &p : cells) {
+			int r = p.first, c = p.second;
+			if (t & 1) c = -c;
+			if (t & 2) r = -r;
+			if (t & 4) std::swap(r, c);
+			img.emplace_back(r, c);
+		}
+		normalize(img);
+		std::string code = wechsler(img);
+		if (t == 0 || lessCode(code, best)) best = code;
+	}
+	return best;
+}
+
+CensusService::ObjectInfo CensusService::classify(const Cells &cells, uint16_t birthMask, uint16_t surviveMask, int maxPeriod) {
+	ObjectInfo info;
+	Cells start = cells;
+	auto origin = normalize(start);
+	std::string bestShape = canonicalShape(start);
+	info.code = "xx_" + bestShape;
+	// B0 rules fill the whole plane: nothing is finite
+	if (birthMask & 1u) return info;
+
+	Cells cur = cells;
+	for (int p = 1; p <= maxPeriod; ++p) {
+		cur = evolve(cur, birthMask, surviveMask);
+		if (cur.empty()) {
+			info.kind = "other";
+			info.code = "xx_0";
+			return info;
+		}
+		Cells shape = cur;
+		auto o = normalize(shape);
+		if (shape == start) {
+			info.period = p;
+			info.dr = o.first - origin.first;
+			info.dc = o.second - origin.second;
+			std::string prefix;
+			if (info.dr == 0 && info.dc == 0) {
+				info.kind = p == 1 ? "still" : "oscillator";
+				prefix = p == 1 ? "xs" + std::to_string(start.size()) : "xp" + std::to_string(p);
+			} else {
+				info.kind = "spaceship";
+				prefix = "xq" + std::to_string(p);
+			}
+			info.code = prefix + "_" + bestShape;
+			return info;
+		}
+		// the canonical code of a periodic object is the best over all its phases
+		std::string s = canonicalShape(shape);
+		if (lessCode(s, bestShape)) bestShape = s;
+	}
+	return info;
+}
+
+CensusResult CensusService::run(const CensusOptions &opt, ThreadPool &pool) {
+	auto t0 = std::chrono::steady_clock::now();
+	CensusResult result;
+	result.soups = opt.soups;
+
+	uint16_t birth = 0, survive = 0;
+	if (!LifeLikeRules::parse(opt.rule, birth, survive)) return result;
+	result.rule = LifeLikeRules::format(birth, survive);
+
+	std::mutex mtx;
+	std::map<std::string, CensusEntry> table;
+	int unstabilised = 0;
+
+	auto runSoup = [&](uint64_t seed) {
+		std::map<std::string, CensusEntry> local;
+		GameService svc;
+		svc.setThreadPool(&pool);
+		svc.setMaxThreads(1);
+		svc.setRule(opt.rule);
+		svc.setGridDimensions(opt.boardRows, opt.boardCols);
+		SoupOptions soup;
+		soup.seed = seed;
+		soup.density = opt.density;
+		soup.symmetry = opt.symmetry;
+		soup.height = soup.width = std::min(opt.soupSize, std::min(opt.boardRows, opt.boardCols));
+		soup.row = (opt.boardRows - soup.height) / 2;
+		soup.col = (opt.boardCols - soup.width) / 2;
+		svc.loadSoup(soup);
+		svc.start();
+
+		std::unordered_map<uint64_t, int> seen;
+		seen.emplace(svc.getGrid().hash(), 0);
+		bool settled = false;
+		for (int gen = 1; gen <= opt.maxGenerations; ++gen) {
+			svc.step();
+			if (!svc.isRunning()) { settled = true; break; }
+			if (!seen.emplace(svc.getGrid().hash(), gen).second) { settled = true; break; }
+
+			if (gen % 64 == 0) {
+				// remove spaceships that are well clear of everything else
+				auto objects = separateObjects(liveCells(svc.getGrid()));
+				std::vector<Box> boxes;
+				for (const auto &o : objects) boxes.push_back(boundingBox(o));
+				bool removed = false;
+				for (size_t i = 0; i < objects.size(); ++i) {
+					bool isolated = true;
+					for (size_t j = 0; j < objects.size() && isolated; ++j) if (j != i && boxGap(boxes[i], boxes[j]) < 6) isolated = false;
+					if (!isolated || objects[i].size() > 64) continue;
+					ObjectInfo info = classify(objects[i], birth, survive, opt.maxObjectPeriod);
+					if (info.kind != "spaceship") continue;
+					tally(local, info, (int)objects[i].size());
+					for (const auto &p : objects[i]) svc.setCell(p.first, p.second, false);
+					removed = true;
+				}
+				if (removed) {
+					seen.clear();
+					seen.emplace(svc.getGrid().hash(), gen);
+				}
+			}
+		}
+
+		for (const auto &obj : separateObjects(liveCells(svc.getGrid()))) {
+			ObjectInfo info = classify(obj, birth, survive, opt.maxObjectPeriod);
+			tally(local, info, (int)obj.size());
+		}
+
+		std::lock_guard<std::mutex> lk(mtx);
+		if (!settled) ++unstabilised;
+		for (const auto &kv : local) {
+			CensusEntry &e = table[kv.first];
+			if (e.count == 0) e = kv.second;
+			else e.count += kv.second.count;
+		}
+	};
+
+	{
+		TaskGroup group(pool);
+		for (int i = 0; i < opt.soups; ++i) {
+			uint64_t seed = opt.firstSeed + (uint64_t)i;
+			group.run([&runSoup, seed]() { runSoup(seed); });
+		}
+		group.wait();
+	}
+
+	result.unstabilised = unstabilised;
+	for (auto &kv : table) result.entries.push_back(kv.second);
+	std::stable_sort(result.entries.begin(), result.entries.end(),
+	                 [](const CensusEntry &a, const CensusEntry &b) { return a.count > b.count; });
+	result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Core/SoupGenerator.h"
+#include "ThreadPool.h"
+
+struct CensusOptions {
+	int soups = 1000;
+	uint64_t firstSeed = 1;         // soups use seeds firstSeed .. firstSeed + soups - 1
+	int boardRows = 96;             // bounded board; the soup is centred in it
+	int boardCols = 96;
+	int soupSize = 16;              // side of the random square
+	double density = 0.5;
+	SoupSymmetry symmetry = SoupSymmetry::NONE;
+	std::string rule = "B3/S23";
+	int maxGenerations = 6000;      // soups still active after this are reported as unstabilised
+	int maxObjectPeriod = 64;       // longest period searched when classifying an object
+};
+
+// One line of the census frequency table
+struct CensusEntry {
+	std::string code;               // apgcode-style: xs<pop>_, xp<p>_, xq<p>_ + Wechsler shape
+	std::string kind;               // "still", "oscillator", "spaceship" or "other"
+	int period = 0;
+	int population = 0;
+	uint64_t count = 0;
+};
+
+struct CensusResult {
+	std::string rule;
+	int soups = 0;
+	int unstabilised = 0;
+	std::vector<CensusEntry> entries;   // sorted by decreasing count
+	double ms = 0.0;
+};
+
+// Soup search: runs many random soups to stabilisation in parallel, splits
+// the final boards into objects and counts them by canonical code.
+// Spaceships leaving the ash are recorded and removed while the soup runs so
+// they neither crash into the board edge nor delay stabilisation.
+class CensusService {
+public:
+	using Cells = std::vector<std::pair<int,int>>;
+
+	struct ObjectInfo {
+		std::string kind = "other";
+		int period = 0;
+		int dr = 0, dc = 0;             // displacement per period (spaceships)
+		std::string code;
+	};
+
+	static CensusResult run(const CensusOptions &opt, ThreadPool &pool);
+
+	// Group live cells into objects: cells closer than 3 (Chebyshev) share an object
+	static std::vector<Cells> separateObjects(const Cells &live);
+	// Evolve `cells` in isolation on the infinite plane to find its type and period
+	static ObjectInfo classify(const Cells &cells, uint16_t birthMask, uint16_t surviveMask, int maxPeriod);
+	// Rotation/reflection-normalised Wechsler code of a shape (shortest, then smallest)
+	static std::string canonicalShape(const Cells &cells);
+};
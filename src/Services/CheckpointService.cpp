@@ -0,0 +1,179 @@
+#include "CheckpointService.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char kMagic[7] = {'G','O','L','C','K','P','T'};
+static const uint8_t kVersion = 3;   // v2 adds the life-like rule masks, v3 the neighbourhood
+
+static uint32_t fnv1a(const std::vector<uint8_t> &data, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) { h ^= data[i]; h *= 16777619u; }
+    return h;
+}
+
+// --- encoding helpers ---
+static void putU8(std::vector<uint8_t> &out, uint8_t v) { out.push_back(v); }
+static void putU32(std::vector<uint8_t> &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+static void putI32(std::vector<uint8_t> &out, int32_t v) { putU32(out, (uint32_t)v); }
+
+static void putGrid(std::vector<uint8_t> &out, const Grid &g) {
+    int rows = g.getR(), cols = g.getC();
+    putI32(out, rows);
+    putI32(out, cols);
+    size_t n = (size_t)rows * (size_t)cols;
+    size_t bytes = (n + 7) / 8;
+    size_t aliveAt = out.size();
+    out.resize(aliveAt + 2 * bytes, 0);
+    size_t obsAt = aliveAt + bytes;
+    size_t i = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c, ++i) {
+            if (g.getCell(r, c)) out[aliveAt + i / 8] |= (uint8_t)(1u << (i % 8));
+            if (g.isObstacle(r, c)) out[obsAt + i / 8] |= (uint8_t)(1u << (i % 8));
+        }
+    }
+}
+
+// --- decoding helpers ---
+struct Reader {
+    const std::vector<uint8_t> &data;
+    size_t pos = 0;
+    size_t end;
+    bool ok = true;
+
+    bool need(size_t n) { if (pos + n > end) ok = false; return ok; }
+    uint8_t u8() { if (!need(1)) return 0; return data[pos++]; }
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= (uint32_t)data[pos++] << (8 * i);
+        return v;
+    }
+    int32_t i32() { return (int32_t)u32(); }
+};
+
+static bool getGrid(Reader &rd, Grid &g) {
+    int rows = rd.i32();
+    int cols = rd.i32();
+    if (!rd.ok || rows < 0 || cols < 0) return false;
+    size_t n = (size_t)rows * (size_t)cols;
+    size_t bytes = (n + 7) / 8;
+    if (!rd.need(2 * bytes)) return false;
+    size_t aliveAt = rd.pos, obsAt = rd.pos + bytes;
+    g.setGridDimensions(rows, cols);
+    size_t i = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c, ++i) {
+            bool obs = (rd.data[obsAt + i / 8] >> (i % 8)) & 1u;
+            bool alive = (rd.data[aliveAt + i / 8] >> (i % 8)) & 1u;
+            if (obs) g.setObstacle(r, c, true);
+            if (alive) g.setCell(r, c, true);
+        }
+    }
+    rd.pos += 2 * bytes;
+    return true;
+}
+
+bool CheckpointService::write(const std::string &path, const GameService::State &s) {
+    std::vector<uint8_t> buf;
+    buf.insert(buf.end(), kMagic, kMagic + sizeof(kMagic));
+    putU8(buf, kVersion);
+    putI32(buf, s.currentIteration);
+    putI32(buf, s.iterationTarget);
+    putI32(buf, s.saveIterations);
+    putI32(buf, s.tickMs);
+    putU8(buf, (uint8_t)s.ruleType);
+    putU32(buf, ((uint32_t)s.birthMask << 16) | s.surviveMask);
+    putU8(buf, (uint8_t)s.neighborhood.layout);
+    putU8(buf, s.neighborhood.even);
+    putU8(buf, s.neighborhood.odd);
+    // Topology values 0 and 1 are the former toric flag
+    putU8(buf, (uint8_t)s.topology);
+    putU8(buf, s.initialGrid ? 1 : 0);
+    putU32(buf, (uint32_t)s.outputBase.size());
+    buf.insert(buf.end(), s.outputBase.begin(), s.outputBase.end());
+    putGrid(buf, s.grid);
+    if (s.initialGrid) putGrid(buf, *s.initialGrid);
+    putU32(buf, fnv1a(buf, buf.size()));
+
+    try {
+        fs::path target(path);
+        if (target.has_parent_path() && !fs::exists(target.parent_path())) fs::create_directories(target.parent_path());
+        fs::path tmp = target;
+        tmp += ".tmp";
+        {
+            std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+            if (!ofs.is_open()) return false;
+            ofs.write(reinterpret_cast<const char *>(buf.data()), (std::streamsize)buf.size());
+            ofs.flush();
+            if (!ofs) return false;
+        }
+        fs::rename(tmp, target);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool CheckpointService::read(const std::string &path, GameService::State &out) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) return false;
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    if (buf.size() < sizeof(kMagic) + 1 + 4) return false;
+    for (size_t i = 0; i < sizeof(kMagic); ++i) if (buf[i] != (uint8_t)kMagic[i]) return false;
+    uint8_t version = buf[sizeof(kMagic)];
+    if (version < 1 || version > kVersion) return false;
+
+    size_t payload = buf.size() - 4;
+    Reader tail{buf, payload, buf.size()};
+    if (tail.u32() != fnv1a(buf, payload)) return false;
+
+    Reader rd{buf, sizeof(kMagic) + 1, payload};
+    GameService::State s;
+    s.currentIteration = rd.i32();
+    s.iterationTarget = rd.i32();
+    s.saveIterations = rd.i32();
+    s.tickMs = rd.i32();
+    uint8_t rule = rd.u8();
+    if (rule == (uint8_t)GameService::RuleType::BASIC) s.ruleType = GameService::RuleType::BASIC;
+    else if (rule == (uint8_t)GameService::RuleType::LIFE_LIKE) s.ruleType = GameService::RuleType::LIFE_LIKE;
+    else s.ruleType = GameService::RuleType::CONWAY;
+    if (version >= 2) {
+        uint32_t masks = rd.u32();
+        s.birthMask = (uint16_t)(masks >> 16);
+        s.surviveMask = (uint16_t)(masks & 0xFFFFu);
+    }
+    if (version >= 3) {
+        uint8_t layout = rd.u8();
+        if (layout > (uint8_t)Neighborhood::Layout::Triangular) return false;
+        s.neighborhood.layout = (Neighborhood::Layout)layout;
+        s.neighborhood.even = rd.u8();
+        s.neighborhood.odd = rd.u8();
+    }
+    uint8_t topology = rd.u8();
+    s.topology = topology <= (uint8_t)Topology::AliveBorder ? (Topology)topology : Topology::Bounded;
+    bool hasInitial = rd.u8() != 0;
+    uint32_t len = rd.u32();
+    if (!rd.ok || !rd.need(len)) return false;
+    s.outputBase.assign(buf.begin() + (std::ptrdiff_t)rd.pos, buf.begin() + (std::ptrdiff_t)(rd.pos + len));
+    rd.pos += len;
+    if (!getGrid(rd, s.grid)) return false;
+    if (hasInitial) {
+        Grid initial;
+        if (!getGrid(rd, initial)) return false;
+        initial.setTopology(s.topology);
+        s.initialGrid = std::make_shared<const Grid>(std::move(initial));
+    }
+    if (!rd.ok) return false;
+    s.grid.setTopology(s.topology);
+    out = std::move(s);
+    return true;
+}
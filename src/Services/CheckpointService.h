@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+#include "GameService.h"
+
+// Binary checkpoint of a complete GameService::State.
+// Layout (little-endian): "GOLCKPT" + version byte, header fields, the live
+// grid and optional initial grid as two bit planes each (alive, obstacle),
+// then an FNV-1a checksum of everything before it.
+class CheckpointService {
+public:
+	// Write atomically: data goes to "<path>.tmp" which is then renamed over
+	// `path`, so a crash mid-write never leaves a truncated checkpoint.
+	static bool write(const std::string &path, const GameService::State &state);
+
+	// Read a checkpoint; returns false on missing file, bad magic/version or checksum mismatch
+	static bool read(const std::string &path, GameService::State &out);
+};
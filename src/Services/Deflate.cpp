@@ -0,0 +1,208 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+const size_t kBlock = 64 * 1024;
+const size_t kWindow = 32 * 1024;
+const int kHashBits = 15;
+const size_t kMinMatch = 3;
+const size_t kMaxMatch = 258;
+
+const uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; ++i) reversed |= ((code >> i) & 1u) << (length - 1 - i);
+    return reversed;
+}
+
+// fixed Huffman codes (RFC 1951, 3.2.6), bit-reversed once so they can be
+// emitted LSB first like every other field
+struct FixedCodes {
+    uint16_t litCode[288];
+    uint8_t litLength[288];
+    uint8_t distCode[30];
+
+    FixedCodes() {
+        for (uint32_t v = 0; v < 288; ++v) {
+            uint32_t code;
+            int len;
+            if (v < 144) { code = 0x30 + v; len = 8; }
+            else if (v < 256) { code = 0x190 + (v - 144); len = 9; }
+            else if (v < 280) { code = v - 256; len = 7; }
+            else { code = 0xC0 + (v - 280); len = 8; }
+            litCode[v] = (uint16_t)reverseBits(code, len);
+            litLength[v] = (uint8_t)len;
+        }
+        for (uint32_t d = 0; d < 30; ++d) distCode[d] = (uint8_t)reverseBits(d, 5);
+    }
+};
+
+const FixedCodes &fixedCodes() {
+    static const FixedCodes codes;
+    return codes;
+}
+
+uint32_t hash3(const uint8_t *p) {
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+// index of the last table entry <= v
+template <size_t N, typename T>
+int codeFor(const T (&base)[N], size_t v) {
+    return (int)(std::upper_bound(base, base + N, (T)v) - base) - 1;
+}
+
+} // namespace
+
+void DeflateStream::begin(std::vector<uint8_t> &o) {
+    out = &o;
+    window.clear();
+    pendingStart = 0;
+    head.assign((size_t)1 << kHashBits, -1);
+    adler = 1;
+    bitBuf = 0;
+    bitCount = 0;
+    // zlib header: deflate, 32 KiB window, fastest level, no dictionary
+    out->push_back(0x78);
+    out->push_back(0x01);
+}
+
+void DeflateStream::write(const uint8_t *data, size_t n) {
+    adler = adler32(data, n, adler);
+    window.insert(window.end(), data, data + n);
+    while (window.size() - pendingStart >= kBlock) compressPending(false);
+}
+
+void DeflateStream::finish() {
+    compressPending(true);
+    flushBits();
+    for (int shift = 24; shift >= 0; shift -= 8) out->push_back((uint8_t)(adler >> shift));
+    out = nullptr;
+}
+
+void DeflateStream::putBits(uint32_t bits, int count) {
+    bitBuf |= (uint64_t)bits << bitCount;
+    bitCount += count;
+    if (bitCount >= 32) {
+        uint8_t bytes[4] = {(uint8_t)bitBuf, (uint8_t)(bitBuf >> 8), (uint8_t)(bitBuf >> 16), (uint8_t)(bitBuf >> 24)};
+        out->insert(out->end(), bytes, bytes + 4);
+        bitBuf >>= 32;
+        bitCount -= 32;
+    }
+}
+
+void DeflateStream::flushBits() {
+    while (bitCount > 0) {
+        out->push_back((uint8_t)bitBuf);
+        bitBuf >>= 8;
+        bitCount = bitCount > 8 ? bitCount - 8 : 0;
+    }
+}
+
+void DeflateStream::putLiteral(uint8_t byte) {
+    const FixedCodes &codes = fixedCodes();
+    putBits(codes.litCode[byte], codes.litLength[byte]);
+}
+
+void DeflateStream::putMatch(size_t length, size_t distance) {
+    const FixedCodes &codes = fixedCodes();
+    int lc = codeFor(kLengthBase, length);
+    uint32_t symbol = 257u + (uint32_t)lc;
+    putBits(codes.litCode[symbol], codes.litLength[symbol]);
+    if (kLengthExtra[lc]) putBits((uint32_t)(length - kLengthBase[lc]), kLengthExtra[lc]);
+    int dc = codeFor(kDistBase, distance);
+    putBits(codes.distCode[dc], 5);
+    if (kDistExtra[dc]) putBits((uint32_t)(distance - kDistBase[dc]), kDistExtra[dc]);
+}
+
+void DeflateStream::compressPending(bool last) {
+    const size_t end = last ? window.size() : pendingStart + kBlock;
+    const uint8_t *w = window.data();
+    // at worst 9 bits per byte
+    out->reserve(out->size() + (end - pendingStart) * 9 / 8 + 64);
+    // block header: BFINAL, BTYPE = 01 (fixed Huffman codes)
+    putBits(last ? 1u : 0u, 1);
+    putBits(1u, 2);
+    size_t i = pendingStart;
+    // incompressible stretches (soups) are probed less and less often
+    unsigned misses = 0;
+    size_t nextProbe = i;
+    while (i < end) {
+        size_t len = 0, dist = 0;
+        if (i >= nextProbe && i + kMinMatch <= end) {
+            uint32_t h = hash3(w + i);
+            int32_t cand = head[h];
+            head[h] = (int32_t)i;
+            if (cand >= 0 && i - (size_t)cand <= kWindow && std::memcmp(w + cand, w + i, kMinMatch) == 0) {
+                size_t limit = std::min(kMaxMatch, end - i);
+                len = kMinMatch;
+                while (len < limit && w[cand + len] == w[i + len]) ++len;
+                dist = i - (size_t)cand;
+            }
+        }
+        if (len) {
+            putMatch(len, dist);
+            i += len;
+            misses = 0;
+            nextProbe = i;
+            // the match's last position keeps runs and repeated rows findable
+            if (i >= 1 && i - 1 + kMinMatch <= end) head[hash3(w + i - 1)] = (int32_t)(i - 1);
+        } else {
+            if (i >= nextProbe) nextProbe = i + 1 + (misses++ >> 5);
+            putLiteral(w[i]);
+            ++i;
+        }
+    }
+    putBits(fixedCodes().litCode[256], 7);   // end of block
+    pendingStart = end;
+    // keep only the last 32 KiB as history
+    if (pendingStart > kWindow) {
+        size_t shift = pendingStart - kWindow;
+        window.erase(window.begin(), window.begin() + (std::ptrdiff_t)shift);
+        pendingStart -= shift;
+        for (int32_t &pos : head) pos = pos >= (int32_t)shift ? pos - (int32_t)shift : -1;
+    }
+}
+
+uint32_t DeflateStream::crc32(const uint8_t *data, size_t n, uint32_t crc) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t DeflateStream::adler32(const uint8_t *data, size_t n, uint32_t value) {
+    uint32_t a = value & 0xffff, b = value >> 16;
+    while (n > 0) {
+        // 5552 bytes is the largest run that cannot overflow 32 bits
+        size_t chunk = std::min<size_t>(n, 5552);
+        for (size_t i = 0; i < chunk; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += chunk;
+        n -= chunk;
+    }
+    return (b << 16) | a;
+}
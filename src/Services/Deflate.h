@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// In-tree zlib (RFC 1950/1951) encoder for PNG output, no external dependency.
+// Data is fed in pieces (e.g. one image row at a time) and compressed in
+// 64 KiB blocks with fixed Huffman codes; matches are found with a
+// single-probe hash over a 32 KiB window that spans block boundaries, which
+// catches the long runs and repeated rows of Life frames.
+class DeflateStream {
+public:
+    // start a new zlib stream appended to `out`
+    void begin(std::vector<uint8_t> &out);
+    void write(const uint8_t *data, size_t n);
+    // flush the last block and the Adler-32 trailer
+    void finish();
+
+    static uint32_t crc32(const uint8_t *data, size_t n, uint32_t crc = 0);
+    static uint32_t adler32(const uint8_t *data, size_t n, uint32_t adler = 1);
+
+private:
+    void compressPending(bool last);
+    void putBits(uint32_t bits, int count);
+    void flushBits();   // pad to a byte boundary
+    void putLiteral(uint8_t byte);
+    void putMatch(size_t length, size_t distance);
+
+    std::vector<uint8_t> *out = nullptr;
+    // window: up to 32 KiB of history followed by the bytes not yet compressed
+    std::vector<uint8_t> window;
+    size_t pendingStart = 0;
+    std::vector<int32_t> head;    // hash -> position in `window`, -1 = none
+    uint32_t adler = 1;
+    uint64_t bitBuf = 0;
+    int bitCount = 0;
+};
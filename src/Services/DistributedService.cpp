@@ -0,0 +1,332 @@
+#include "DistributedService.h"
+#include "../Core/StepKernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+namespace {
+
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL;   // a dead peer is an error, not SIGPIPE
+#else
+const int kSendFlags = 0;
+#endif
+
+enum : int32_t { OpStep = 1, OpSnapshot = 2, OpQuit = 3 };
+
+struct InitHeader {
+	int32_t rows, cols;
+	int32_t toric;
+	int32_t birth, survive;
+};
+
+struct StepReply {
+	int64_t population;
+	int32_t changed;
+	int32_t lastChanged;    // last generation of the batch (1-based) that changed the stripe, 0 = none
+};
+
+bool sendAll(int fd, const void *data, size_t n) {
+	const char *p = static_cast<const char *>(data);
+	while (n > 0) {
+		ssize_t w = send(fd, p, n, kSendFlags);
+		if (w < 0 && errno == EINTR) continue;
+		if (w <= 0) return false;
+		p += w;
+		n -= (size_t)w;
+	}
+	return true;
+}
+
+bool recvAll(int fd, void *data, size_t n) {
+	char *p = static_cast<char *>(data);
+	while (n > 0) {
+		ssize_t r = recv(fd, p, n, 0);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) return false;
+		p += r;
+		n -= (size_t)r;
+	}
+	return true;
+}
+
+// Send one row to each neighbour and receive one from each (fd -1 = none).
+// Sends and receives are interleaved with poll() so two workers pushing rows
+// larger than the socket buffer at each other cannot deadlock.
+bool exchangeRows(int up, int down, const uint8_t *toUp, const uint8_t *toDown, uint8_t *fromUp, uint8_t *fromDown, size_t n) {
+	struct Side {
+		int fd;
+		const uint8_t *out;
+		uint8_t *in;
+		size_t sent, got;
+	} sides[2] = {{up, toUp, fromUp, 0, 0}, {down, toDown, fromDown, 0, 0}};
+	for (;;) {
+		pollfd fds[2];
+		Side *owner[2];
+		nfds_t count = 0;
+		for (Side &s : sides) {
+			if (s.fd < 0 || (s.sent == n && s.got == n)) continue;
+			short events = (short)((s.sent < n ? POLLOUT : 0) | (s.got < n ? POLLIN : 0));
+			fds[count] = pollfd{s.fd, events, 0};
+			owner[count++] = &s;
+		}
+		if (count == 0) return true;
+		if (poll(fds, count, -1) < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		for (nfds_t i = 0; i < count; ++i) {
+			Side &s = *owner[i];
+			bool progress = false;
+			if (fds[i].revents & POLLIN) {
+				ssize_t r = recv(s.fd, s.in + s.got, n - s.got, MSG_DONTWAIT);
+				if (r == 0) return false;
+				if (r > 0) { s.got += (size_t)r; progress = true; }
+				else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+			}
+			if (fds[i].revents & POLLOUT) {
+				ssize_t w = send(s.fd, s.out + s.sent, n - s.sent, MSG_DONTWAIT | kSendFlags);
+				if (w > 0) { s.sent += (size_t)w; progress = true; }
+				else if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+			}
+			if (!progress && (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))) return false;
+		}
+	}
+}
+
+// Body of a worker process: receive the stripe, then serve commands until
+// OpQuit or until the coordinator goes away. Returns the exit code.
+int workerMain(int control, int up, int down) {
+	InitHeader h;
+	if (!recvAll(control, &h, sizeof h)) return 1;
+	const int rows = h.rows, cols = h.cols;
+	// a lone stripe of a torus wraps onto itself; otherwise the halo rows come
+	// from the neighbours and the stripe grid itself is bounded
+	const bool selfWrap = h.toric && up < 0 && down < 0;
+	const bool wrapColumns = h.toric && !selfWrap;
+	Grid cur(rows, cols), next(rows, cols);
+	cur.setToric(selfWrap);
+	next.setToric(selfWrap);
+	for (int r = 0; r < rows; ++r) {
+		uint8_t *p = cur.rowPtr(r);
+		if (!recvAll(control, p, (size_t)cols)) return 1;
+		// obstacles arrive as Grid::kObstacle bits in the cell bytes
+		for (int c = 0; c < cols; ++c) {
+			if (p[c] & Grid::kObstacle) cur.setObstacle(r, c, true);
+			p[c] &= Grid::kAlive;
+		}
+	}
+	next.shareObstacles(cur);
+	const ObstacleMask *obstacles = cur.obstacleMask();
+	// the rule's row kernels, picked once for the whole run
+	const StepKernel::RowKernel kernels[2] = {StepKernel::ruleRow((uint16_t)h.birth, (uint16_t)h.survive, false),
+	                                            StepKernel::ruleRow((uint16_t)h.birth, (uint16_t)h.survive, true)};
+
+	for (;;) {
+		int32_t cmd[2];
+		if (!recvAll(control, cmd, sizeof cmd)) return 1;
+		if (cmd[0] == OpStep) {
+			int32_t changed = 0, lastChanged = 0;
+			for (int32_t g = 0; g < cmd[1]; ++g) {
+				cur.refreshHalo();
+				if (!exchangeRows(up, down, cur.rowPtr(0), cur.rowPtr(rows - 1), cur.rowPtr(-1), cur.rowPtr(rows), (size_t)cols)) return 1;
+				if (wrapColumns) {
+					for (int r = -1; r <= rows; ++r) {
+						uint8_t *p = cur.rowPtr(r);
+						p[-1] = p[cols - 1];
+						p[cols] = p[0];
+					}
+				}
+				changed = 0;
+				for (int r = 0; r < rows; ++r) {
+					const uint8_t *mask = obstacles ? obstacles->row(r) : nullptr;
+					kernels[mask != nullptr](cur.rowPtr(r - 1), cur.rowPtr(r), cur.rowPtr(r + 1), next.rowPtr(r), cols, (uint32_t)h.birth, (uint32_t)h.survive, mask);
+					if (!changed) changed = std::memcmp(cur.rowPtr(r), next.rowPtr(r), (size_t)cols) != 0;
+				}
+				if (changed) lastChanged = g + 1;
+				cur.swap(next);
+			}
+			StepReply reply{cur.population(), changed, lastChanged};
+			if (!sendAll(control, &reply, sizeof reply)) return 1;
+		} else if (cmd[0] == OpSnapshot) {
+			for (int r = 0; r < rows; ++r) {
+				if (!sendAll(control, cur.rowPtr(r), (size_t)cols)) return 1;
+			}
+		} else {
+			return 0;
+		}
+	}
+}
+
+} // namespace
+#endif
+
+DistributedService::~DistributedService() { stop(); }
+
+#ifdef _WIN32
+
+bool DistributedService::start(const Grid &, uint16_t, uint16_t, int, std::string *error) {
+	if (error) *error = "distributed mode needs a POSIX system";
+	return false;
+}
+
+bool DistributedService::advance(int, DistributedStats &) { return false; }
+bool DistributedService::snapshot(Grid &) { return false; }
+void DistributedService::stop() {}
+
+#else
+
+bool DistributedService::start(const Grid &initial, uint16_t birth, uint16_t survive, int stripes, std::string *error) {
+	stop();
+	boardRows = initial.getR();
+	boardCols = initial.getC();
+	toric = initial.isToric();
+	generation = 0;
+	obstacles = initial.obstacleLayer();
+	if (boardRows <= 0 || boardCols <= 0) {
+		if (error) *error = "empty board";
+		return false;
+	}
+	if (initial.getTopology() != Topology::Bounded && initial.getTopology() != Topology::Torus) {
+		if (error) *error = std::string("distributed mode supports bounded and torus boards only, not ") + Grid::topologyName(initial.getTopology());
+		return false;
+	}
+	if (stripes < 1) stripes = 1;
+	if (stripes > boardRows) stripes = boardRows;
+
+	// link i joins the bottom of stripe i to the top of stripe (i + 1) % stripes
+	int links = (toric && stripes > 1) ? stripes : stripes - 1;
+	std::vector<int> linkFds;
+	for (int i = 0; i < links; ++i) {
+		int sv[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+			for (int fd : linkFds) close(fd);
+			if (error) *error = std::string("socketpair: ") + std::strerror(errno);
+			return false;
+		}
+		linkFds.push_back(sv[0]);   // 2i: down end of stripe i
+		linkFds.push_back(sv[1]);   // 2i + 1: up end of stripe i + 1
+	}
+
+	bool ok = true;
+	for (int i = 0; i < stripes && ok; ++i) {
+		Worker w;
+		w.firstRow = (int)((long long)boardRows * i / stripes);
+		w.rows = (int)((long long)boardRows * (i + 1) / stripes) - w.firstRow;
+		int down = i < links ? linkFds[(size_t)(2 * i)] : -1;
+		int up = i > 0 ? linkFds[(size_t)(2 * (i - 1) + 1)] : (links == stripes ? linkFds[(size_t)(2 * (stripes - 1) + 1)] : -1);
+		int control[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, control) != 0) {
+			if (error) *error = std::string("socketpair: ") + std::strerror(errno);
+			ok = false;
+			break;
+		}
+		pid_t pid = fork();
+		if (pid < 0) {
+			close(control[0]);
+			close(control[1]);
+			if (error) *error = std::string("fork: ") + std::strerror(errno);
+			ok = false;
+			break;
+		}
+		if (pid == 0) {
+			// worker: keep only its own control end and its two neighbour links
+			close(control[0]);
+			for (const Worker &other : workers) close(other.control);
+			for (int fd : linkFds) if (fd != up && fd != down) close(fd);
+			_exit(workerMain(control[1], up, down));
+		}
+		close(control[1]);
+		w.pid = (int)pid;
+		w.control = control[0];
+		workers.push_back(w);
+	}
+	for (int fd : linkFds) close(fd);
+
+	for (const Worker &w : workers) {
+		if (!ok) break;
+		InitHeader h{w.rows, boardCols, toric ? 1 : 0, birth, survive};
+		ok = sendAll(w.control, &h, sizeof h);
+		std::vector<uint8_t> line((size_t)boardCols);
+		for (int r = 0; r < w.rows && ok; ++r) {
+			const uint8_t *cells = initial.rowPtr(w.firstRow + r);
+			const uint8_t *mask = obstacles ? obstacles->row(w.firstRow + r) : nullptr;
+			if (mask) {
+				for (int c = 0; c < boardCols; ++c) line[(size_t)c] = (uint8_t)(cells[c] | (mask[c] & Grid::kObstacle));
+				cells = line.data();
+			}
+			ok = sendAll(w.control, cells, (size_t)boardCols);
+		}
+		if (!ok && error) *error = "failed to send a stripe to its worker";
+	}
+	if (!ok) stop();
+	return ok;
+}
+
+bool DistributedService::advance(int n, DistributedStats &stats) {
+	if (workers.empty() || n < 0) return false;
+	int32_t cmd[2] = {OpStep, n};
+	bool ok = true;
+	// every worker must be stepping before any of them can finish a halo exchange
+	for (const Worker &w : workers) ok = ok && sendAll(w.control, cmd, sizeof cmd);
+	stats.population = 0;
+	stats.changed = false;
+	stats.stripePopulation.assign(workers.size(), 0);
+	// once no stripe changes in a generation the board is a still life, so
+	// the first stable generation comes right after the last stripe change
+	int32_t lastChanged = 0;
+	for (size_t i = 0; i < workers.size() && ok; ++i) {
+		StepReply reply;
+		ok = recvAll(workers[i].control, &reply, sizeof reply);
+		if (!ok) break;
+		stats.stripePopulation[i] = reply.population;
+		stats.population += reply.population;
+		stats.changed = stats.changed || reply.changed != 0;
+		lastChanged = std::max(lastChanged, reply.lastChanged);
+	}
+	if (!ok) {
+		stop();
+		return false;
+	}
+	if (stats.stableGeneration < 0 && lastChanged < n) stats.stableGeneration = generation + lastChanged + 1;
+	generation += n;
+	stats.generation = generation;
+	return true;
+}
+
+bool DistributedService::snapshot(Grid &out) {
+	if (workers.empty()) return false;
+	out.setGridDimensions(boardRows, boardCols);
+	out.setToric(toric);
+	int32_t cmd[2] = {OpSnapshot, 0};
+	bool ok = true;
+	for (const Worker &w : workers) ok = ok && sendAll(w.control, cmd, sizeof cmd);
+	for (const Worker &w : workers) {
+		for (int r = 0; r < w.rows && ok; ++r) ok = recvAll(w.control, out.rowPtr(w.firstRow + r), (size_t)boardCols);
+	}
+	out.setObstacleLayer(obstacles);
+	if (!ok) stop();
+	return ok;
+}
+
+void DistributedService::stop() {
+	int32_t cmd[2] = {OpQuit, 0};
+	for (const Worker &w : workers) sendAll(w.control, cmd, sizeof cmd);
+	for (const Worker &w : workers) {
+		close(w.control);
+		int status = 0;
+		while (waitpid((pid_t)w.pid, &status, 0) < 0 && errno == EINTR) {}
+	}
+	workers.clear();
+}
+
+#endif
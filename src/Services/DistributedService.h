@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Core/Grid.h"
+
+// Statistics gathered by the coordinator after a batch of generations
+struct DistributedStats {
+	int generation = 0;                     // generations run since start()
+	long long population = 0;
+	bool changed = true;                    // false once the last generation changed no stripe
+	int stableGeneration = -1;              // first generation that changed nothing, -1 while the board moves
+	std::vector<long long> stripePopulation;
+};
+
+// Multi-process simulation on one host. The board is cut into row stripes,
+// each owned by a forked worker process that keeps only its stripe (plus a
+// one-row halo) in memory and runs the life-like row kernel on it. Every
+// generation a worker sends its first and last rows to its neighbours and
+// receives their boundary rows into its halo over Unix domain sockets; on a
+// torus the last stripe is linked back to the first.
+//
+// The calling process is the coordinator: it ships each worker its stripe,
+// drives generations, gathers statistics and assembles snapshots. The wire
+// protocol only uses stream sockets, so workers do not depend on sharing
+// memory with the coordinator. POSIX only: start() fails on Windows.
+class DistributedService {
+public:
+	DistributedService() = default;
+	~DistributedService();
+
+	DistributedService(const DistributedService &) = delete;
+	DistributedService &operator=(const DistributedService &) = delete;
+
+	// Fork `stripes` workers (capped at the row count) for `initial` under the
+	// life-like rule birth/survive; false with `error` set on failure
+	bool start(const Grid &initial, uint16_t birth, uint16_t survive, int stripes, std::string *error = nullptr);
+	// Run n generations on every worker and gather their statistics
+	bool advance(int n, DistributedStats &stats);
+	// Gather the stripes into `out` (same size and toric flag as the initial grid)
+	bool snapshot(Grid &out);
+	// Ask the workers to exit and reap them; called by the destructor
+	void stop();
+
+	bool isRunning() const { return !workers.empty(); }
+	int stripeCount() const { return (int)workers.size(); }
+
+private:
+	struct Worker {
+		int pid = -1;
+		int control = -1;       // coordinator end of the control socket
+		int firstRow = 0;
+		int rows = 0;
+	};
+
+	std::vector<Worker> workers;
+	int boardRows = 0;
+	int boardCols = 0;
+	bool toric = false;
+	int generation = 0;
+	// obstacles are static: snapshots take the initial grid's layer back
+	std::shared_ptr<const ObstacleMask> obstacles;
+};
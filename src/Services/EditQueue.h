@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "../Core/Grid.h"
+
+// One cell of a user edit. Toggles are resolved when the edit is applied, so
+// they see the generation that is current at that point. Paint is a brush
+// stroke: the first Paint cell of a command is toggled and the following
+// ones take the state it got.
+struct CellEdit {
+    enum class Op : unsigned char { Alive, Dead, Toggle, Obstacle, NoObstacle, ToggleObstacle, Paint };
+    int r = 0;
+    int c = 0;
+    Op op = Op::Toggle;
+};
+
+// A user edit as queued by the input handlers. A Cells command is a whole
+// paint stroke and is applied in one go; the other kinds replace the board.
+struct EditCommand {
+    enum class Kind { Cells, Resize, Size, Preset };
+    Kind kind = Kind::Cells;
+    std::vector<CellEdit> cells;    // Cells
+    int rows = 0;                   // Resize
+    int cols = 0;
+    GridSize size = GridSize::NORMAL;   // Size
+    int preset = 0;                 // Preset
+};
+
+// Lock-free multi-producer / single-consumer queue.
+// Producers push onto an atomic singly linked stack with one CAS; the consumer
+// detaches the whole stack with one exchange and reverses it, so items come
+// out in push order (per producer) without locks or ABA hazards.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    ~MpscQueue() { drain([](T &) {}); }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // any thread
+    void push(T value) {
+        Node *n = new Node{std::move(value), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+    // consumer thread only: hand every queued item to fn in push order
+    template <typename F>
+    size_t drain(F &&fn) {
+        Node *list = head.exchange(nullptr, std::memory_order_acquire);
+        Node *ordered = nullptr;
+        while (list) {
+            Node *next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+        size_t count = 0;
+        while (ordered) {
+            Node *next = ordered->next;
+            fn(ordered->value);
+            delete ordered;
+            ordered = next;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node *next;
+    };
+    std::atomic<Node *> head{nullptr};
+};
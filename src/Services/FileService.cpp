@@ -1,5 +1,9 @@
 #include "FileService.h"
 #include "../Core/Grid.h"
+#include "CensusService.h"
+#include "../Core/QuadTree.h"
+#include "FrameExporter.h"
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -14,63 +18,132 @@ std::vector<std::string> FileService::listInputFiles(const std::string &inputDir
         for (auto &entry : fs::directory_iterator(inputDir)) {
             if (!entry.is_regular_file()) continue;
             auto p = entry.path();
-            if (p.extension() == ".txt") out.push_back(p.string());
+            if (p.extension() == ".txt" || p.extension() == ".mc") out.push_back(p.string());
         }
     } catch (...) {}
     return out;
 }
 
 bool FileService::readGridFromFile(const std::string &path, Grid &out) {
-    std::ifstream ifs(path);
+    return streamGridFromFile(path, out, GridLoadOptions());
+}
+
+namespace {
+
+const size_t kStreamChunk = 1 << 20;
+
+// Incremental parser for the cell lines of a grid file. Tokens are separated
+// by blanks; A/a = alive obstacle, D/d = dead obstacle, anything else is read
+// like std::stoi (optional sign, then digits) and is alive when non-zero.
+// Missing cells and rows are dead, extra tokens and rows are ignored.
+class GridLineParser {
+public:
+    explicit GridLineParser(Grid &g) : grid(g), row(g.getR() > 0 ? g.rowPtr(0) : nullptr) {}
+
+    // consume `n` bytes; false once every row has been read
+    bool feed(const char *p, size_t n) {
+        for (size_t i = 0; i < n && r < grid.getR(); ++i) {
+            char ch = p[i];
+            if (ch == '\n') {
+                endToken();
+                endRow();
+            } else if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f') {
+                endToken();
+            } else {
+                tokenChar(ch);
+            }
+        }
+        return r < grid.getR();
+    }
+
+    // end of file: close the last line and clear the rows never reached
+    void finish() {
+        endToken();
+        if (c > 0) endRow();
+        while (r < grid.getR()) endRow();
+    }
+
+    int rowsDone() const { return r; }
+
+private:
+    enum class Token { None, AliveObstacle, DeadObstacle, Number, Junk };
+
+    void tokenChar(char ch) {
+        if (token == Token::None) {
+            if (ch == 'A' || ch == 'a') token = Token::AliveObstacle;
+            else if (ch == 'D' || ch == 'd') token = Token::DeadObstacle;
+            else if (ch == '+' || ch == '-') token = Token::Number;
+            else if (ch >= '0' && ch <= '9') { token = Token::Number; digits = true; nonZero = ch != '0'; }
+            else token = Token::Junk;
+        } else if (token == Token::Number && !stopped) {
+            if (ch >= '0' && ch <= '9') { digits = true; nonZero |= ch != '0'; }
+            else stopped = true;
+        }
+    }
+
+    void endToken() {
+        if (token == Token::None) return;
+        if (c < grid.getC()) {
+            uint8_t v = 0;
+            if (token == Token::AliveObstacle || (token == Token::Number && digits && nonZero)) v = Grid::kAlive;
+            // obstacles go to the grid's obstacle layer, the cell keeps its state
+            if (token == Token::AliveObstacle || token == Token::DeadObstacle) grid.setObstacle(r, c, true);
+            row[c++] = v;
+        }
+        token = Token::None;
+        digits = nonZero = stopped = false;
+    }
+
+    void endRow() {
+        for (; c < grid.getC(); ++c) row[c] = 0;
+        c = 0;
+        if (++r < grid.getR()) row = grid.rowPtr(r);
+    }
+
+    Grid &grid;
+    uint8_t *row;
+    int r = 0;
+    int c = 0;
+    Token token = Token::None;
+    bool digits = false;
+    bool nonZero = false;
+    bool stopped = false;
+};
+
+} // namespace
+
+bool FileService::streamGridFromFile(const std::string &path, Grid &out, const GridLoadOptions &opt) {
+    if (fs::path(path).extension() == ".mc") return readMacrocell(path, out);
+    std::ifstream ifs(path, std::ios::binary);
     if (!ifs.is_open()) return false;
     int rows = 0, cols = 0;
     if (!(ifs >> rows >> cols)) return false;
     if (rows <= 0 || cols <= 0) return false;
-    out.setGridDimensions(rows, cols);
     std::string line;
     std::getline(ifs, line); // consume rest of first line
+    if (!opt.backingFile.empty()) {
+        if (!out.mapStorage(opt.backingFile, rows, cols)) return false;
+    } else {
+        out.setGridDimensions(rows, cols);
+    }
 
-    for (int r = 0; r < rows; ++r) {
-        if (!std::getline(ifs, line)) {
-            // missing row: treat as all zeros
-            for (int c = 0; c < cols; ++c) {
-                out.setCell(r, c, false);
-                out.setObstacle(r, c, false);
-            }
-            continue;
-        }
-
-        // parse tokens from the line; support 0/1 and obstacle markers A/a (alive obstacle) and D/d (dead obstacle)
-        std::istringstream iss(line);
-        std::string token;
-        int c = 0;
-        while (c < cols && (iss >> token)) {
-            if (token.empty()) { ++c; continue; }
-            char ch = token[0];
-            if (ch == 'A' || ch == 'a') {
-                out.setCell(r, c, true);
-                out.setObstacle(r, c, true);
-            } else if (ch == 'D' || ch == 'd') {
-                out.setCell(r, c, false);
-                out.setObstacle(r, c, true);
-            } else {
-                // try numeric
-                int value = 0;
-                try {
-                    value = std::stoi(token);
-                } catch (...) { value = 0; }
-                out.setCell(r, c, value != 0);
-                out.setObstacle(r, c, false);
-            }
-            ++c;
-        }
-        // pad remaining columns with zeros
-        for (; c < cols; ++c) {
-            out.setCell(r, c, false);
-            out.setObstacle(r, c, false);
+    GridLineParser parser(out);
+    std::vector<char> chunk(kStreamChunk);
+    const int band = opt.bandRows > 0 ? opt.bandRows : rows;
+    int reported = 0;
+    bool more = true;
+    while (more && ifs) {
+        ifs.read(chunk.data(), (std::streamsize)chunk.size());
+        size_t got = (size_t)ifs.gcount();
+        if (got == 0) break;
+        more = parser.feed(chunk.data(), got);
+        if (opt.progress && parser.rowsDone() - reported >= band) {
+            reported = parser.rowsDone() / band * band;
+            if (!opt.progress(parser.rowsDone(), rows)) return false;
         }
     }
-
+    parser.finish();
+    if (opt.progress && !opt.progress(rows, rows)) return false;
     return true;
 }
 
@@ -100,3 +173,176 @@ bool FileService::writeGridIteration(const std::string &baseName, int iter, cons
         return false;
     }
 }
+
+bool FileService::readMacrocell(const std::string &path, QuadTree &out, std::string *rule) {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) return false;
+    out.clear();
+    // one entry per node line (1-based, 0 = empty). Levels 1 and 2 only occur in
+    // files from multi-state writers; they are kept as bitmaps until a level 3
+    // node turns them into a leaf.
+    struct Entry {
+        int level;
+        QuadTree::Id id;
+        uint64_t bits;
+    };
+    std::vector<Entry> entries(1, Entry{0, 0, 0});
+    std::string line;
+    bool header = false;
+    while (std::getline(ifs, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        if (!header) {
+            if (line.compare(0, 4, "[M2]") != 0) return false;
+            header = true;
+            continue;
+        }
+        if (line[0] == '#') {
+            if (rule && line.size() > 2 && line[1] == 'R') {
+                std::istringstream iss(line.substr(2));
+                iss >> *rule;
+            }
+            continue;
+        }
+        if (line[0] == '.' || line[0] == '*' || line[0] == '$') {
+            uint64_t bits = 0;
+            int r = 0, c = 0;
+            for (char ch : line) {
+                if (ch == '$') { ++r; c = 0; continue; }
+                if (ch != '.' && ch != '*') return false;
+                if (r >= 8 || c >= 8) return false;
+                if (ch == '*') bits |= 1ull << (r * 8 + c);
+                ++c;
+            }
+            entries.push_back(Entry{QuadTree::kLeafLevel, out.leaf(bits), bits});
+            continue;
+        }
+        std::istringstream iss(line);
+        int level = 0;
+        size_t q[4];
+        if (!(iss >> level >> q[0] >> q[1] >> q[2] >> q[3]) || level < 1 || level > 63) return false;
+        if (level == 1) {
+            // cell states; anything but 0 is alive
+            uint64_t bits = (q[0] ? 1ull : 0) | (q[1] ? 2ull : 0) | (q[2] ? 1ull << 8 : 0) | (q[3] ? 2ull << 8 : 0);
+            entries.push_back(Entry{1, 0, bits});
+            continue;
+        }
+        for (size_t k : q) {
+            if (k >= entries.size() || (k != 0 && entries[k].level != level - 1)) return false;
+        }
+        if (level <= QuadTree::kLeafLevel) {
+            int half = 1 << (level - 1);
+            uint64_t bits = entries[q[0]].bits | (entries[q[1]].bits << half)
+                          | (entries[q[2]].bits << (8 * half)) | (entries[q[3]].bits << (8 * half + half));
+            entries.push_back(Entry{level, level == QuadTree::kLeafLevel ? out.leaf(bits) : 0, bits});
+        } else {
+            entries.push_back(Entry{level, out.node(level, entries[q[0]].id, entries[q[1]].id, entries[q[2]].id, entries[q[3]].id), 0});
+        }
+    }
+    if (!header) return false;
+    // the last node line is the root
+    const Entry &root = entries.back();
+    if (root.level < QuadTree::kLeafLevel) out.setRoot(out.leaf(root.bits), QuadTree::kLeafLevel);
+    else out.setRoot(root.id, root.level);
+    return true;
+}
+
+bool FileService::readMacrocell(const std::string &path, Grid &out, std::string *rule) {
+    QuadTree tree;
+    if (!readMacrocell(path, tree, rule)) return false;
+    uint64_t row0 = 0, col0 = 0, rows = 1, cols = 1;
+    if (!tree.boundingBox(row0, col0, rows, cols)) {
+        out.setGridDimensions(1, 1);
+        return true;
+    }
+    // bounds first: the product of two 63-bit sides would overflow
+    if (rows > (uint64_t)INT32_MAX || cols > (uint64_t)INT32_MAX) return false;
+    if ((long long)rows * (long long)cols > kMaxMacrocellGridCells) return false;
+    out.setGridDimensions((int)rows, (int)cols);
+    return tree.paint(out, row0, col0);
+}
+
+namespace {
+
+// post-order: children are written (and numbered) before their parent
+size_t writeMacrocellNode(std::ostream &os, const QuadTree &tree, QuadTree::Id id, std::vector<size_t> &lineOf, size_t &lines) {
+    if (id == 0) return 0;
+    if (lineOf[id] != 0) return lineOf[id];
+    if (tree.level(id) == QuadTree::kLeafLevel) {
+        uint64_t bits = tree.leafBits(id);
+        int lastRow = 7;
+        while (lastRow > 0 && ((bits >> (lastRow * 8)) & 0xff) == 0) --lastRow;
+        for (int r = 0; r <= lastRow; ++r) {
+            uint64_t row = (bits >> (r * 8)) & 0xff;
+            for (int c = 0; row >> c; ++c) os << (((row >> c) & 1) ? '*' : '.');
+            os << '$';
+        }
+        os << '\n';
+    } else {
+        size_t q[4];
+        for (int k = 0; k < 4; ++k) q[k] = writeMacrocellNode(os, tree, tree.child(id, k), lineOf, lines);
+        os << tree.level(id) << ' ' << q[0] << ' ' << q[1] << ' ' << q[2] << ' ' << q[3] << '\n';
+    }
+    lineOf[id] = ++lines;
+    return lines;
+}
+
+} // namespace
+
+bool FileService::writeMacrocell(const std::string &path, const QuadTree &tree, const std::string &rule) {
+    try {
+        fs::path p(path);
+        if (p.has_parent_path() && !fs::exists(p.parent_path())) fs::create_directories(p.parent_path());
+        std::ofstream ofs(path);
+        if (!ofs.is_open()) return false;
+        ofs << "[M2] (GameOfLife)\n";
+        if (!rule.empty()) ofs << "#R " << rule << '\n';
+        std::vector<size_t> lineOf(tree.nodeCount(), 0);
+        size_t lines = 0;
+        writeMacrocellNode(ofs, tree, tree.root(), lineOf, lines);
+        return (bool)ofs;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool FileService::writeMacrocell(const std::string &path, const Grid &g, int r0, int c0, int rows, int cols, const std::string &rule) {
+    if (rows < 0) rows = g.getR() - r0;
+    if (cols < 0) cols = g.getC() - c0;
+    if (r0 < 0 || c0 < 0 || rows <= 0 || cols <= 0 || r0 + rows > g.getR() || c0 + cols > g.getC()) return false;
+    QuadTree tree;
+    tree.fromGrid(g, r0, c0, rows, cols);
+    return writeMacrocell(path, tree, rule);
+}
+
+bool FileService::writeImage(const std::string &path, const Grid &g, const ImageOptions &opt) {
+    PackedFrame frame;
+    frame.pack(0, g);
+    std::vector<uint8_t> bytes, row;
+    DeflateStream deflate;
+    FrameExporter::encode(frame, opt, bytes, row, deflate);
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char *>(bytes.data()), (std::streamsize)bytes.size());
+    return (bool)ofs;
+}
+
+bool FileService::writeCensusTable(const std::string &path, const CensusResult &census) {
+    try {
+        fs::path p(path);
+        if (p.has_parent_path() && !fs::exists(p.parent_path())) fs::create_directories(p.parent_path());
+        std::ofstream ofs(path);
+        if (!ofs.is_open()) return false;
+        uint64_t total = 0;
+        for (const auto &e : census.entries) total += e.count;
+        ofs << "# rule " << census.rule << '\n';
+        ofs << "# soups " << census.soups << " unstabilised " << census.unstabilised << " objects " << total << '\n';
+        ofs << "code,kind,period,population,count,frequency\n";
+        for (const auto &e : census.entries) {
+            ofs << e.code << ',' << e.kind << ',' << e.period << ',' << e.population << ',' << e.count << ','
+                << (total ? (double)e.count / (double)total : 0.0) << '\n';
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
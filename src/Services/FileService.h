@@ -1,23 +1,69 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "../Core/Grid.h"
 
+struct CensusResult;
+struct ImageOptions;
+class QuadTree;
+
+// How GameService saves generations: one text file per generation, or a
+// single compressed container (GenerationArchive) with random access
+enum class OutputMode { Text, Archive };
+
+// Options of FileService::streamGridFromFile
+struct GridLoadOptions {
+	// called as rows are parsed (at most once per `bandRows` rows) and once at
+	// the end, with (rows read, total rows); returning false cancels the load
+	std::function<bool(int, int)> progress;
+	int bandRows = 1024;
+	// non-empty: the grid storage is a memory-mapped file created at this path
+	// (Grid::mapStorage) instead of heap memory
+	std::string backingFile;
+};
+
 class FileService {
 public:
-	// List input files (txt) in a directory
+	// List input files (.txt and .mc macrocell) in a directory
 	static std::vector<std::string> listInputFiles(const std::string &inputDir);
 
 	// Read grid from file into provided Grid reference
 	// Format: first line: <rows> <cols>
 	// Following lines: tokens per cell (0/1 or A/D for obstacle alive/dead)
+	// Files ending in .mc are read as macrocell (readMacrocell)
 	static bool readGridFromFile(const std::string &path, Grid &out);
 
+	// Same text format, parsed in fixed-size chunks straight into the grid's
+	// rows: peak memory is the grid plus one chunk, whatever the file size.
+	// .mc files are read whole by readMacrocell (no progress, no backing file).
+	// On failure or cancellation `out` is left partially loaded.
+	static bool streamGridFromFile(const std::string &path, Grid &out, const GridLoadOptions &opt);
+
+	// Macrocell format ([M2], as written by Golly): 8x8 leaves and "level nw ne sw se"
+	// node lines forming a hash-consed quadtree, so repeated structure is stored
+	// once. Reading into a QuadTree works for any size; reading into a Grid crops
+	// to the live cells' bounding box and fails above kMaxMacrocellGridCells.
+	// Only alive/dead is stored: obstacles are not part of the format.
+	static constexpr long long kMaxMacrocellGridCells = 1LL << 30;
+	static bool readMacrocell(const std::string &path, QuadTree &out, std::string *rule = nullptr);
+	static bool readMacrocell(const std::string &path, Grid &out, std::string *rule = nullptr);
+	static bool writeMacrocell(const std::string &path, const QuadTree &tree, const std::string &rule = "");
+	// export the rows x cols region of `g` at (r0, c0); rows/cols < 0 = up to the edge
+	static bool writeMacrocell(const std::string &path, const Grid &g, int r0 = 0, int c0 = 0, int rows = -1, int cols = -1, const std::string &rule = "");
+
 	// Write a grid iteration to an output directory with a base name
 	static bool writeGridIteration(const std::string &baseName, int iter, const Grid &g, const std::string &outDir = "Output");
+
+	// Export one generation as a PNG or PPM image (FrameExporter::encode);
+	// FrameExporter writes whole sequences in the background
+	static bool writeImage(const std::string &path, const Grid &g, const ImageOptions &opt);
+
+	// Write a census frequency table as CSV (code,kind,period,population,count,frequency)
+	static bool writeCensusTable(const std::string &path, const CensusResult &census);
 };
 
 
@@ -0,0 +1,224 @@
+#include "FrameExporter.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// the low bit of 8 consecutive cell (or obstacle mask) bytes, as one byte (cell i -> bit i)
+uint8_t gatherBit(const uint8_t *cells) {
+    uint64_t v;
+    std::memcpy(&v, cells, 8);
+    return (uint8_t)(((v & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56);
+}
+
+// 8 cells per byte (words are little-endian, so byte k holds cells 8k..8k+7)
+void packRow(const uint8_t *bytes, int cols, uint8_t *dst) {
+    int c = 0;
+    for (; c + 8 <= cols; c += 8) dst[c / 8] = gatherBit(bytes + c);
+    for (; c < cols; ++c) dst[c / 8] |= (uint8_t)((bytes[c] & 1u) << (c % 8));
+}
+
+// 8 one-bit pixels -> 8 two-bit pixels, MSB first (PNG order): pixel i of the
+// result is bit i of the input, as the low bit of its 2-bit field
+const std::array<uint16_t, 256> &spreadTable() {
+    static const std::array<uint16_t, 256> table = [] {
+        std::array<uint16_t, 256> t{};
+        for (int b = 0; b < 256; ++b) {
+            uint16_t v = 0;
+            for (int i = 0; i < 8; ++i) {
+                if (b & (1 << i)) v |= (uint16_t)(1u << ((i < 4 ? 8 : 0) + 6 - 2 * (i % 4)));
+            }
+            t[(size_t)b] = v;
+        }
+        return t;
+    }();
+    return table;
+}
+
+void putU32BE(std::vector<uint8_t> &out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back((uint8_t)(v >> shift));
+}
+
+// the chunk opened at `lengthAt` ends here: patch its length, append its CRC
+void closeChunk(std::vector<uint8_t> &out, size_t lengthAt) {
+    uint32_t len = (uint32_t)(out.size() - lengthAt - 8);
+    for (int i = 0; i < 4; ++i) out[lengthAt + (size_t)i] = (uint8_t)(len >> (24 - 8 * i));
+    putU32BE(out, DeflateStream::crc32(out.data() + lengthAt + 4, len + 4));
+}
+
+size_t openChunk(std::vector<uint8_t> &out, const char *type) {
+    size_t at = out.size();
+    putU32BE(out, 0);
+    out.insert(out.end(), type, type + 4);
+    return at;
+}
+
+// palette index of cell c in row words: alive | obstacle << 1
+inline unsigned cellIndex(const uint64_t *alive, const uint64_t *obstacle, int c) {
+    unsigned a = (unsigned)(alive[c / 64] >> (c % 64)) & 1u;
+    unsigned o = obstacle ? (unsigned)(obstacle[c / 64] >> (c % 64)) & 1u : 0u;
+    return a | (o << 1);
+}
+
+} // namespace
+
+void PackedFrame::pack(int gen, const Grid &g) {
+    generation = gen;
+    rows = g.getR();
+    cols = g.getC();
+    wordsPerRow = ((size_t)cols + 63) / 64;
+    alive.assign((size_t)rows * wordsPerRow, 0);
+    for (int r = 0; r < rows; ++r) packRow(g.rowPtr(r), cols, reinterpret_cast<uint8_t *>(alive.data() + (size_t)r * wordsPerRow));
+    obstacle.clear();
+    const ObstacleMask *obstacles = g.obstacleMask();
+    if (!obstacles) return;
+    obstacle.assign(alive.size(), 0);
+    for (int r = 0; r < rows; ++r) {
+        if (const uint8_t *mask = obstacles->row(r)) packRow(mask, cols, reinterpret_cast<uint8_t *>(obstacle.data() + (size_t)r * wordsPerRow));
+    }
+}
+
+void FrameExporter::encode(const PackedFrame &f, const ImageOptions &opt, std::vector<uint8_t> &out,
+                           std::vector<uint8_t> &row, DeflateStream &deflate) {
+    const int scale = opt.scale > 0 ? opt.scale : 1;
+    const uint32_t width = (uint32_t)f.cols * (uint32_t)scale;
+    const uint32_t height = (uint32_t)f.rows * (uint32_t)scale;
+    const uint32_t colours[4] = {opt.dead, opt.alive, opt.obstacle, opt.obstacle};
+    const bool obstacles = !f.obstacle.empty();
+    out.clear();
+
+    if (opt.format == ImageOptions::Format::Ppm) {
+        std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+        out.insert(out.end(), header.begin(), header.end());
+        row.resize((size_t)width * 3);
+        for (int r = 0; r < f.rows; ++r) {
+            const uint64_t *a = f.alive.data() + (size_t)r * f.wordsPerRow;
+            const uint64_t *o = obstacles ? f.obstacle.data() + (size_t)r * f.wordsPerRow : nullptr;
+            uint8_t *px = row.data();
+            for (int c = 0; c < f.cols; ++c) {
+                uint32_t rgb = colours[cellIndex(a, o, c)];
+                for (int s = 0; s < scale; ++s) {
+                    *px++ = (uint8_t)(rgb >> 16);
+                    *px++ = (uint8_t)(rgb >> 8);
+                    *px++ = (uint8_t)rgb;
+                }
+            }
+            for (int s = 0; s < scale; ++s) out.insert(out.end(), row.begin(), row.end());
+        }
+        return;
+    }
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.insert(out.end(), signature, signature + 8);
+    size_t at = openChunk(out, "IHDR");
+    putU32BE(out, width);
+    putU32BE(out, height);
+    out.push_back(2);   // bit depth
+    out.push_back(3);   // indexed colour
+    out.push_back(0);
+    out.push_back(0);
+    out.push_back(0);
+    closeChunk(out, at);
+    at = openChunk(out, "PLTE");
+    for (uint32_t rgb : colours) {
+        out.push_back((uint8_t)(rgb >> 16));
+        out.push_back((uint8_t)(rgb >> 8));
+        out.push_back((uint8_t)rgb);
+    }
+    closeChunk(out, at);
+
+    // scanline: filter byte 0 (none), then 4 pixels per byte
+    const size_t rowBytes = 1 + ((size_t)width * 2 + 7) / 8;
+    row.assign(rowBytes, 0);
+    const auto &spread = spreadTable();
+    at = openChunk(out, "IDAT");
+    deflate.begin(out);
+    for (int r = 0; r < f.rows; ++r) {
+        const uint64_t *a = f.alive.data() + (size_t)r * f.wordsPerRow;
+        const uint64_t *o = obstacles ? f.obstacle.data() + (size_t)r * f.wordsPerRow : nullptr;
+        uint8_t *px = row.data() + 1;
+        if (scale == 1) {
+            // 8 cells -> 2 bytes straight from the packed words
+            const uint8_t *ab = reinterpret_cast<const uint8_t *>(a);
+            const uint8_t *ob = reinterpret_cast<const uint8_t *>(o);
+            size_t bytes = ((size_t)f.cols + 7) / 8;
+            for (size_t i = 0; i < bytes; ++i) {
+                uint16_t v = spread[ab[i]];
+                if (ob) v |= (uint16_t)(spread[ob[i]] << 1);
+                px[2 * i] = (uint8_t)(v >> 8);
+                if (2 * i + 1 < rowBytes - 1) px[2 * i + 1] = (uint8_t)v;
+            }
+            // bits past the last column are zero in the packed words, so the padding is too
+        } else {
+            std::memset(px, 0, rowBytes - 1);
+            size_t x = 0;
+            for (int c = 0; c < f.cols; ++c) {
+                unsigned idx = cellIndex(a, o, c);
+                for (int s = 0; s < scale; ++s, ++x) px[x / 4] |= (uint8_t)(idx << (6 - 2 * (x % 4)));
+            }
+        }
+        // repeated scanlines cost a few bytes each once deflated
+        for (int s = 0; s < scale; ++s) deflate.write(row.data(), rowBytes);
+    }
+    deflate.finish();
+    closeChunk(out, at);
+    at = openChunk(out, "IEND");
+    closeChunk(out, at);
+}
+
+bool FrameExporter::open(const std::string &d, const std::string &base, const ImageOptions &opt, size_t pendingLimit) {
+    close();
+    try {
+        if (!fs::exists(d)) fs::create_directories(d);
+    } catch (...) {
+        return false;
+    }
+    dir = d;
+    baseName = base;
+    options = opt;
+    maxPending = pendingLimit > 0 ? pendingLimit : 1;
+    return true;
+}
+
+void FrameExporter::submit(int generation, const Grid &g) {
+    if (!isOpen()) return;
+    std::shared_ptr<PackedFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(freeMtx);
+        if (!freeFrames.empty()) {
+            frame = std::move(freeFrames.back());
+            freeFrames.pop_back();
+        }
+    }
+    if (!frame) frame = std::make_shared<PackedFrame>();
+    frame->pack(generation, g);
+    if (writer.pending() >= maxPending) {
+        ++stallCount;
+        writer.waitBelow(maxPending);
+    }
+    std::string path = (fs::path(dir) / (baseName + "_" + std::to_string(generation)
+        + (options.format == ImageOptions::Format::Png ? ".png" : ".ppm"))).string();
+    ImageOptions opt = options;
+    writer.submit([this, frame, path, opt]() {
+        encode(*frame, opt, fileBytes, rowBuffer, deflate);
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char *>(fileBytes.data()), (std::streamsize)fileBytes.size());
+        if (ofs) ++written;
+        else ++failures;
+        std::lock_guard<std::mutex> lock(freeMtx);
+        freeFrames.push_back(frame);
+    });
+}
+
+void FrameExporter::flush() { writer.flush(); }
+
+void FrameExporter::close() {
+    flush();
+    dir.clear();
+}
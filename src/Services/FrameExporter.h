@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AsyncWriter.h"
+#include "../Core/Grid.h"
+#include "Deflate.h"
+
+// Look of exported frames
+struct ImageOptions {
+    enum class Format { Png, Ppm };
+    Format format = Format::Png;
+    int scale = 1;                  // pixels per cell side
+    uint32_t dead = 0x000000;       // 0xRRGGBB
+    uint32_t alive = 0xFFFFFF;
+    uint32_t obstacle = 0x4060A0;
+};
+
+// One generation as bit planes, 64 cells per word (bit c % 64 of word
+// [r * wordsPerRow + c / 64] is cell (r, c)); the obstacle plane is left
+// empty when the board has none.
+struct PackedFrame {
+    int generation = 0;
+    int rows = 0;
+    int cols = 0;
+    size_t wordsPerRow = 0;
+    std::vector<uint64_t> alive;
+    std::vector<uint64_t> obstacle;
+
+    void pack(int gen, const Grid &g);
+};
+
+// Image sequence writer: submit() packs the generation on the calling thread
+// (1 bit per cell, 8 times less than copying the grid) and the frame is
+// scaled, colour-mapped and encoded on a background AsyncWriter thread,
+// through one reusable row buffer. PNG frames use a 2-bit palette (dead,
+// alive, obstacle, alive obstacle) compressed by DeflateStream; PPM frames
+// are raw RGB. Packed frames are recycled, and submit() blocks only when
+// `maxPending` frames are already waiting, so a slow disk throttles the
+// simulation instead of growing memory.
+class FrameExporter {
+public:
+    FrameExporter() = default;
+    ~FrameExporter() { flush(); }
+
+    FrameExporter(const FrameExporter &) = delete;
+    FrameExporter &operator=(const FrameExporter &) = delete;
+
+    // frames go to <dir>/<baseName>_<generation>.png|.ppm
+    bool open(const std::string &dir, const std::string &baseName, const ImageOptions &opt, size_t maxPending = 8);
+    bool isOpen() const { return !dir.empty(); }
+    void submit(int generation, const Grid &g);
+    // wait until every submitted frame is on disk
+    void flush();
+    void close();
+
+    uint64_t framesWritten() const { return written.load(); }
+    uint64_t writeFailures() const { return failures.load(); }
+    // times submit() had to wait for the writer
+    uint64_t stalls() const { return stallCount; }
+
+    // encode one frame into `out` (the whole file's bytes)
+    static void encode(const PackedFrame &f, const ImageOptions &opt, std::vector<uint8_t> &out,
+                       std::vector<uint8_t> &row, DeflateStream &deflate);
+
+private:
+    std::string dir;
+    std::string baseName;
+    ImageOptions options;
+    size_t maxPending = 8;
+    uint64_t stallCount = 0;
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> failures{0};
+    // recycled packed frames, shared with the writer thread
+    std::mutex freeMtx;
+    std::vector<std::shared_ptr<PackedFrame>> freeFrames;
+    // used by the writer thread only
+    std::vector<uint8_t> fileBytes;
+    std::vector<uint8_t> rowBuffer;
+    DeflateStream deflate;
+    // declared last so queued frames are written before the buffers go away
+    AsyncWriter writer;
+};
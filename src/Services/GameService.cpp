@@ -1,12 +1,29 @@
 
 #include "GameService.h"
 #include "../Core/GameRules.h"
+#include "../Core/StepKernel.h"
 #include "FileService.h"
+#include "StepProfiler.h"
+#include "CheckpointService.h"
 #include <vector>
 #include <memory>
 #include <filesystem>
-#include <thread>
 #include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <optional>
+
+// One row of a generation (columns c0 .. c0 + cols - 1 of board row r) through
+// the kernel of the rule's neighbourhood: the rule's Moore kernel (`moore`,
+// without / with obstacles, see GameService::ruleKernels), otherwise the
+// kernel specialised for the row's mask (hexagonal rows alternate, triangular
+// rows alternate per column).
+static inline void kernelRow(const Neighborhood &hood, const StepKernel::RowKernel moore[2], int r, int c0, const uint8_t *up, const uint8_t *mid,
+                             const uint8_t *down, uint8_t *out, int cols, uint16_t birth, uint16_t survive, const uint8_t *obstacles) {
+	if (hood.isMoore()) moore[obstacles != nullptr](up, mid, down, out, cols, birth, survive, obstacles);
+	else if (hood.layout == Neighborhood::Layout::Triangular) StepKernel::triangleRow((r + c0) & 1, obstacles != nullptr)(up, mid, down, out, cols, birth, survive, obstacles);
+	else StepKernel::maskRow(hood.maskAt(r, 0), obstacles != nullptr)(up, mid, down, out, cols, birth, survive, obstacles);
+}
 
 GameService::GameService() {
 	// default 20x20
@@ -14,6 +31,8 @@ GameService::GameService() {
 	buffer.setGridDimensions(20,20);
 	// default rule
 	rules = std::make_unique<ConwayRules>();
+	ruleKernels[0] = StepKernel::ruleRow(birthMask, surviveMask, false);
+	ruleKernels[1] = StepKernel::ruleRow(birthMask, surviveMask, true);
 }
 
 GameService::~GameService() {}
@@ -24,93 +43,755 @@ bool GameService::isRunning() const { return running.load(); }
 
 void GameService::setRuleType(RuleType rt) {
 	ruleType = rt;
-	if (rt == RuleType::CONWAY) rules = std::make_unique<ConwayRules>();
+	if (rt == RuleType::CONWAY) {
+		birthMask = LifeLikeRules::kConwayBirth;
+		surviveMask = LifeLikeRules::kConwaySurvive;
+		neighborhood = Neighborhood::moore();
+		rules = std::make_unique<ConwayRules>();
+	} else if (rt == RuleType::LIFE_LIKE) {
+		rules = std::make_unique<LifeLikeRules>(birthMask, surviveMask, neighborhood);
+	}
 	else rules.reset(); // BASIC not implemented yet -> nullptr (fallback)
+	// the row kernels are picked here, once per rule, not per step
+	ruleKernels[0] = StepKernel::ruleRow(birthMask, surviveMask, false);
+	ruleKernels[1] = StepKernel::ruleRow(birthMask, surviveMask, true);
+}
+
+bool GameService::setRule(const std::string &rule) {
+	uint16_t b = 0, s = 0;
+	Neighborhood n;
+	if (!LifeLikeRules::parse(rule, b, s, n)) return false;
+	if (b == LifeLikeRules::kConwayBirth && s == LifeLikeRules::kConwaySurvive && n.isMoore()) {
+		setRuleType(RuleType::CONWAY);
+		return true;
+	}
+	birthMask = b;
+	surviveMask = s;
+	neighborhood = n;
+	setRuleType(RuleType::LIFE_LIKE);
+	return true;
+}
+
+std::string GameService::getRuleString() const {
+	if (ruleType == RuleType::BASIC) return "basic";
+	return LifeLikeRules::format(birthMask, surviveMask, neighborhood);
+}
+
+void GameService::setNeighborhood(const Neighborhood &n) {
+	if (ruleType == RuleType::BASIC) {
+		neighborhood = n;
+		return;
+	}
+	setRule(LifeLikeRules::format(birthMask, surviveMask, n));
+}
+
+void GameService::postCells(std::vector<CellEdit> stroke) {
+	EditCommand cmd;
+	cmd.kind = EditCommand::Kind::Cells;
+	cmd.cells = std::move(stroke);
+	edits.push(std::move(cmd));
+}
+
+void GameService::postResize(int rows, int cols) {
+	EditCommand cmd;
+	cmd.kind = EditCommand::Kind::Resize;
+	cmd.rows = rows;
+	cmd.cols = cols;
+	edits.push(std::move(cmd));
+}
+
+void GameService::postGridSize(GridSize size) {
+	EditCommand cmd;
+	cmd.kind = EditCommand::Kind::Size;
+	cmd.size = size;
+	edits.push(std::move(cmd));
+}
+
+void GameService::postPreset(int slot) {
+	EditCommand cmd;
+	cmd.kind = EditCommand::Kind::Preset;
+	cmd.preset = slot;
+	edits.push(std::move(cmd));
+}
+
+size_t GameService::applyPendingEdits() {
+	if (edits.empty()) return 0;
+	return edits.drain([this](EditCommand &cmd) { applyEdit(cmd); });
+}
+
+void GameService::applyEdit(EditCommand &cmd) {
+	switch (cmd.kind) {
+		case EditCommand::Kind::Cells: {
+			int rows = grid.getR(), cols = grid.getC();
+			int paintState = -1;   // decided by the stroke's first Paint cell
+			for (const CellEdit &e : cmd.cells) {
+				// the board may have been resized since the stroke was drawn
+				if (e.r < 0 || e.r >= rows || e.c < 0 || e.c >= cols) continue;
+				switch (e.op) {
+					case CellEdit::Op::Alive: grid.setCell(e.r, e.c, true); break;
+					case CellEdit::Op::Dead: grid.setCell(e.r, e.c, false); break;
+					case CellEdit::Op::Toggle: grid.setCell(e.r, e.c, !grid.getCell(e.r, e.c)); break;
+					case CellEdit::Op::Paint:
+						if (paintState < 0) paintState = grid.getCell(e.r, e.c) ? 0 : 1;
+						grid.setCell(e.r, e.c, paintState != 0);
+						break;
+					case CellEdit::Op::Obstacle: grid.setObstacle(e.r, e.c, true); grid.setCell(e.r, e.c, false); break;
+					case CellEdit::Op::NoObstacle: grid.setObstacle(e.r, e.c, false); break;
+					case CellEdit::Op::ToggleObstacle: {
+						bool obs = !grid.isObstacle(e.r, e.c);
+						grid.setObstacle(e.r, e.c, obs);
+						if (obs) grid.setCell(e.r, e.c, false);
+					} break;
+				}
+			}
+		} break;
+		case EditCommand::Kind::Resize: setGridDimensions(cmd.rows, cmd.cols); break;
+		case EditCommand::Kind::Size: setGridSize(cmd.size); break;
+		case EditCommand::Kind::Preset: loadPreset(cmd.preset); break;
+	}
 }
 
 void GameService::step() {
-	int rows = grid.getR();
-	int cols = grid.getC();
+	// user edits land between two generations, never while one is computed
+	applyPendingEdits();
 	// use rules polymorphically if available
-	if (rules) {
-		buffer.setGridDimensions(rows, cols);
+	if (!rules) {
+		// fallback: do nothing
+		lastStepStable = false;
+		return;
+	}
+	// instrumentation is sampled once so a disabled profiler costs a single branch
+	const bool prof = profiler.isEnabled();
+	uint64_t gridAllocsBefore = 0;
+	if (prof) {
+		profiler.beginStep(currentIteration + 1);
+		gridAllocsBefore = Grid::matrixAllocationCount();
+	}
+	StepPlan plan;
+	// declared after everything its tasks reference so it is destroyed (and waited on) first
+	std::optional<TaskGroup> group;
+	{
+		auto phase = profiler.scope(StepProfiler::Phase::Spawn);
+		planStep(plan);
+		group.emplace(*plan.pool);
+		spawnGeneration(plan, *group);
+	}
+	commitGeneration(finishGeneration(plan, *group));
+	if (prof) profiler.recordGridAllocations(Grid::matrixAllocationCount() - gridAllocsBefore);
+}
+
+void GameService::planStep(StepPlan &plan) {
+	const int rows = grid.getR();
+	const int cols = grid.getC();
+	plan.prof = profiler.isEnabled();
+	// count-based rules run the branch-free row kernel over the halo;
+	// anything else goes through GameRules::computeNextState cell by cell
+	plan.birth = plan.survive = 0;
+	plan.useKernel = rules->lifeLikeMasks(plan.birth, plan.survive);
+	plan.hood = rules->neighborhood();
+	// mapped boards stream through memory stripe by stripe (profiling keeps the regular path)
+	plan.stripes = plan.useKernel && grid.isMapped() && !plan.prof;
+	// NUMA mode: one fixed band per pinned worker, on memory that worker touched first
+	plan.numa = numaAware && plan.useKernel && !plan.stripes && rows >= (int)numaWorkers().size();
+	plan.pool = plan.numa ? numaPool.get() : threadPool ? threadPool : &ThreadPool::shared();
+	ThreadPool &pool = *plan.pool;
+	plan.useTiles = plan.useKernel && !plan.numa && !plan.stripes && (long long)rows * cols >= tilingThreshold;
 
-		// Parallel compute next state per row range. Each worker will also copy
-		// obstacle flag for its rows into the buffer to avoid a separate pass.
-		unsigned int hw = std::thread::hardware_concurrency();
-		unsigned int nThreads = hw == 0 ? 2u : hw;
-		if ((int)nThreads > rows) nThreads = rows > 0 ? (unsigned int)rows : 1u;
+	// every interior cell of the buffer is rewritten by each generation, so it
+	// only needs clearing when the board size changed
+	if (buffer.getR() != rows || buffer.getC() != cols) buffer.setGridDimensions(rows, cols);
+	buffer.setTopology(grid.getTopology());
+	// placing the bands replaces both grids, so it comes before the buffer takes the layer
+	if (plan.numa && !bandsPlaced(pool.size())) placeBands(pool, pool.size());
+	// obstacles are static: the buffer takes the grid's layer as is, so
+	// they survive the swap without being copied cell by cell
+	buffer.shareObstacles(grid);
+
+	// Parallel compute next state per row range on the persistent pool.
+	unsigned int nThreads = plan.numa ? pool.size() : (maxThreads ? maxThreads : pool.size() + 1);
+	if ((int)nThreads > rows) nThreads = rows > 0 ? (unsigned int)rows : 1u;
+	plan.nThreads = nThreads;
+	if (plan.prof) {
+		workStart.resize(nThreads);
+		workEnd.resize(nThreads);
+		workAllocs.assign(nThreads, 0);
+	}
+	if (plan.useTiles) {
+		TileSize size = (tileSize.rows > 0 || tileSize.cols > 0) ? tileSize : TileTuner::tuned();
+		if (rows != tilesRows || cols != tilesCols || size.rows != tilesSize.rows || size.cols != tilesSize.cols) {
+			TileQueue::buildTiles(rows, cols, size, tiles);
+			tilesRows = rows; tilesCols = cols; tilesSize = size;
+		}
+	}
+	// row bands: the calling thread computes the last one itself
+	plan.lastEnd = rows;
+	plan.lastStart = rows - rows / (int)nThreads;
+}
 
-		std::vector<std::thread> workers;
-		workers.reserve(nThreads);
-		int chunk = rows / (int)nThreads;
-		int rem = rows % (int)nThreads;
+void GameService::spawnGeneration(const StepPlan &plan, TaskGroup &group) {
+	const int rows = grid.getR();
+	// once per generation, so the kernel never wraps or bounds-checks
+	if (plan.useKernel) grid.refreshHalo();
+	taskChanged.assign(plan.nThreads, 0);
+	if (plan.numa) {
+		for (unsigned int t = 0; t < plan.nThreads; ++t) group.runOn(t, [this, &plan, t]() { computeRows(plan, t, bandEdges[t], bandEdges[t + 1]); });
+	} else if (plan.useTiles) {
+		tileQueue.reset((int)tiles.size(), plan.nThreads);
+		for (unsigned int t = 0; t + 1 < plan.nThreads; ++t) group.run([this, &plan, t]() { computeTiles(plan, t); });
+	} else if (!plan.stripes) {
+		int chunk = rows / (int)plan.nThreads;
+		int rem = rows % (int)plan.nThreads;
 		int start = 0;
-		for (unsigned int t = 0; t < nThreads; ++t) {
-			int add = (t < (unsigned int)rem) ? 1 : 0;
-			int end = start + chunk + add;
-			workers.emplace_back([this, start, end, cols]() {
-				for (int r = start; r < end; ++r) {
-					for (int c = 0; c < cols; ++c) {
-						// copy obstacle flag for this cell
-						buffer.setObstacle(r, c, grid.isObstacle(r, c));
-						bool next = rules->computeNextState(grid, r, c);
-						buffer.setCell(r, c, next);
-					}
-				}
-			});
+		for (unsigned int t = 0; t + 1 < plan.nThreads; ++t) {
+			int end = start + chunk + ((t < (unsigned int)rem) ? 1 : 0);
+			group.run([this, &plan, t, start, end]() { computeRows(plan, t, start, end); });
 			start = end;
 		}
-		for (auto &th : workers) if (th.joinable()) th.join();
-		// detect stabilization: if buffer equals grid, stop running
-		if (buffer.equals(grid)) {
-			running = false;
-			// still increment iteration counter to indicate a step attempt
-			++currentIteration;
-			return;
-		}
-		// copy buffer back
-		for (int r = 0; r < rows; ++r) for (int c = 0; c < cols; ++c) grid.setCell(r, c, buffer.getCell(r, c));
-		// increment iteration counter
+	}
+}
+
+bool GameService::finishGeneration(const StepPlan &plan, TaskGroup &group) {
+	bool changed = false;
+	{
+		auto phase = profiler.scope(StepProfiler::Phase::Compute);
+		// in NUMA mode every band runs on its own worker and the caller only waits
+		if (plan.stripes) changed = stepStripes(*plan.pool, plan.nThreads, plan.hood, plan.birth, plan.survive);
+		else if (plan.useTiles) computeTiles(plan, plan.nThreads - 1);
+		else if (!plan.numa) computeRows(plan, plan.nThreads - 1, plan.lastStart, plan.lastEnd);
+		group.wait();
+	}
+	if (plan.prof) {
+		for (unsigned int t = 0; t < plan.nThreads; ++t) profiler.recordThreadWork((int)t, workStart[t], workEnd[t], workAllocs[t]);
+	}
+	// detect stabilization: every task compared the rows it wrote while they were in its cache
+	{
+		auto phase = profiler.scope(StepProfiler::Phase::Equals);
+		if (!plan.stripes) changed = std::find(taskChanged.begin(), taskChanged.end(), 1) != taskChanged.end();
+	}
+	return changed;
+}
+
+void GameService::commitGeneration(bool changed) {
+	lastStepStable = !changed;
+	if (!changed) {
+		running = false;
+		// still increment iteration counter to indicate a step attempt
 		++currentIteration;
-		// decide whether to write this iteration to file: save only first `saveIterations` when >0
-		if (!outputBase.empty() && saveIterations > 0 && currentIteration <= saveIterations) {
-			FileService::writeGridIteration(outputBase, currentIteration, grid);
+		return;
+	}
+	// swap the new generation in (the old one becomes next step's scratch)
+	{
+		auto phase = profiler.scope(StepProfiler::Phase::CopyBack);
+		const bool prof = profiler.isEnabled();
+		uint64_t allocsBefore = prof ? Cell::threadAllocationCount() : 0;
+		grid.swap(buffer);
+		if (prof) profiler.recordCellAllocations(Cell::threadAllocationCount() - allocsBefore);
+	}
+	// increment iteration counter
+	++currentIteration;
+	// decide whether to write this iteration to file: save only first `saveIterations` when >0
+	if (!outputBase.empty() && saveIterations > 0 && currentIteration <= saveIterations) {
+		auto phase = profiler.scope(StepProfiler::Phase::Write);
+		writeIteration();
+	}
+	if (frameEvery > 0 && currentIteration % frameEvery == 0) {
+		auto phase = profiler.scope(StepProfiler::Phase::Write);
+		frames.submit(currentIteration, grid);
+	}
+	// periodic checkpoint: snapshot now, serialize and write in the background
+	if (checkpointEvery > 0 && !checkpointPath.empty() && currentIteration % checkpointEvery == 0) {
+		auto snap = std::make_shared<State>(captureState());
+		std::string path = checkpointPath;
+		checkpointWriter.submit([snap, path]() { CheckpointService::write(path, *snap); });
+	}
+}
+
+void GameService::computeRows(const StepPlan &plan, unsigned int t, int start, int end) {
+	const int cols = grid.getC();
+	uint64_t allocsBefore = 0;
+	if (plan.prof) { workStart[t] = StepProfiler::clock::now(); allocsBefore = Cell::threadAllocationCount(); }
+	uint8_t changed = 0;
+	if (plan.useKernel) {
+		const ObstacleMask *obstacles = grid.obstacleMask();
+		for (int r = start; r < end; ++r) {
+			kernelRow(plan.hood, ruleKernels, r, 0, grid.rowPtr(r - 1), grid.rowPtr(r), grid.rowPtr(r + 1), buffer.rowPtr(r), cols, plan.birth, plan.survive,
+			          obstacles ? obstacles->row(r) : nullptr);
+			// compared here, while the row is still in this core's cache
+			changed |= std::memcmp(grid.rowPtr(r), buffer.rowPtr(r), (size_t)cols) != 0;
 		}
 	} else {
-		// fallback: do nothing
+		for (int r = start; r < end; ++r) {
+			for (int c = 0; c < cols; ++c) {
+				bool next = rules->computeNextState(grid, r, c);
+				buffer.setCell(r, c, next);
+			}
+			changed |= std::memcmp(grid.rowPtr(r), buffer.rowPtr(r), (size_t)cols) != 0;
+		}
 	}
+	taskChanged[t] = changed;
+	if (plan.prof) { workEnd[t] = StepProfiler::clock::now(); workAllocs[t] = Cell::threadAllocationCount() - allocsBefore; }
 }
 
-void GameService::reset() {
-	if (hasInitial) {
-		grid = initialGrid;
-		buffer = initialGrid;
+void GameService::computeTiles(const StepPlan &plan, unsigned int t) {
+	if (plan.prof) workStart[t] = StepProfiler::clock::now();
+	const ObstacleMask *obstacles = grid.obstacleMask();
+	uint8_t changed = 0;
+	for (int i = tileQueue.next(t); i >= 0; i = tileQueue.next(t)) {
+		const Tile &tile = tiles[(size_t)i];
+		int width = tile.c1 - tile.c0;
+		for (int r = tile.r0; r < tile.r1; ++r) {
+			const uint8_t *mask = obstacles ? obstacles->row(r) : nullptr;
+			uint8_t *out = buffer.rowPtr(r) + tile.c0;
+			kernelRow(plan.hood, ruleKernels, r, tile.c0, grid.rowPtr(r - 1) + tile.c0, grid.rowPtr(r) + tile.c0, grid.rowPtr(r + 1) + tile.c0,
+			          out, width, plan.birth, plan.survive, mask ? mask + tile.c0 : nullptr);
+			changed |= std::memcmp(grid.rowPtr(r) + tile.c0, out, (size_t)width) != 0;
+		}
+	}
+	taskChanged[t] = changed;
+	if (plan.prof) workEnd[t] = StepProfiler::clock::now();
+}
+
+bool GameService::stepStripes(ThreadPool &pool, unsigned nThreads, const Neighborhood &hood, uint16_t birth, uint16_t survive) {
+	const int rows = grid.getR(), cols = grid.getC();
+	const int height = stripeRows > 0 ? stripeRows : std::max(1, (32 << 20) / std::max(1, grid.getStride()));
+	// split each stripe so every task has a few rows
+	unsigned tasks = std::max(1u, std::min(nThreads, (unsigned)std::max(1, height / 4)));
+	stripeChanged.assign(tasks, 0);
+	grid.adviseRows(-1, std::min(rows, height) + 1, true);
+	for (int s0 = 0; s0 < rows; s0 += height) {
+		const int s1 = std::min(rows, s0 + height);
+		// window: the stripe read ahead...
+		if (s1 < rows) grid.adviseRows(s1, std::min(rows, s1 + height) + 1, true);
+		// ...the one computed now...
+		{
+			TaskGroup group(pool);
+			int span = s1 - s0, chunk = span / (int)tasks, rem = span % (int)tasks, start = s0;
+			for (unsigned t = 0; t < tasks; ++t) {
+				int end = start + chunk + (t < (unsigned)rem ? 1 : 0);
+				auto work = [this, t, start, end, cols, &hood, birth, survive]() {
+					const ObstacleMask *obstacles = grid.obstacleMask();
+					uint8_t changed = 0;
+					for (int r = start; r < end; ++r) {
+						kernelRow(hood, ruleKernels, r, 0, grid.rowPtr(r - 1), grid.rowPtr(r), grid.rowPtr(r + 1), buffer.rowPtr(r), cols, birth, survive,
+						          obstacles ? obstacles->row(r) : nullptr);
+						changed |= std::memcmp(grid.rowPtr(r), buffer.rowPtr(r), (size_t)cols) != 0;
+					}
+					stripeChanged[t] |= changed;
+				};
+				if (t + 1 < tasks) group.run(work);
+				else work();
+				start = end;
+			}
+			group.wait();
+		}
+		// ...and the one behind it, which no later stripe reads: its input is
+		// dropped, its output written back
+		if (s0 > 0) {
+			grid.adviseRows(s0 - height, s0 - 1, false);
+			buffer.adviseRows(s0 - height, s0, false);
+		}
+	}
+	return std::find(stripeChanged.begin(), stripeChanged.end(), 1) != stripeChanged.end();
+}
+
+bool GameService::setOutOfCore(const std::string &backingFile) {
+	if (backingFile.empty()) {
+		if (!grid.isMapped()) return true;
+		// the copy constructor allocates on the heap
+		Grid heap(grid);
+		grid.swap(heap);
+		buffer.release();
+		return true;
+	}
+	// both files are mapped before anything is swapped in: on failure the
+	// heap grid and buffer stay as they were
+	Grid mapped, mappedNext;
+	if (!mapped.mapStorage(backingFile, grid.getR(), grid.getC())) return false;
+	if (!mappedNext.mapStorage(backingFile + ".next", grid.getR(), grid.getC())) return false;
+	for (int r = 0; r < grid.getR(); ++r) std::memcpy(mapped.rowPtr(r), grid.rowPtr(r), (size_t)grid.getC());
+	mapped.setTopology(grid.getTopology());
+	mapped.shareObstacles(grid);
+	mappedNext.setTopology(grid.getTopology());
+	grid.swap(mapped);
+	buffer.swap(mappedNext);
+	mapped.release();
+	mappedNext.release();
+	return true;
+}
+
+void GameService::stepN(int k) {
+	applyPendingEdits();
+	int rows = grid.getR();
+	int cols = grid.getC();
+	uint16_t kernelBirth = 0, kernelSurvive = 0;
+	// anything that must observe intermediate generations goes through step()
+	const bool writes = !outputBase.empty() && saveIterations > 0 && currentIteration < saveIterations;
+	const bool checkpoints = checkpointEvery > 0 && !checkpointPath.empty()
+		&& (currentIteration + k) / checkpointEvery != currentIteration / checkpointEvery;
+	const bool framesDue = frameEvery > 0 && (currentIteration + k) / frameEvery != currentIteration / frameEvery;
+	// the bands rebuild their own edges, which only knows the bounded plane and the torus
+	const Topology topology = grid.getTopology();
+	const bool plainEdges = topology == Topology::Bounded || topology == Topology::Torus;
+	// and the band kernel is the Moore one
+	if (k <= 1 || rows == 0 || cols == 0 || !rules || !rules->lifeLikeMasks(kernelBirth, kernelSurvive)
+		|| !rules->neighborhood().isMoore() || writes || checkpoints || framesDue || !plainEdges || profiler.isEnabled()) {
+		for (int i = 0; i < k; ++i) step();
+		return;
+	}
+
+	ThreadPool &pool = threadPool ? *threadPool : ThreadPool::shared();
+	const size_t stride = (size_t)grid.getStride();
+	int bandRows = temporalBandRows;
+	if (bandRows <= 0) {
+		// two generations of the band plus its 2k overlap rows in L2, but at
+		// least 8k rows so the recomputed overlap stays around 1/8 of the work
+		const size_t cacheBytes = 256 * 1024;
+		bandRows = std::max(8 * k, (int)(cacheBytes / (2 * stride)) - 2 * k);
+	}
+	bandRows = std::min(bandRows, rows);
+	if (temporalBands.empty() || temporalBands.front().r1 != bandRows || temporalBands.back().r1 != rows || temporalBands.back().c1 != cols) {
+		TileQueue::buildTiles(rows, cols, TileSize{bandRows, 0}, temporalBands);
+	}
+	unsigned int nThreads = maxThreads ? maxThreads : pool.size() + 1;
+	if (nThreads > temporalBands.size()) nThreads = (unsigned int)temporalBands.size();
+	// ping-pong generations of one band, reused while the geometry does not grow
+	const size_t scratchBytes = 2 * ((size_t)bandRows + 2 * (size_t)k) * stride;
+	if (temporalScratch.size() < nThreads) temporalScratch.resize(nThreads);
+	for (unsigned int t = 0; t < nThreads; ++t) {
+		if (temporalScratch[t].size() < scratchBytes) temporalScratch[t].resize(scratchBytes);
+	}
+	temporalChanged.assign(temporalBands.size(), 0);
+
+	if (buffer.getR() != rows || buffer.getC() != cols) buffer.setGridDimensions(rows, cols);
+	buffer.setTopology(grid.getTopology());
+	buffer.shareObstacles(grid);
+	grid.refreshHalo();
+
+	auto computeBands = [this, k, kernelBirth, kernelSurvive](unsigned int t) {
+		uint8_t *scratch = temporalScratch[t].data();
+		for (int i = tileQueue.next(t); i >= 0; i = tileQueue.next(t)) {
+			temporalChanged[(size_t)i] = advanceBand(temporalBands[(size_t)i], k, scratch, kernelBirth, kernelSurvive);
+		}
+	};
+	{
+		TaskGroup group(pool);
+		tileQueue.reset((int)temporalBands.size(), nThreads);
+		for (unsigned int t = 0; t + 1 < nThreads; ++t) group.run([&computeBands, t]() { computeBands(t); });
+		computeBands(nThreads - 1);
+		group.wait();
+	}
+	// generation k is in the buffer even when it equals generation k-1
+	grid.swap(buffer);
+	currentIteration += k;
+	// stabilisation is absorbing, so comparing the last two generations is
+	// what k single steps would have concluded
+	lastStepStable = std::find(temporalChanged.begin(), temporalChanged.end(), 1) == temporalChanged.end();
+	if (lastStepStable) running = false;
+}
+
+GameService::AdvanceStats GameService::advance(int n) {
+	if (n <= 0) {
+		AdvanceStats none;
+		none.population = grid.population();
+		return none;
+	}
+	return advanceUntil([](const GameService &) { return false; }, n);
+}
+
+GameService::AdvanceStats GameService::advanceUntil(std::chrono::steady_clock::time_point deadline, int maxGenerations) {
+	AdvanceStats stats = advanceUntil([deadline](const GameService &) { return std::chrono::steady_clock::now() >= deadline; }, maxGenerations);
+	if (stats.stop == AdvanceStop::Predicate) stats.stop = AdvanceStop::Deadline;
+	return stats;
+}
+
+GameService::AdvanceStats GameService::advanceUntil(const std::function<bool(const GameService &)> &stop, int maxGenerations) {
+	AdvanceStats stats;
+	auto t0 = std::chrono::steady_clock::now();
+	// the plan and the task group serve the whole run; a profiled run keeps
+	// step() and its per-step records
+	const bool lean = !profiler.isEnabled();
+	StepPlan plan;
+	bool planned = false;
+	std::optional<TaskGroup> group;
+	// without rules step() is a no-op: nothing would ever end an unlimited run
+	while (rules && (maxGenerations <= 0 || stats.generations < maxGenerations)) {
+		if (!lean) step();
+		else {
+			// edits may resize the board or load a preset: the plan is resolved again after them
+			if (!planned || !edits.empty()) {
+				applyPendingEdits();
+				ThreadPool *before = plan.pool;
+				planStep(plan);
+				// NUMA mode runs on its own pool, which a resize can switch on or off
+				if (!planned || plan.pool != before) group.emplace(*plan.pool);
+				planned = true;
+			}
+			spawnGeneration(plan, *group);
+			commitGeneration(finishGeneration(plan, *group));
+		}
+		++stats.generations;
+		if (lastStepStable) {
+			stats.stop = AdvanceStop::Stabilized;
+			break;
+		}
+		if (stop(*this)) {
+			stats.stop = AdvanceStop::Predicate;
+			break;
+		}
+	}
+	stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	stats.population = grid.population();
+	return stats;
+}
+
+bool GameService::advanceBand(const Tile &band, int k, uint8_t *scratch, uint16_t birth, uint16_t survive) {
+	const int rows = grid.getR(), cols = grid.getC();
+	const size_t stride = (size_t)grid.getStride();
+	const bool toric = grid.isToric();
+	const int height = band.r1 - band.r0 + 2 * k;
+	const int first = band.r0 - k;   // board row of scratch row 0
+	const ObstacleMask *obstacles = grid.obstacleMask();
+	uint8_t *gen[2] = {scratch + 1, scratch + (size_t)height * stride + 1};
+	auto row = [&gen, stride](int which, int i) { return gen[which] + (size_t)i * stride; };
+
+	// generation 0: the band and k rows on each side, halo columns included;
+	// outside a bounded board both generations stay dead
+	for (int i = 0; i < height; ++i) {
+		int r = first + i;
+		if (toric) std::memcpy(row(0, i) - 1, grid.rowPtr(((r % rows) + rows) % rows) - 1, stride);
+		else if (r >= 0 && r < rows) std::memcpy(row(0, i) - 1, grid.rowPtr(r) - 1, stride);
+		else {
+			std::memset(row(0, i) - 1, 0, stride);
+			std::memset(row(1, i) - 1, 0, stride);
+		}
+	}
+	// each generation is valid one row further from the edges of the scratch
+	int cur = 0;
+	for (int j = 1; j <= k; ++j) {
+		int lo = j, hi = height - j;
+		if (!toric) {
+			lo = std::max(lo, -first);
+			hi = std::min(hi, rows - first);
+		}
+		for (int i = lo; i < hi; ++i) {
+			uint8_t *out = row(cur ^ 1, i);
+			const uint8_t *mask = obstacles ? obstacles->row(((first + i) % rows + rows) % rows) : nullptr;
+			ruleKernels[mask != nullptr](row(cur, i - 1), row(cur, i), row(cur, i + 1), out, cols, birth, survive, mask);
+			out[-1] = toric ? out[cols - 1] : 0;
+			out[cols] = toric ? out[0] : 0;
+		}
+		cur ^= 1;
+	}
+	// the band rows now hold generation k; compare with k-1 while both are in cache
+	bool changed = false;
+	for (int r = band.r0; r < band.r1; ++r) {
+		const uint8_t *last = row(cur, r - first);
+		if (!changed) changed = std::memcmp(last, row(cur ^ 1, r - first), (size_t)cols) != 0;
+		std::memcpy(buffer.rowPtr(r), last, (size_t)cols);
+	}
+	return changed;
+}
+
+bool GameService::bandsPlaced(unsigned bands) const {
+	const uint8_t *g = grid.rowPtr(-1), *b = buffer.rowPtr(-1);
+	bool same = (g == placedBlocks[0] && b == placedBlocks[1]) || (g == placedBlocks[1] && b == placedBlocks[0]);
+	return same && bandEdges.size() == bands + 1 && bandEdges.back() == grid.getR() && placedCols == grid.getC();
+}
+
+ThreadPool &GameService::numaWorkers() {
+	// as many workers as the configured pool, pinned once: the shared pool and
+	// the caller's pool are never pinned
+	unsigned n = threadPool ? threadPool->size() : 0;
+	if (!numaPool || (n != 0 && numaPool->size() != n)) {
+		numaPool = std::make_unique<ThreadPool>(n);
+		// new workers: the bands are first-touched again
+		placedCols = -1;
+	}
+	if (!numaPool->pinAttempted()) numaPool->pinWorkers();
+	return *numaPool;
+}
+
+void GameService::placeBands(ThreadPool &pool, unsigned bands) {
+	int rows = grid.getR(), cols = grid.getC();
+	bandEdges.resize(bands + 1);
+	for (unsigned t = 0; t <= bands; ++t) bandEdges[t] = (int)((long long)rows * t / bands);
+
+	// fresh blocks whose pages are first written by the worker owning each band
+	Grid placedGrid, placedBuffer;
+	placedGrid.allocateUntouched(rows, cols);
+	placedBuffer.allocateUntouched(rows, cols);
+	placedGrid.setTopology(grid.getTopology());
+	placedBuffer.setTopology(grid.getTopology());
+	size_t rowBytes = (size_t)grid.getStride();
+	{
+		TaskGroup group(pool);
+		for (unsigned t = 0; t < bands; ++t) {
+			group.runOn(t, [&, t]() {
+				// the first and last bands also own the halo rows
+				int from = t == 0 ? -1 : bandEdges[t];
+				int to = t + 1 == bands ? rows + 1 : bandEdges[t + 1];
+				for (int r = from; r < to; ++r) {
+					std::memcpy(placedGrid.rowPtr(r) - 1, grid.rowPtr(r) - 1, rowBytes);
+					std::memset(placedBuffer.rowPtr(r) - 1, 0, rowBytes);
+				}
+			});
+		}
+		group.wait();
+	}
+	placedGrid.shareObstacles(grid);
+	placedBuffer.shareObstacles(grid);
+	grid = std::move(placedGrid);
+	buffer = std::move(placedBuffer);
+	placedBlocks[0] = grid.rowPtr(-1);
+	placedBlocks[1] = buffer.rowPtr(-1);
+	placedCols = cols;
+}
+
+bool GameService::reset() {
+	bool ok = true;
+	if (initialGrid) {
+		grid = *initialGrid;
+	} else if (!initialPath.empty()) {
+		std::string path = initialPath;
+		GridLoadOptions opt = initialLoad;
+		ok = streamInitialFromFile(path, opt);
+		// a later reset() retries the same file
+		if (!ok) {
+			initialPath = path;
+			initialLoad = opt;
+		}
 	} else {
 		grid.setGridDimensions(20,20);
 		buffer.setGridDimensions(20,20);
 	}
 	// reset iteration counter
 	currentIteration = 0;
+	// the next saved generation starts a fresh archive
+	archive.close();
+	archiveFiles.clear();
+	archiveResumed = false;
+	return ok;
+}
+
+void GameService::setOutputMode(OutputMode m) {
+	if (m != outputMode) archive.close();
+	outputMode = m;
+}
+
+void GameService::closeArchive() { archive.close(); }
+
+bool GameService::startFrameExport(const std::string &dir, const ImageOptions &opt, int every) {
+	frameEvery = 0;
+	if (every <= 0 || !frames.open(dir, outputBase.empty() ? "frame" : outputBase, opt)) return false;
+	frameEvery = every;
+	return true;
+}
+
+void GameService::stopFrameExport() {
+	frameEvery = 0;
+	frames.close();
+}
+
+void GameService::writeIteration() {
+	if (outputMode == OutputMode::Text) {
+		FileService::writeGridIteration(outputBase, currentIteration, grid);
+		return;
+	}
+	std::string base = "Output/" + outputBase;
+	if (archive.isOpen() && archiveBase == base && archive.append(currentIteration, grid)) return;
+	// (re)open when the base name or board size changed since the last frame.
+	// Files this run already wrote, and every file after a resume, are
+	// continued rather than truncated; one holding another board size rolls
+	// over to <base>-<n>.gola.
+	archive.close();
+	archiveBase = base;
+	for (int n = 0; n < 1000; ++n) {
+		std::string path = n == 0 ? base + ".gola" : base + "-" + std::to_string(n) + ".gola";
+		bool known = std::find(archiveFiles.begin(), archiveFiles.end(), path) != archiveFiles.end();
+		bool otherSize = false;
+		bool opened = known || archiveResumed ? archive.openAppend(path, grid.getR(), grid.getC(), otherSize)
+		                                      : archive.open(path, grid.getR(), grid.getC());
+		if (opened) {
+			if (!known) archiveFiles.push_back(path);
+			if (archive.append(currentIteration, grid)) return;
+			break;
+		}
+		if (!otherSize) break;
+	}
+	archive.close();
+	std::cerr << "Cannot archive generation " << currentIteration << " to " << base << ".gola\n";
+}
+
+GameService::State GameService::captureState() const {
+	State s;
+	s.grid = grid;
+	s.initialGrid = initialGrid;
+	s.topology = grid.getTopology();
+	s.ruleType = ruleType;
+	s.birthMask = birthMask;
+	s.surviveMask = surviveMask;
+	s.neighborhood = neighborhood;
+	s.currentIteration = currentIteration;
+	s.iterationTarget = iterationTarget;
+	s.saveIterations = saveIterations;
+	s.tickMs = tickMs;
+	s.outputBase = outputBase;
+	return s;
+}
+
+void GameService::restoreState(const State &s) {
+	State copy = s;
+	restoreState(std::move(copy));
+}
+
+void GameService::restoreState(State &&s) {
+	grid = std::move(s.grid);
+	initialGrid = std::move(s.initialGrid);
+	initialPath.clear();
+	setTopology(s.topology);
+	birthMask = s.birthMask;
+	surviveMask = s.surviveMask;
+	neighborhood = s.neighborhood;
+	setRuleType(s.ruleType);
+	currentIteration = s.currentIteration;
+	iterationTarget = s.iterationTarget;
+	saveIterations = s.saveIterations;
+	tickMs = s.tickMs;
+	outputBase = std::move(s.outputBase);
+	// the archive of the run being resumed already holds the earlier generations
+	archiveResumed = true;
+}
+
+bool GameService::saveCheckpoint(const std::string &path) const {
+	return CheckpointService::write(path, captureState());
+}
+
+bool GameService::resumeFromCheckpoint(const std::string &path) {
+	State s;
+	if (!CheckpointService::read(path, s)) return false;
+	restoreState(std::move(s));
+	return true;
 }
 
 std::vector<std::string> GameService::listInputFiles() const {
 	return FileService::listInputFiles("Input");
 }
 
+bool GameService::refreshPatternLibrary() {
+	return patternLibrary.load("Input", "Input/.library.idx", threadPool ? *threadPool : ThreadPool::shared());
+}
+
 bool GameService::loadInitialFromFile(const std::string &path) {
-	Grid g;
-	if (!FileService::readGridFromFile(path, g)) return false;
-	// preserve current toric setting so loading a file doesn't disable wrapping
-	bool wasToric = grid.isToric();
-	grid = g;
-	buffer = g;
-	grid.setToric(wasToric);
-	buffer.setToric(wasToric);
+	// parse straight into the scratch grid and swap it in: the live grid is
+	// untouched if parsing fails, and no intermediate Grid is copied around
+	if (!FileService::readGridFromFile(path, buffer)) return false;
+	// preserve the current topology so loading a file doesn't disable wrapping
+	Topology topology = grid.getTopology();
+	grid.swap(buffer);
+	grid.setTopology(topology);
+	buffer.setTopology(topology);
 	// remember initial loaded state
-	initialGrid = g;
-	initialGrid.setToric(wasToric);
-	hasInitial = true;
+	snapshotInitial();
 	// set output base to input file stem
 	try {
 		std::filesystem::path p(path);
@@ -120,12 +801,48 @@ bool GameService::loadInitialFromFile(const std::string &path) {
 	return true;
 }
 
+bool GameService::streamInitialFromFile(const std::string &path, const GridLoadOptions &opt) {
+	// only the live grid may hold cells while the file is read
+	initialGrid.reset();
+	initialPath.clear();
+	buffer.release();
+	Topology topology = grid.getTopology();
+	auto fail = [this, topology]() {
+		// an empty heap board; swapping it in unmaps a mapped grid
+		Grid empty;
+		empty.setGridDimensions(20, 20);
+		empty.setTopology(topology);
+		grid.swap(empty);
+		buffer.release();
+		return false;
+	};
+	if (!FileService::streamGridFromFile(path, grid, opt)) return fail();
+	grid.setTopology(topology);
+	buffer.setTopology(topology);
+	// the scratch grid is otherwise allocated by the first step()
+	if (!opt.backingFile.empty() && !buffer.mapStorage(opt.backingFile + ".next", grid.getR(), grid.getC())) return fail();
+	initialPath = path;
+	initialLoad = opt;
+	try {
+		std::filesystem::path p(path);
+		outputBase = p.stem().string();
+	} catch (...) { outputBase = "input"; }
+	currentIteration = 0;
+	return true;
+}
+
+bool GameService::loadSoup(const SoupOptions &opt) {
+	if (!SoupGenerator::fill(grid, opt)) return false;
+	snapshotInitial();
+	currentIteration = 0;
+	return true;
+}
+
 void GameService::loadPreset(int slot) {
 	// helper to clear a grid of given size
 	auto prepare = [&](int rows, int cols) {
 		grid.setGridDimensions(rows, cols);
 		buffer.setGridDimensions(rows, cols);
-		for (int r = 0; r < rows; ++r) for (int c = 0; c < cols; ++c) { grid.setCell(r,c,false); grid.setObstacle(r,c,false); }
 	};
 
 	// helper to place a set of relative coordinates centered in the grid
@@ -240,10 +957,8 @@ void GameService::loadPreset(int slot) {
 		} break;
 	}
 
-	// apply to buffer and mark initial
-	buffer = grid;
-	initialGrid = grid;
-	hasInitial = true;
+	// mark initial (the buffer is sized by the next step())
+	snapshotInitial();
 	currentIteration = 0;
 }
 
@@ -1,13 +1,25 @@
 #pragma once
 
 #include "../Core/Grid.h"
+#include "../Core/GameRules.h"
+#include "../Core/StepKernel.h"
+#include "../Core/SoupGenerator.h"
+#include "StepProfiler.h"
+#include "AsyncWriter.h"
+#include "ThreadPool.h"
+#include "TileQueue.h"
+#include "EditQueue.h"
+#include "FileService.h"
+#include "GenerationArchive.h"
+#include "PatternLibrary.h"
+#include "FrameExporter.h"
+#include <cstdint>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <string>
 #include <memory>
 
-// forward: rules base class
-class GameRules;
-
 class GameService {
 public:
 	GameService();
@@ -16,7 +28,32 @@ public:
 	void start();
 	void pause();
 	void step();
-	void reset();
+	// Advance k generations; same result as k step() calls (grid, iteration
+	// index, stabilisation). Life-like rules are temporally blocked: each row
+	// band is loaded with k extra rows above and below and advanced k
+	// generations in a cache-resident scratch before the next band, so the
+	// board streams through memory once instead of k times. Other rules, file
+	// output, checkpoints or profiling due in the range fall back to step().
+	void stepN(int k);
+	// Back to the initial board; false when a streamed input could not be
+	// read again (the board is then left empty, see streamInitialFromFile)
+	bool reset();
+
+	// Multi-generation runs: step() in a tight loop that stops early when a
+	// generation leaves the board unchanged (which also clears isRunning()).
+	// File output and checkpoints follow the usual saveIterations/checkpoint policy.
+	enum class AdvanceStop { Completed, Stabilized, Predicate, Deadline };
+	struct AdvanceStats {
+		int generations = 0;        // generations stepped by this call
+		AdvanceStop stop = AdvanceStop::Completed;
+		double elapsedMs = 0.0;
+		int population = 0;         // live cells when the call returned
+	};
+	AdvanceStats advance(int n);
+	// until `stop` returns true (checked after every generation), the board
+	// stabilises, or `maxGenerations` were stepped (0 = no limit)
+	AdvanceStats advanceUntil(const std::function<bool(const GameService &)> &stop, int maxGenerations = 0);
+	AdvanceStats advanceUntil(std::chrono::steady_clock::time_point deadline, int maxGenerations = 0);
 
 	bool isRunning() const;
 	int getTickMs() const { return tickMs; }
@@ -31,26 +68,121 @@ public:
 	void setCell(int r, int c, bool v) { grid.setCell(r, c, v); }
 
 	void setGridDimensions(int rows, int cols) { grid.setGridDimensions(rows, cols); buffer.setGridDimensions(rows, cols); }
-	void setInitialGrid(const Grid &g) { grid = g; buffer = g; initialGrid = g; hasInitial = true; }
+	// make `g` the live grid and the reset snapshot; the rvalue overload moves it in
+	void setInitialGrid(const Grid &g) { grid = g; snapshotInitial(); }
+	void setInitialGrid(Grid &&g) { grid = std::move(g); snapshotInitial(); }
+	// immutable snapshot restored by reset(), shared with checkpoints (null = none)
+	std::shared_ptr<const Grid> getInitialGrid() const { return initialGrid; }
 
 	// convenience: set predefined sizes
 	void setGridSize(GridSize size) { grid.setGridSize(size); buffer.setGridSize(size); }
 
+	// Edits from input threads. The setters above touch the live grid and are
+	// only safe on the simulation thread; post*() may be called from any thread
+	// while step() runs: commands go through a lock-free queue and are applied
+	// in order between generations (start of step(), or applyPendingEdits()).
+	void postEdit(EditCommand cmd) { edits.push(std::move(cmd)); }
+	void postCells(std::vector<CellEdit> stroke);
+	void postResize(int rows, int cols);
+	void postGridSize(GridSize size);
+	void postPreset(int slot);
+	bool hasPendingEdits() const { return !edits.empty(); }
+	// simulation thread: apply every queued command, returns how many were applied
+	size_t applyPendingEdits();
+
 	// rule type (console UI toggles this)
-	enum class RuleType { BASIC, CONWAY };
+	enum class RuleType { BASIC, CONWAY, LIFE_LIKE };
 	void setRuleType(RuleType rt);
 	RuleType getRuleType() const { return ruleType; }
+	// life-like rule string such as "B3/S23" or "B36/S23"; false if it cannot be parsed
+	bool setRule(const std::string &rule);
+	std::string getRuleString() const;
+	// cells counted as neighbours (Moore by default); keeps the birth / survive
+	// digits, so a Conway rule with another neighbourhood becomes LIFE_LIKE
+	void setNeighborhood(const Neighborhood &n);
+	Neighborhood getNeighborhood() const { return neighborhood; }
+
+	// Intra-simulation parallelism: step() splits rows into tasks on `pool`
+	// (ThreadPool::shared() when null). maxThreads caps the number of tasks,
+	// 0 = pool size, 1 = compute inline on the calling thread.
+	void setThreadPool(ThreadPool *pool) { threadPool = pool; }
+	void setMaxThreads(unsigned n) { maxThreads = n; }
+	unsigned getMaxThreads() const { return maxThreads; }
+
+	// Boards of at least `tilingThreshold` cells running a life-like rule are
+	// stepped in cache-sized 2D tiles handed out by a work-stealing TileQueue.
+	// Tile size {0,0} = TileTuner's choice (measured once per process).
+	void setTileSize(TileSize size) { tileSize = size; }
+	TileSize getTileSize() const { return tileSize; }
+	void setTilingThreshold(long long cells) { tilingThreshold = cells; }
+	long long getTilingThreshold() const { return tilingThreshold; }
+	// NUMA-aware stepping (off by default): a dedicated pool, as large as the
+	// configured one, is pinned node by node (ThreadPool::pinWorkers) and each
+	// of its workers owns a fixed row band of both grids, whose pages it
+	// touched first; only the rows bordering a neighbour band are read across
+	// nodes. Applies to life-like rules on boards with at least one row per worker.
+	void setNumaAware(bool enabled) { numaAware = enabled; if (!enabled) numaPool.reset(); }
+	bool isNumaAware() const { return numaAware; }
+
+	// Out-of-core mode: move both generation buffers into memory-mapped files
+	// (<backingFile> and <backingFile>.next, see Grid::mapStorage); an empty
+	// path brings the board back to the heap. While the board is mapped,
+	// step() runs life-like rules stripe by stripe over a window of three
+	// stripes: the next one is prefetched, the current one computed on the
+	// pool, and the previous one written back and released.
+	bool setOutOfCore(const std::string &backingFile);
+	bool isOutOfCore() const { return grid.isMapped(); }
+	// rows per out-of-core stripe (0 = about 32 MiB of cells)
+	void setStripeRows(int rowsPerStripe) { stripeRows = rowsPerStripe; }
+	int getStripeRows() const { return stripeRows; }
+
+	// Rows per band in stepN() (0 = sized for L2, at least 8k rows)
+	void setTemporalBandRows(int rowsPerBand) { temporalBandRows = rowsPerBand; }
+	int getTemporalBandRows() const { return temporalBandRows; }
+
+	// tiles stolen between workers during the last tiled step
+	uint64_t getLastTileSteals() const { return tileQueue.steals(); }
 
 	void setOutputBase(const std::string &b) { outputBase = b; }
 	std::string getOutputBase() const { return outputBase; }
+	// Text: Output/<base>_<iter>.txt per generation. Archive: every saved
+	// generation goes to Output/<base>.gola (see GenerationArchive); the file
+	// is rewritten from the start by a new run (reset()), continued after
+	// restoreState() / resumeFromCheckpoint(), continued into
+	// <base>-<n>.gola when the board size changes, and finished on destruction.
+	void setOutputMode(OutputMode m);
+	OutputMode getOutputMode() const { return outputMode; }
+	// flush the archive index so the file can be read while the service lives
+	void closeArchive();
+	// Image sequence for videos: every `every` generations, step() hands the
+	// board to a FrameExporter (<dir>/<base>_<iter>.png|.ppm), which encodes
+	// on its own thread. stopFrameExport() waits for the queued frames.
+	bool startFrameExport(const std::string &dir, const ImageOptions &opt, int every = 1);
+	void stopFrameExport();
+	const FrameExporter &getFrameExporter() const { return frames; }
 
 	// Input file helpers (UI calls GameService; GameService delegates to FileService)
 	std::vector<std::string> listInputFiles() const;
+	// Pattern library: every .txt/.mc under Input/ (recursive), with metadata
+	// cached in Input/.library.idx; a rescan only parses new or changed files
+	bool refreshPatternLibrary();
+	const PatternLibrary &getPatternLibrary() const { return patternLibrary; }
 	bool loadInitialFromFile(const std::string &path);
+	// Load for inputs too large to hold twice: the file is streamed straight
+	// into the live grid (FileService::streamGridFromFile), the scratch grid
+	// and reset snapshot are dropped, and reset() reloads the file instead.
+	// With opt.backingFile both grids are memory-mapped (<file> and
+	// <file>.next). On failure, including a backing file that cannot be
+	// mapped, the board is left empty.
+	bool streamInitialFromFile(const std::string &path, const GridLoadOptions &opt);
 
 	// Load a hard-coded preset (0-9) stored in code
 	void loadPreset(int slot);
 
+	// Fill the current grid (or a sub-region) with a seeded random soup and
+	// make it the initial state; false if the options are invalid
+	bool loadSoup(const SoupOptions &opt);
+
 	// Iteration control and output
 	void setIterationTarget(int it) { iterationTarget = it; }
 	int getIterationTarget() const { return iterationTarget; }
@@ -60,25 +192,146 @@ public:
 
 	void setTickMs(int ms) { tickMs = ms; }
 
-	// toric behavior control
+	// topology (what edge cells see beyond the board); setToric(true / false) = Torus / Bounded
+	void setTopology(Topology t) { grid.setTopology(t); buffer.setTopology(t); }
+	Topology getTopology() const { return grid.getTopology(); }
 	void setToric(bool t) { grid.setToric(t); buffer.setToric(t); }
 	bool isToric() const { return grid.isToric(); }
+	// false when the topology glues a hexagonal or triangular board into an
+	// invalid tiling (see Neighborhood::fits); such a board still steps, but
+	// the cells along the seams see a shifted neighbourhood
+	bool tilingValid() const { return (rules ? rules->neighborhood() : neighborhood).fits(grid.getR(), grid.getC(), grid.getTopology()); }
 	// obstacle access via service (for SFML interaction)
-	void setObstacle(int r, int c, bool obs) { grid.setObstacle(r, c, obs); buffer.setObstacle(r, c, obs); }
+	void setObstacle(int r, int c, bool obs) { grid.setObstacle(r, c, obs); }
 	bool isObstacle(int r, int c) const { return grid.isObstacle(r, c); }
 
+	// step() instrumentation (phase timers, per-thread work, allocations); off by default
+	void setProfilingEnabled(bool e) { profiler.setEnabled(e); }
+	bool isProfilingEnabled() const { return profiler.isEnabled(); }
+	StepProfiler &getProfiler() { return profiler; }
+	const StepProfiler &getProfiler() const { return profiler; }
+
+	// Complete simulation state, as saved in a checkpoint
+	struct State {
+		Grid grid;
+		std::shared_ptr<const Grid> initialGrid;   // shared copy-on-write snapshot, null = none
+		Topology topology = Topology::Bounded;
+		RuleType ruleType = RuleType::CONWAY;
+		uint16_t birthMask = 1u << 3;
+		uint16_t surviveMask = (1u << 2) | (1u << 3);
+		Neighborhood neighborhood;
+		int currentIteration = 0;
+		int iterationTarget = 0;
+		int saveIterations = 0;
+		int tickMs = 200;
+		std::string outputBase;
+	};
+	State captureState() const;
+	void restoreState(const State &s);
+	void restoreState(State &&s);
+
+	// Periodic checkpointing: every `everyN` iterations step() snapshots the
+	// state and writes it to `path` on a background thread (0 = disabled)
+	void setCheckpoint(const std::string &path, int everyN) { checkpointPath = path; checkpointEvery = everyN; }
+	int getCheckpointEvery() const { return checkpointEvery; }
+	const std::string &getCheckpointPath() const { return checkpointPath; }
+	bool saveCheckpoint(const std::string &path) const;   // synchronous
+	bool resumeFromCheckpoint(const std::string &path);
+	void flushCheckpoints() { checkpointWriter.flush(); }
+
 private:
+	void snapshotInitial() { initialGrid = std::make_shared<const Grid>(grid); initialPath.clear(); }
+	bool bandsPlaced(unsigned bands) const;
+	ThreadPool &numaWorkers();
+	void placeBands(ThreadPool &pool, unsigned bands);
+	void applyEdit(EditCommand &cmd);
+	bool advanceBand(const Tile &band, int k, uint8_t *scratch, uint16_t birth, uint16_t survive);
+	void writeIteration();
+	bool stepStripes(ThreadPool &pool, unsigned nThreads, const Neighborhood &hood, uint16_t birth, uint16_t survive);
+
+	// What a generation needs, resolved by planStep(): kernel, path, thread
+	// count and the caller's row band. step() plans every generation,
+	// advanceUntil() once per run and again only after edits.
+	struct StepPlan {
+		ThreadPool *pool = nullptr;
+		bool prof = false, useKernel = false, stripes = false, numa = false, useTiles = false;
+		uint16_t birth = 0, survive = 0;
+		Neighborhood hood;
+		unsigned nThreads = 1;
+		int lastStart = 0, lastEnd = 0;
+	};
+	void planStep(StepPlan &plan);
+	void spawnGeneration(const StepPlan &plan, TaskGroup &group);
+	bool finishGeneration(const StepPlan &plan, TaskGroup &group);   // true if the board changed
+	void commitGeneration(bool changed);
+	void computeRows(const StepPlan &plan, unsigned int t, int start, int end);
+	void computeTiles(const StepPlan &plan, unsigned int t);
+
 	Grid grid;
+	// scratch grid: next generation in step(), parse target in loadInitialFromFile()
 	Grid buffer;
 	int tickMs = 200;
 	std::atomic<bool> running{false};
+	// the last step()/stepN() found no change
+	bool lastStepStable = false;
 	std::string outputBase;
+	OutputMode outputMode = OutputMode::Text;
+	GenerationArchiveWriter archive;
+	// "Output/<base>" of the open archive, files this run opened, and whether
+	// the run was resumed (existing archives are then appended to)
+	std::string archiveBase;
+	std::vector<std::string> archiveFiles;
+	bool archiveResumed = false;
 	RuleType ruleType = RuleType::CONWAY;
 	std::unique_ptr<GameRules> rules;
+	uint16_t birthMask = 1u << 3;
+	uint16_t surviveMask = (1u << 2) | (1u << 3);
+	Neighborhood neighborhood;
+	// Moore row kernels of the current masks (StepKernel::ruleRow), without / with obstacles
+	StepKernel::RowKernel ruleKernels[2] = {nullptr, nullptr};
+	ThreadPool *threadPool = nullptr;
+	unsigned maxThreads = 0;
+	TileSize tileSize;
+	long long tilingThreshold = 256LL * 256LL;
+	// tile list of the current board, rebuilt when the dimensions or tile size change
+	std::vector<Tile> tiles;
+	int tilesRows = -1, tilesCols = -1;
+	TileSize tilesSize;
+	TileQueue tileQueue;
+	// stepN(): band height, full-width bands, per-slot scratch and per-band change flags
+	int temporalBandRows = 0;
+	std::vector<Tile> temporalBands;
+	std::vector<std::vector<uint8_t>> temporalScratch;
+	std::vector<uint8_t> temporalChanged;
+	// out-of-core stripes: height and per-task change flags
+	int stripeRows = 0;
+	std::vector<uint8_t> stripeChanged;
+	bool numaAware = false;
+	std::unique_ptr<ThreadPool> numaPool;
+	// NUMA placement: band row edges, blocks placed by placeBands()
+	std::vector<int> bandEdges;
+	const uint8_t *placedBlocks[2] = {nullptr, nullptr};
+	int placedCols = -1;
+	// step(): per-task change flags and, when profiling, per-task timings
+	std::vector<uint8_t> taskChanged;
+	std::vector<StepProfiler::clock::time_point> workStart, workEnd;
+	std::vector<uint64_t> workAllocs;
 	int iterationTarget = 0; // 0 = infinite
 	int currentIteration = 0;
-	// Remember initial grid loaded from a file so reset() can restore it
-	Grid initialGrid;
-	bool hasInitial = false;
+	// Remember initial grid loaded from a file so reset() can restore it. Never
+	// modified once taken: captured states and checkpoints share it instead of copying
+	std::shared_ptr<const Grid> initialGrid;
+	// set by streamInitialFromFile(): reset() streams this file again
+	std::string initialPath;
+	GridLoadOptions initialLoad;
 	int saveIterations = 0; // 0 = save none; if >0 save only first N iterations
+	StepProfiler profiler;
+	std::string checkpointPath;
+	int checkpointEvery = 0;
+	MpscQueue<EditCommand> edits;
+	PatternLibrary patternLibrary;
+	FrameExporter frames;
+	int frameEvery = 0;
+	// declared last so pending checkpoint writes finish before anything else is torn down
+	AsyncWriter checkpointWriter;
 };
\ No newline at end of file
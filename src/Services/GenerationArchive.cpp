@@ -0,0 +1,260 @@
+#include "GenerationArchive.h"
+#include "BlockCodec.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static const uint32_t kVersion = 1;
+static const size_t kHeaderSize = 16;
+static const size_t kFrameHeaderSize = 20;
+static const size_t kIndexEntrySize = 24;
+static const size_t kFooterSize = 12;
+
+// --- encoding helpers ---
+static void putU32(std::vector<uint8_t> &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+static void putU64(std::vector<uint8_t> &out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+static void putTag(std::vector<uint8_t> &out, const char *tag) { out.insert(out.end(), tag, tag + 4); }
+
+static uint32_t getU32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+static uint64_t getU64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+// alive plane, then the obstacle plane when `withObstacles`; bit i = cell i in row-major order
+static void packGrid(const Grid &g, bool withObstacles, std::vector<uint8_t> &out) {
+    size_t n = (size_t)g.getR() * (size_t)g.getC();
+    size_t bytes = (n + 7) / 8;
+    out.assign(withObstacles ? 2 * bytes : bytes, 0);
+    const ObstacleMask *obstacles = withObstacles ? g.obstacleMask() : nullptr;
+    size_t i = 0;
+    for (int r = 0; r < g.getR(); ++r) {
+        const uint8_t *row = g.rowPtr(r);
+        const uint8_t *mask = obstacles ? obstacles->row(r) : nullptr;
+        for (int c = 0; c < g.getC(); ++c, ++i) {
+            uint8_t bit = (uint8_t)(1u << (i % 8));
+            if (row[c] & Grid::kAlive) out[i / 8] |= bit;
+            if (mask && mask[c]) out[bytes + i / 8] |= bit;
+        }
+    }
+}
+
+static void unpackGrid(const std::vector<uint8_t> &in, bool withObstacles, Grid &g) {
+    g.clearObstacles();
+    size_t bytes = ((size_t)g.getR() * (size_t)g.getC() + 7) / 8;
+    size_t i = 0;
+    for (int r = 0; r < g.getR(); ++r) {
+        uint8_t *row = g.rowPtr(r);
+        for (int c = 0; c < g.getC(); ++c, ++i) {
+            row[c] = (in[i / 8] >> (i % 8)) & 1u;
+            if (withObstacles && ((in[bytes + i / 8] >> (i % 8)) & 1u)) g.setObstacle(r, c, true);
+        }
+    }
+}
+
+bool GenerationArchiveWriter::open(const std::string &p, int r, int c) {
+    close();
+    if (r <= 0 || c <= 0) return false;
+    try {
+        fs::path fp(p);
+        if (fp.has_parent_path() && !fs::exists(fp.parent_path())) fs::create_directories(fp.parent_path());
+    } catch (...) {
+        return false;
+    }
+    out.open(p, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    path = p;
+    rows = r;
+    cols = c;
+    frames.clear();
+    totalRaw = totalCompressed = 0;
+    std::vector<uint8_t> header;
+    putTag(header, "GOLA");
+    putU32(header, kVersion);
+    putU32(header, (uint32_t)rows);
+    putU32(header, (uint32_t)cols);
+    out.write((const char *)header.data(), (std::streamsize)header.size());
+    offset = header.size();
+    return (bool)out;
+}
+
+bool GenerationArchiveWriter::openAppend(const std::string &p, int r, int c, bool &otherSize) {
+    otherSize = false;
+    close();
+    std::error_code ec;
+    if (!fs::exists(p, ec)) return open(p, r, c);
+    std::vector<ArchiveFrame> kept;
+    {
+        GenerationArchiveReader reader;
+        if (!reader.open(p)) return false;
+        if (reader.getRows() != r || reader.getCols() != c) {
+            otherSize = true;
+            return false;
+        }
+        kept = reader.getFrames();
+    }
+    // drop the old index and footer (or a partly written frame)
+    uint64_t end = kept.empty() ? kHeaderSize : kept.back().offset + kept.back().compressedSize;
+    fs::resize_file(p, end, ec);
+    if (ec) return false;
+    out.open(p, std::ios::binary | std::ios::app);
+    if (!out.is_open()) return false;
+    path = p;
+    rows = r;
+    cols = c;
+    frames = std::move(kept);
+    totalRaw = totalCompressed = 0;
+    for (const ArchiveFrame &f : frames) {
+        totalRaw += f.rawSize;
+        totalCompressed += f.compressedSize;
+    }
+    offset = end;
+    return true;
+}
+
+bool GenerationArchiveWriter::append(int generation, const Grid &g) {
+    if (!out.is_open() || g.getR() != rows || g.getC() != cols) return false;
+    const bool obstacles = g.obstacleMask() != nullptr;
+    packGrid(g, obstacles, packed);
+    BlockCodec::compress(packed.data(), packed.size(), compressed);
+
+    ArchiveFrame f;
+    f.generation = generation;
+    f.rawSize = (uint32_t)packed.size();
+    f.compressedSize = (uint32_t)compressed.size();
+    f.flags = obstacles ? 1u : 0u;
+    f.offset = offset + kFrameHeaderSize;
+    std::vector<uint8_t> header;
+    putTag(header, "GOLF");
+    putU32(header, (uint32_t)f.generation);
+    putU32(header, f.rawSize);
+    putU32(header, f.compressedSize);
+    putU32(header, f.flags);
+    out.write((const char *)header.data(), (std::streamsize)header.size());
+    out.write((const char *)compressed.data(), (std::streamsize)compressed.size());
+    if (!out) return false;
+    offset = f.offset + f.compressedSize;
+    totalRaw += f.rawSize;
+    totalCompressed += f.compressedSize;
+    frames.push_back(f);
+    return true;
+}
+
+bool GenerationArchiveWriter::close() {
+    if (!out.is_open()) return true;
+    std::vector<uint8_t> index;
+    putTag(index, "GOLI");
+    putU32(index, (uint32_t)frames.size());
+    for (const ArchiveFrame &f : frames) {
+        putU32(index, (uint32_t)f.generation);
+        putU64(index, f.offset);
+        putU32(index, f.rawSize);
+        putU32(index, f.compressedSize);
+        putU32(index, f.flags);
+    }
+    putU64(index, offset);
+    putTag(index, "GOLE");
+    out.write((const char *)index.data(), (std::streamsize)index.size());
+    bool ok = (bool)out;
+    out.close();
+    return ok;
+}
+
+bool GenerationArchiveReader::open(const std::string &p) {
+    in.close();
+    in.clear();
+    frames.clear();
+    indexed = false;
+    in.open(p, std::ios::binary);
+    if (!in.is_open()) return false;
+    uint8_t header[kHeaderSize];
+    if (!in.read((char *)header, kHeaderSize) || std::memcmp(header, "GOLA", 4) != 0 || getU32(header + 4) != kVersion) return false;
+    rows = (int)getU32(header + 8);
+    cols = (int)getU32(header + 12);
+    if (rows <= 0 || cols <= 0) return false;
+
+    in.seekg(0, std::ios::end);
+    uint64_t size = (uint64_t)in.tellg();
+    // complete file: footer -> index
+    if (size >= kHeaderSize + kFooterSize) {
+        uint8_t footer[kFooterSize];
+        in.seekg((std::streamoff)(size - kFooterSize));
+        if (in.read((char *)footer, kFooterSize) && std::memcmp(footer + 8, "GOLE", 4) == 0) {
+            uint64_t at = getU64(footer);
+            std::vector<uint8_t> index(size - kFooterSize >= at ? (size_t)(size - kFooterSize - at) : 0);
+            in.seekg((std::streamoff)at);
+            if (index.size() >= 8 && in.read((char *)index.data(), (std::streamsize)index.size())
+                && std::memcmp(index.data(), "GOLI", 4) == 0) {
+                uint32_t count = getU32(index.data() + 4);
+                if (index.size() == 8 + (size_t)count * kIndexEntrySize) {
+                    for (uint32_t i = 0; i < count; ++i) {
+                        const uint8_t *e = index.data() + 8 + (size_t)i * kIndexEntrySize;
+                        ArchiveFrame f;
+                        f.generation = (int32_t)getU32(e);
+                        f.offset = getU64(e + 4);
+                        f.rawSize = getU32(e + 12);
+                        f.compressedSize = getU32(e + 16);
+                        f.flags = getU32(e + 20);
+                        frames.push_back(f);
+                    }
+                    indexed = true;
+                    return true;
+                }
+            }
+        }
+    }
+    // no usable index: walk the frame headers, keeping every complete frame
+    in.clear();
+    uint64_t pos = kHeaderSize;
+    while (pos + kFrameHeaderSize <= size) {
+        uint8_t fh[kFrameHeaderSize];
+        in.seekg((std::streamoff)pos);
+        if (!in.read((char *)fh, kFrameHeaderSize) || std::memcmp(fh, "GOLF", 4) != 0) break;
+        ArchiveFrame f;
+        f.generation = (int32_t)getU32(fh + 4);
+        f.rawSize = getU32(fh + 8);
+        f.compressedSize = getU32(fh + 12);
+        f.flags = getU32(fh + 16);
+        f.offset = pos + kFrameHeaderSize;
+        if (f.offset + f.compressedSize > size) break;
+        frames.push_back(f);
+        pos = f.offset + f.compressedSize;
+    }
+    in.clear();
+    return true;
+}
+
+bool GenerationArchiveReader::readFrame(size_t i, Grid &out) {
+    if (i >= frames.size()) return false;
+    const ArchiveFrame &f = frames[i];
+    size_t planeBytes = ((size_t)rows * (size_t)cols + 7) / 8;
+    bool obstacles = (f.flags & 1u) != 0;
+    if (f.rawSize != (obstacles ? 2 : 1) * planeBytes) return false;
+    compressed.resize(f.compressedSize);
+    in.clear();
+    in.seekg((std::streamoff)f.offset);
+    if (!in.read((char *)compressed.data(), (std::streamsize)compressed.size())) return false;
+    packed.resize(f.rawSize);
+    if (!BlockCodec::decompress(compressed.data(), compressed.size(), packed.data(), packed.size())) return false;
+    out.setGridDimensions(rows, cols);
+    unpackGrid(packed, obstacles, out);
+    return true;
+}
+
+bool GenerationArchiveReader::readGeneration(int generation, Grid &out) {
+    for (size_t i = frames.size(); i-- > 0;) {
+        if (frames[i].generation == generation) return readFrame(i, out);
+    }
+    return false;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Core/Grid.h"
+
+// Single-file container of simulation generations, replacing one text file
+// per generation in Output/. Each generation is bit-packed (1 bit per cell,
+// plus an obstacle plane when the board has obstacles) and compressed on its
+// own with BlockCodec, so any generation can be read back by decompressing
+// just its block.
+//
+// Layout (little-endian):
+//   "GOLA" version rows cols
+//   frames: "GOLF" generation rawSize compressedSize flags, payload
+//   index:  "GOLI" count, then per frame generation offset(u64) sizes flags
+//   footer: indexOffset(u64) "GOLE"
+// A file whose writer never closed it has no index; the reader then rebuilds
+// it by walking the frame headers.
+struct ArchiveFrame {
+    int32_t generation = 0;
+    uint64_t offset = 0;            // payload position in the file
+    uint32_t rawSize = 0;
+    uint32_t compressedSize = 0;
+    uint32_t flags = 0;             // bit 0: obstacle plane present
+};
+
+class GenerationArchiveWriter {
+public:
+    GenerationArchiveWriter() = default;
+    ~GenerationArchiveWriter() { close(); }
+
+    GenerationArchiveWriter(const GenerationArchiveWriter &) = delete;
+    GenerationArchiveWriter &operator=(const GenerationArchiveWriter &) = delete;
+
+    // Create (truncate) `path` for rows x cols generations
+    bool open(const std::string &path, int rows, int cols);
+    // Continue an existing archive: its frames are kept, new ones go after
+    // the last complete frame (the old index is rewritten by close()). A
+    // missing file is created. False with `otherSize` set when the file holds
+    // another board size, false alone when it is not a readable archive.
+    bool openAppend(const std::string &path, int rows, int cols, bool &otherSize);
+    // Append one generation; false if the grid size differs or on I/O error
+    bool append(int generation, const Grid &g);
+    // Write the index and footer; the file is complete afterwards
+    bool close();
+
+    bool isOpen() const { return out.is_open(); }
+    const std::string &getPath() const { return path; }
+    size_t frameCount() const { return frames.size(); }
+    uint64_t rawBytes() const { return totalRaw; }
+    uint64_t compressedBytes() const { return totalCompressed; }
+
+private:
+    std::ofstream out;
+    std::string path;
+    int rows = 0;
+    int cols = 0;
+    uint64_t offset = 0;
+    uint64_t totalRaw = 0;
+    uint64_t totalCompressed = 0;
+    std::vector<ArchiveFrame> frames;
+    // reused between generations
+    std::vector<uint8_t> packed;
+    std::vector<uint8_t> compressed;
+};
+
+class GenerationArchiveReader {
+public:
+    bool open(const std::string &path);
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    const std::vector<ArchiveFrame> &getFrames() const { return frames; }
+    // false when the file had no index (writer interrupted) and it was rebuilt
+    bool hadIndex() const { return indexed; }
+
+    // Decode frame i / the frame holding `generation` into `out` (the last
+    // one written when a resumed run archived that generation again)
+    bool readFrame(size_t i, Grid &out);
+    bool readGeneration(int generation, Grid &out);
+
+private:
+    std::ifstream in;
+    int rows = 0;
+    int cols = 0;
+    bool indexed = false;
+    std::vector<ArchiveFrame> frames;
+    std::vector<uint8_t> packed;
+    std::vector<uint8_t> compressed;
+};
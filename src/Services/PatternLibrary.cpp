@@ -0,0 +1,219 @@
+#include "PatternLibrary.h"
+#include "FileService.h"
+#include "ThreadPool.h"
+#include "../Core/Grid.h"
+#include "../Core/QuadTree.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char *kIndexMagic = "GOLLIB\t1";
+const size_t kParseBatch = 32;
+
+std::string lower(std::string s) {
+    for (char &ch : s) ch = (char)std::tolower((unsigned char)ch);
+    return s;
+}
+
+uint64_t hashFile(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    uint64_t h = 1469598103934665603ull;
+    char buf[1 << 14];
+    while (ifs.read(buf, sizeof buf) || ifs.gcount() > 0) {
+        for (std::streamsize i = 0; i < ifs.gcount(); ++i) {
+            h ^= (uint8_t)buf[i];
+            h *= 1099511628211ull;
+        }
+    }
+    return h;
+}
+
+// fills everything but path, mtime and size
+void parsePattern(PatternInfo &p, Grid &scratch) {
+    p.name = fs::path(p.path).stem().string();
+    p.hash = hashFile(p.path);
+    if (p.format == PatternInfo::Format::Macrocell) {
+        QuadTree tree;
+        p.valid = FileService::readMacrocell(p.path, tree, &p.rule);
+        uint64_t r0 = 0, c0 = 0;
+        if (p.valid && tree.boundingBox(r0, c0, p.rows, p.cols)) p.population = tree.population(tree.root());
+    } else {
+        p.valid = FileService::readGridFromFile(p.path, scratch);
+        if (p.valid) {
+            p.rows = (uint64_t)scratch.getR();
+            p.cols = (uint64_t)scratch.getC();
+            p.population = (uint64_t)scratch.population();
+        }
+    }
+}
+
+// one line per pattern: path mtime size format rows cols population hash valid rule
+void writeEntry(std::ostream &os, const PatternInfo &p) {
+    os << p.path << '\t' << p.mtime << '\t' << p.size << '\t' << (p.format == PatternInfo::Format::Macrocell ? 'm' : 't')
+       << '\t' << p.rows << '\t' << p.cols << '\t' << p.population << '\t' << std::hex << p.hash << std::dec
+       << '\t' << (p.valid ? 1 : 0) << '\t' << p.rule << '\n';
+}
+
+bool readEntry(const std::string &line, PatternInfo &p) {
+    std::vector<std::string> f;
+    size_t start = 0;
+    for (;;) {
+        size_t tab = line.find('\t', start);
+        f.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    if (f.size() != 10 || f[0].empty()) return false;
+    try {
+        p.path = f[0];
+        p.mtime = std::stoll(f[1]);
+        p.size = std::stoull(f[2]);
+        p.format = f[3] == "m" ? PatternInfo::Format::Macrocell : PatternInfo::Format::Text;
+        p.rows = std::stoull(f[4]);
+        p.cols = std::stoull(f[5]);
+        p.population = std::stoull(f[6]);
+        p.hash = std::stoull(f[7], nullptr, 16);
+        p.valid = f[8] == "1";
+        p.rule = f[9];
+    } catch (...) {
+        return false;
+    }
+    p.name = fs::path(p.path).stem().string();
+    return true;
+}
+
+} // namespace
+
+bool PatternLibrary::load(const std::string &root, const std::string &indexPath, ThreadPool &pool) {
+    auto t0 = std::chrono::steady_clock::now();
+    stats = ScanStats();
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) return false;
+
+    // 1. walk the tree: one task per directory, sub-directories fan out
+    std::vector<PatternInfo> found;
+    {
+        std::mutex foundMtx;
+        TaskGroup group(pool);
+        std::function<void(fs::path)> scanDir = [&](fs::path dir) {
+            std::vector<PatternInfo> local;
+            std::error_code err;
+            for (fs::directory_iterator it(dir, err), end; !err && it != end; it.increment(err)) {
+                const fs::directory_entry &e = *it;
+                std::error_code statErr;
+                if (e.is_directory(statErr)) {
+                    fs::path sub = e.path();
+                    group.run([&scanDir, sub]() { scanDir(sub); });
+                    continue;
+                }
+                std::string ext = e.path().extension().string();
+                if (ext != ".txt" && ext != ".mc") continue;
+                if (!e.is_regular_file(statErr)) continue;
+                PatternInfo p;
+                p.path = e.path().string();
+                p.format = ext == ".mc" ? PatternInfo::Format::Macrocell : PatternInfo::Format::Text;
+                p.size = (uint64_t)e.file_size(statErr);
+                p.mtime = (int64_t)e.last_write_time(statErr).time_since_epoch().count();
+                if (!statErr) local.push_back(std::move(p));
+            }
+            std::lock_guard<std::mutex> lock(foundMtx);
+            for (auto &p : local) found.push_back(std::move(p));
+        };
+        group.run([&scanDir, root]() { scanDir(fs::path(root)); });
+        group.wait();
+    }
+    stats.files = found.size();
+
+    // 2. reuse what the index file already knows
+    std::unordered_map<std::string, PatternInfo> cached;
+    {
+        std::ifstream ifs(indexPath);
+        std::string line;
+        if (std::getline(ifs, line) && line == kIndexMagic) {
+            while (std::getline(ifs, line)) {
+                PatternInfo p;
+                if (readEntry(line, p)) cached.emplace(p.path, std::move(p));
+            }
+        }
+    }
+    std::vector<size_t> stale;
+    for (size_t i = 0; i < found.size(); ++i) {
+        auto it = cached.find(found[i].path);
+        if (it != cached.end() && it->second.mtime == found[i].mtime && it->second.size == found[i].size) {
+            found[i] = std::move(it->second);
+            ++stats.reused;
+        } else {
+            stale.push_back(i);
+        }
+    }
+
+    // 3. parse new and modified files in batches on the pool
+    {
+        TaskGroup group(pool);
+        for (size_t b = 0; b < stale.size(); b += kParseBatch) {
+            group.run([&found, &stale, b]() {
+                Grid scratch(0, 0);
+                size_t end = std::min(stale.size(), b + kParseBatch);
+                for (size_t i = b; i < end; ++i) parsePattern(found[stale[i]], scratch);
+            });
+        }
+        group.wait();
+    }
+    stats.parsed = stale.size();
+
+    std::sort(found.begin(), found.end(), [](const PatternInfo &a, const PatternInfo &b) {
+        return a.name != b.name ? a.name < b.name : a.path < b.path;
+    });
+    entries = std::move(found);
+
+    // 4. rewrite the index when a file was added, changed or removed
+    if (stats.parsed > 0 || cached.size() != stats.reused) {
+        try {
+            fs::path target(indexPath);
+            if (target.has_parent_path()) fs::create_directories(target.parent_path());
+            fs::path tmp = target;
+            tmp += ".tmp";
+            {
+                std::ofstream ofs(tmp, std::ios::trunc);
+                ofs << kIndexMagic << '\n';
+                for (const PatternInfo &p : entries) writeEntry(ofs, p);
+            }
+            fs::rename(tmp, target);
+        } catch (...) {}
+    }
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+std::vector<const PatternInfo *> PatternLibrary::find(const PatternQuery &q) const {
+    std::vector<const PatternInfo *> out;
+    const std::string name = lower(q.name);
+    const std::string rule = lower(q.rule);
+    for (const PatternInfo &p : entries) {
+        if (!p.valid && !q.includeInvalid) continue;
+        if (q.maxRows && p.rows > q.maxRows) continue;
+        if (q.maxCols && p.cols > q.maxCols) continue;
+        if (p.population < q.minPopulation) continue;
+        if (q.maxPopulation && p.population > q.maxPopulation) continue;
+        if (!rule.empty() && lower(p.rule) != rule) continue;
+        if (!name.empty() && lower(p.name).find(name) == std::string::npos) continue;
+        out.push_back(&p);
+    }
+    return out;
+}
+
+const PatternInfo *PatternLibrary::findByName(const std::string &name) const {
+    auto it = std::lower_bound(entries.begin(), entries.end(), name,
+                               [](const PatternInfo &p, const std::string &n) { return p.name < n; });
+    return it != entries.end() && it->name == name ? &*it : nullptr;
+}
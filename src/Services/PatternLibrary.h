@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Metadata of one pattern file of the library
+struct PatternInfo {
+    enum class Format : uint8_t { Text, Macrocell };
+
+    std::string path;           // as found under the library root
+    std::string name;           // file name without extension
+    Format format = Format::Text;
+    uint64_t rows = 0;          // text: declared size; macrocell: live bounding box
+    uint64_t cols = 0;
+    uint64_t population = 0;
+    std::string rule;           // macrocell #R line; empty for text files
+    uint64_t hash = 0;          // FNV-1a of the file bytes (spots duplicates)
+    int64_t mtime = 0;          // last write time and size invalidate the cached entry
+    uint64_t size = 0;
+    bool valid = true;          // false when the file could not be parsed
+};
+
+// Filters of PatternLibrary::find; every set field must match
+struct PatternQuery {
+    std::string name;           // case-insensitive substring of the name ("" = any)
+    uint64_t maxRows = 0;       // 0 = no limit
+    uint64_t maxCols = 0;
+    uint64_t minPopulation = 0;
+    uint64_t maxPopulation = 0; // 0 = no limit
+    std::string rule;           // case-insensitive exact match ("" = any)
+    bool includeInvalid = false;
+};
+
+// Index of a pattern directory tree (.txt and .mc files), cached on disk.
+// load() walks the tree in parallel; entries of the index file whose size and
+// modification time still match are reused without opening the pattern, so
+// a warm start costs one stat per file. New or changed files are parsed on
+// the pool, and the index is rewritten only when something changed.
+class PatternLibrary {
+public:
+    struct ScanStats {
+        size_t files = 0;       // pattern files found
+        size_t reused = 0;      // taken from the index file
+        size_t parsed = 0;      // new or changed, read from disk
+        double elapsedMs = 0.0;
+    };
+
+    // false if `root` is not a directory; an unreadable or stale index is rebuilt
+    bool load(const std::string &root, const std::string &indexPath, ThreadPool &pool);
+
+    // sorted by name, then path
+    const std::vector<PatternInfo> &patterns() const { return entries; }
+    std::vector<const PatternInfo *> find(const PatternQuery &q) const;
+    // first pattern with exactly this name (binary search), null if none
+    const PatternInfo *findByName(const std::string &name) const;
+    const ScanStats &lastScan() const { return stats; }
+
+private:
+    std::vector<PatternInfo> entries;
+    ScanStats stats;
+};
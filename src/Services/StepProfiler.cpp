@@ -0,0 +1,204 @@
+#include "StepProfiler.h"
+#include "../Core/Cell.h"
+#include "../Core/GridArena.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+static int64_t toNs(StepProfiler::clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+static bool writeText(const std::string &path, const std::string &text) {
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open()) return false;
+    ofs << text;
+    return static_cast<bool>(ofs);
+}
+
+const char *StepProfiler::phaseName(Phase p) {
+    switch (p) {
+        case Phase::Spawn: return "spawn";
+        case Phase::Compute: return "compute";
+        case Phase::Equals: return "equals";
+        case Phase::CopyBack: return "copy_back";
+        case Phase::Write: return "write";
+        default: return "unknown";
+    }
+}
+
+StepProfiler::StepProfiler() : epoch(clock::now()) {}
+
+StepProfiler::~StepProfiler() { setEnabled(false); }
+
+void StepProfiler::setEnabled(bool e) {
+    if (e == enabled) return;
+    enabled = e;
+    Cell::countAllocations(e);
+    GridArena::countAllocations(e);
+}
+
+void StepProfiler::reset() {
+    std::lock_guard<std::mutex> lk(mtx);
+    epoch = clock::now();
+    iteration = 0;
+    steps = 0;
+    phases.fill(PhaseStats{});
+    threads.clear();
+    cellAllocs = 0;
+    gridAllocs = 0;
+    trace.clear();
+    dropped = 0;
+}
+
+void StepProfiler::beginStep(int it) {
+    std::lock_guard<std::mutex> lk(mtx);
+    iteration = it;
+    ++steps;
+}
+
+void StepProfiler::recordLocked(Phase ph, int tid, clock::time_point start, clock::time_point end) {
+    int64_t ns = toNs(end - start);
+    if (tid == 0) {
+        PhaseStats &s = phases[static_cast<size_t>(ph)];
+        if (s.calls == 0 || ns < s.minNs) s.minNs = ns;
+        if (ns > s.maxNs) s.maxNs = ns;
+        s.totalNs += ns;
+        ++s.calls;
+    }
+    if (trace.size() < traceCapacity) trace.push_back(TraceEvent{ph, tid, iteration, toNs(start - epoch), ns});
+    else ++dropped;
+}
+
+void StepProfiler::record(Phase ph, int tid, clock::time_point start, clock::time_point end) {
+    std::lock_guard<std::mutex> lk(mtx);
+    recordLocked(ph, tid, start, end);
+}
+
+void StepProfiler::recordThreadWork(int tid, clock::time_point start, clock::time_point end, uint64_t allocs) {
+    std::lock_guard<std::mutex> lk(mtx);
+    if ((size_t)tid >= threads.size()) threads.resize(tid + 1);
+    ThreadStats &t = threads[tid];
+    ++t.tasks;
+    t.workNs += toNs(end - start);
+    t.cellAllocs += allocs;
+    cellAllocs += allocs;
+    recordLocked(Phase::Compute, tid + 1, start, end);
+}
+
+void StepProfiler::recordCellAllocations(uint64_t n) {
+    std::lock_guard<std::mutex> lk(mtx);
+    cellAllocs += n;
+}
+
+void StepProfiler::recordGridAllocations(uint64_t matrices) {
+    std::lock_guard<std::mutex> lk(mtx);
+    gridAllocs += matrices;
+}
+
+uint64_t StepProfiler::getStepCount() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return steps;
+}
+
+StepProfiler::PhaseStats StepProfiler::getPhaseStats(Phase ph) const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return phases[static_cast<size_t>(ph)];
+}
+
+std::vector<StepProfiler::ThreadStats> StepProfiler::getThreadStats() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return threads;
+}
+
+uint64_t StepProfiler::getCellAllocations() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return cellAllocs;
+}
+
+uint64_t StepProfiler::getGridAllocations() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return gridAllocs;
+}
+
+std::vector<StepProfiler::TraceEvent> StepProfiler::getTraceEvents() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return trace;
+}
+
+size_t StepProfiler::getDroppedEvents() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    return dropped;
+}
+
+std::string StepProfiler::toJson() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    std::ostringstream os;
+    os << "{\n  \"steps\": " << steps << ",\n  \"phases\": [\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseStats &s = phases[i];
+        int64_t mean = s.calls ? s.totalNs / (int64_t)s.calls : 0;
+        os << "    {\"name\": \"" << phaseName(static_cast<Phase>(i)) << "\", \"calls\": " << s.calls
+           << ", \"total_ns\": " << s.totalNs << ", \"mean_ns\": " << mean
+           << ", \"min_ns\": " << s.minNs << ", \"max_ns\": " << s.maxNs << "}"
+           << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    os << "  ],\n  \"threads\": [\n";
+    for (size_t i = 0; i < threads.size(); ++i) {
+        const ThreadStats &t = threads[i];
+        os << "    {\"thread\": " << i << ", \"tasks\": " << t.tasks << ", \"work_ns\": " << t.workNs
+           << ", \"cell_allocs\": " << t.cellAllocs << "}" << (i + 1 < threads.size() ? ",\n" : "\n");
+    }
+    os << "  ],\n  \"allocations\": {\"cells\": " << cellAllocs << ", \"grids\": " << gridAllocs << "},\n";
+    os << "  \"dropped_events\": " << dropped << "\n}\n";
+    return os.str();
+}
+
+std::string StepProfiler::toCsv() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    std::ostringstream os;
+    os << "kind,name,calls,total_ns,mean_ns,min_ns,max_ns\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseStats &s = phases[i];
+        int64_t mean = s.calls ? s.totalNs / (int64_t)s.calls : 0;
+        os << "phase," << phaseName(static_cast<Phase>(i)) << ',' << s.calls << ',' << s.totalNs << ','
+           << mean << ',' << s.minNs << ',' << s.maxNs << '\n';
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        const ThreadStats &t = threads[i];
+        int64_t mean = t.tasks ? t.workNs / (int64_t)t.tasks : 0;
+        os << "thread," << i << ',' << t.tasks << ',' << t.workNs << ',' << mean << ",,\n";
+    }
+    os << "alloc,cells," << cellAllocs << ",,,,\n";
+    os << "alloc,grids," << gridAllocs << ",,,,\n";
+    return os.str();
+}
+
+std::string StepProfiler::toChromeTrace() const {
+    std::lock_guard<std::mutex> lk(mtx);
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3);
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    const char *sep = "\n";
+    // name the tracks so workers show up as separate rows
+    int maxTid = 0;
+    for (const auto &e : trace) maxTid = std::max(maxTid, e.tid);
+    for (int t = 0; t <= maxTid; ++t) {
+        os << sep << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << t
+           << ", \"args\": {\"name\": \"" << (t == 0 ? std::string("simulation") : "worker " + std::to_string(t - 1)) << "\"}}";
+        sep = ",\n";
+    }
+    for (const TraceEvent &e : trace) {
+        // trace-event timestamps are microseconds (fractional values allowed)
+        os << sep << "{\"name\": \"" << phaseName(e.phase) << "\", \"cat\": \"step\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.tid
+           << ", \"ts\": " << (double)e.startNs / 1000.0 << ", \"dur\": " << (double)e.durNs / 1000.0
+           << ", \"args\": {\"iteration\": " << e.iteration << "}}";
+    }
+    os << "\n]}\n";
+    return os.str();
+}
+
+bool StepProfiler::writeJson(const std::string &path) const { return writeText(path, toJson()); }
+bool StepProfiler::writeCsv(const std::string &path) const { return writeText(path, toCsv()); }
+bool StepProfiler::writeChromeTrace(const std::string &path) const { return writeText(path, toChromeTrace()); }
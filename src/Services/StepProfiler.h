@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Low-overhead instrumentation for GameService::step.
+// Disabled by default: every probe first checks isEnabled(), so a disabled
+// profiler costs one predictable branch per phase and records nothing.
+class StepProfiler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Phases of one generation, in the order step() runs them
+    enum class Phase { Spawn, Compute, Equals, CopyBack, Write, Count };
+    static const char *phaseName(Phase p);
+
+    struct PhaseStats {
+        uint64_t calls = 0;
+        int64_t totalNs = 0;
+        int64_t minNs = 0;
+        int64_t maxNs = 0;
+    };
+
+    struct ThreadStats {
+        uint64_t tasks = 0;   // number of work units run by this worker slot
+        int64_t workNs = 0;   // time spent evaluating rules
+        uint64_t cellAllocs = 0;
+    };
+
+    // one complete event for the chrome://tracing export
+    struct TraceEvent {
+        Phase phase;
+        int tid;              // 0 = simulation thread, 1.. = workers
+        int iteration;
+        int64_t startNs;      // relative to the profiler epoch
+        int64_t durNs;
+    };
+
+    // RAII phase timer; a default constructed scope is inert
+    class Scope {
+    public:
+        Scope() = default;
+        Scope(StepProfiler *p, Phase ph) : prof(p), phase(ph), start(clock::now()) {}
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope() { if (prof) prof->record(phase, 0, start, clock::now()); }
+    private:
+        StepProfiler *prof = nullptr;
+        Phase phase = Phase::Spawn;
+        clock::time_point start;
+    };
+
+    StepProfiler();
+    ~StepProfiler();
+
+    // while enabled, the Cell and GridArena allocation counters run
+    void setEnabled(bool e);
+    bool isEnabled() const { return enabled; }
+    void reset();
+
+    // max number of trace events kept (older runs are not overwritten, newer ones are dropped)
+    void setTraceCapacity(size_t n) { traceCapacity = n; }
+
+    Scope scope(Phase ph) { return enabled ? Scope(this, ph) : Scope(); }
+    void beginStep(int iteration);
+    void record(Phase ph, int tid, clock::time_point start, clock::time_point end);
+    void recordThreadWork(int tid, clock::time_point start, clock::time_point end, uint64_t cellAllocs);
+    void recordCellAllocations(uint64_t n);   // allocations made on the simulation thread
+    void recordGridAllocations(uint64_t matrices);
+
+    // Queries
+    uint64_t getStepCount() const;
+    PhaseStats getPhaseStats(Phase ph) const;
+    std::vector<ThreadStats> getThreadStats() const;
+    uint64_t getCellAllocations() const;
+    uint64_t getGridAllocations() const;
+    std::vector<TraceEvent> getTraceEvents() const;
+    size_t getDroppedEvents() const;
+
+    // Export
+    std::string toJson() const;
+    std::string toCsv() const;
+    std::string toChromeTrace() const;
+    bool writeJson(const std::string &path) const;
+    bool writeCsv(const std::string &path) const;
+    bool writeChromeTrace(const std::string &path) const;
+
+private:
+    void recordLocked(Phase ph, int tid, clock::time_point start, clock::time_point end);
+
+    bool enabled = false;
+    mutable std::mutex mtx;
+    clock::time_point epoch;
+    int iteration = 0;
+    uint64_t steps = 0;
+    std::array<PhaseStats, static_cast<size_t>(Phase::Count)> phases{};
+    std::vector<ThreadStats> threads;
+    uint64_t cellAllocs = 0;
+    uint64_t gridAllocs = 0;
+    std::vector<TraceEvent> trace;
+    size_t traceCapacity = 1u << 20;
+    size_t dropped = 0;
+};
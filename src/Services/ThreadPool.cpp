@@ -0,0 +1,261 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static thread_local int tlWorkerIndex = -1;
+static thread_local const ThreadPool *tlPool = nullptr;
+
+ThreadPool::ThreadPool(unsigned n) {
+    if (n == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        n = hw == 0 ? 2u : hw;
+    }
+    for (unsigned i = 0; i < n; ++i) queues.push_back(std::make_unique<Queue>());
+    threads.reserve(n);
+    for (unsigned i = 0; i < n; ++i) threads.emplace_back([this, i]() { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(sleepMtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t : threads) if (t.joinable()) t.join();
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+int ThreadPool::currentWorkerIndex() { return tlWorkerIndex; }
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned target;
+    if (tlPool == this && tlWorkerIndex >= 0) target = (unsigned)tlWorkerIndex;
+    else target = nextQueue.fetch_add(1, std::memory_order_relaxed) % (unsigned)queues.size();
+    {
+        std::lock_guard<std::mutex> lk(queues[target]->m);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // increment under the sleep mutex so a worker cannot miss the wake-up
+        std::lock_guard<std::mutex> lk(sleepMtx);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::submitTo(unsigned index, std::function<void()> task) {
+    Queue &q = *queues[index % (unsigned)queues.size()];
+    {
+        std::lock_guard<std::mutex> lk(q.m);
+        q.affine.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lk(sleepMtx);
+        q.affineCount.fetch_add(1, std::memory_order_release);
+    }
+    // one condition variable for all workers: wake them all, only the owner finds work
+    wake.notify_all();
+}
+
+bool ThreadPool::popAffine(unsigned index, std::function<void()> &out) {
+    Queue &q = *queues[index];
+    if (q.affineCount.load(std::memory_order_acquire) == 0) return false;
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.affine.empty()) return false;
+    out = std::move(q.affine.front());
+    q.affine.pop_front();
+    q.affineCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+std::vector<int> ThreadPool::parseCpuList(const std::string &list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        std::string range = list.substr(pos, end - pos);
+        pos = end + 1;
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int c = first; c <= last; ++c) cpus.push_back(c);
+        } catch (const std::exception &) {
+            // blank or malformed entry (e.g. the trailing newline): skipped
+        }
+    }
+    return cpus;
+}
+
+#ifdef __linux__
+// CPUs of the affinity set, grouped by NUMA node in node order; CPUs no node
+// lists (or every CPU, without sysfs) come last
+static std::vector<int> nodeOrderedCpus() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return {};
+    std::vector<std::pair<int, std::string>> nodes;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() < 5 || name.compare(0, 4, "node") != 0 || name.find_first_not_of("0123456789", 4) != std::string::npos) continue;
+        nodes.emplace_back(std::stoi(name.substr(4)), (entry.path() / "cpulist").string());
+    }
+    std::sort(nodes.begin(), nodes.end());
+    std::vector<int> cpus;
+    std::vector<bool> listed(CPU_SETSIZE, false);
+    for (const auto &node : nodes) {
+        std::ifstream in(node.second);
+        std::string list;
+        std::getline(in, list);
+        for (int c : ThreadPool::parseCpuList(list)) {
+            if (c < 0 || c >= CPU_SETSIZE || listed[(size_t)c] || !CPU_ISSET(c, &allowed)) continue;
+            listed[(size_t)c] = true;
+            cpus.push_back(c);
+        }
+    }
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &allowed) && !listed[(size_t)c]) cpus.push_back(c);
+    }
+    return cpus;
+}
+#endif
+
+bool ThreadPool::pinWorkers() {
+    // a failed attempt is not repeated every generation
+    if (pinTried) return pinned;
+    pinTried = true;
+#ifdef __linux__
+    std::vector<int> cpus = nodeOrderedCpus();
+    if (cpus.empty() || threads.empty()) return false;
+    bool ok = true;
+    for (unsigned i = 0; i < threads.size(); ++i) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[(size_t)i * cpus.size() / threads.size()], &set);
+        ok &= pthread_setaffinity_np(threads[i].native_handle(), sizeof(set), &set) == 0;
+    }
+    pinned = ok;
+    return ok;
+#else
+    return false;
+#endif
+}
+
+bool ThreadPool::popOwn(unsigned index, std::function<void()> &out) {
+    Queue &q = *queues[index];
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.tasks.empty()) return false;
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief, std::function<void()> &out) {
+    unsigned n = (unsigned)queues.size();
+    for (unsigned k = 1; k <= n; ++k) {
+        Queue &q = *queues[(thief + k) % n];
+        std::lock_guard<std::mutex> lk(q.m);
+        if (q.tasks.empty()) continue;
+        out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    bool own = tlPool == this && tlWorkerIndex >= 0;
+    if (queued.load(std::memory_order_acquire) == 0 &&
+        !(own && queues[(unsigned)tlWorkerIndex]->affineCount.load(std::memory_order_acquire) > 0)) return false;
+    std::function<void()> task;
+    unsigned self = own ? (unsigned)tlWorkerIndex : 0;
+    if (own && popAffine(self, task)) {
+        task();
+        return true;
+    }
+    if (!(own && popOwn(self, task)) && !steal(self, task)) return false;
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    tlWorkerIndex = (int)index;
+    tlPool = this;
+    Queue &own = *queues[index];
+    for (;;) {
+        std::function<void()> task;
+        if (popAffine(index, task)) {
+            task();
+            continue;
+        }
+        if (popOwn(index, task) || steal(index, task)) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(sleepMtx);
+        wake.wait(lk, [this, &own]() {
+            return stopping || queued.load(std::memory_order_acquire) > 0 || own.affineCount.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && queued.load(std::memory_order_acquire) == 0 && own.affineCount.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    // never leave tasks referencing this group behind
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!pool.runPendingTask()) std::this_thread::yield();
+    }
+}
+
+std::function<void()> TaskGroup::wrap(std::function<void()> task) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    return [this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(errMtx);
+            if (!error) error = std::current_exception();
+        }
+        pending.fetch_sub(1, std::memory_order_release);
+    };
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    pool.submit(wrap(std::move(task)));
+}
+
+void TaskGroup::runOn(unsigned worker, std::function<void()> task) {
+    pool.submitTo(worker, wrap(std::move(task)));
+}
+
+void TaskGroup::wait() {
+    int idle = 0;
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (pool.runPendingTask()) { idle = 0; continue; }
+        // nothing to help with: back off gently while other workers finish
+        if (++idle < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    std::exception_ptr e;
+    {
+        std::lock_guard<std::mutex> lk(errMtx);
+        e = error;
+        error = nullptr;
+    }
+    if (e) std::rethrow_exception(e);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Persistent work-stealing thread pool.
+// Every worker owns a deque: it pushes and pops its own tasks at the back and
+// steals from the front of the other workers' deques when it runs dry. Threads
+// are created once, so stepping a simulation no longer spawns threads.
+class ThreadPool {
+public:
+    // 0 = one worker per hardware thread
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return (unsigned)threads.size(); }
+
+    // Queue a task. From a worker of this pool it goes to that worker's own
+    // deque (good locality for nested work), otherwise round-robin.
+    void submit(std::function<void()> task);
+
+    // Queue a task that only worker `index` may run (never stolen), e.g. to
+    // keep a row band on the core that first touched its memory.
+    void submitTo(unsigned index, std::function<void()> task);
+
+    // Pin every worker to one CPU the process may run on (sched_getaffinity),
+    // taken node by node from /sys/devices/system/node: consecutive workers,
+    // hence neighbouring row bands, share a NUMA node. Workers are spread
+    // evenly over the CPUs. Only the first call tries; false when pinning
+    // failed or the platform does not support it (only implemented on Linux).
+    bool pinWorkers();
+    bool workersPinned() const { return pinned; }
+    bool pinAttempted() const { return pinTried; }
+
+    // CPUs of a kernel cpulist such as "0-3,8,10-11" (sysfs format), in order
+    static std::vector<int> parseCpuList(const std::string &list);
+
+    // Run one queued task on the calling thread; false if nothing was found.
+    // Lets a thread that waits for sub-tasks help instead of blocking.
+    bool runPendingTask();
+
+    // index of the calling worker in its pool, -1 for non-pool threads
+    static int currentWorkerIndex();
+
+    // process-wide pool sized to the machine
+    static ThreadPool &shared();
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+        std::deque<std::function<void()>> affine;     // submitTo(): owner only
+        std::atomic<size_t> affineCount{0};
+    };
+
+    void workerLoop(unsigned index);
+    bool popOwn(unsigned index, std::function<void()> &out);
+    bool popAffine(unsigned index, std::function<void()> &out);
+    bool steal(unsigned thief, std::function<void()> &out);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};            // stealable tasks only
+    std::atomic<unsigned> nextQueue{0};
+    std::mutex sleepMtx;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool pinned = false;
+    bool pinTried = false;
+};
+
+// Fork/join helper: run() tasks on a pool, wait() until all of them finished.
+// wait() executes queued tasks while it waits, so groups can be nested inside
+// pool tasks without deadlocking. The first exception thrown by a task is
+// rethrown by wait().
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool &p) : pool(p) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(std::function<void()> task);
+    // run on a given worker of the pool (ThreadPool::submitTo)
+    void runOn(unsigned worker, std::function<void()> task);
+    void wait();
+
+private:
+    std::function<void()> wrap(std::function<void()> task);
+
+    ThreadPool &pool;
+    std::atomic<int> pending{0};
+    std::mutex errMtx;
+    std::exception_ptr error;
+};
@@ -0,0 +1,110 @@
+#include "TileQueue.h"
+#include "../Core/Grid.h"
+#include "../Core/SoupGenerator.h"
+#include "../Core/StepKernel.h"
+#include "../Core/GameRules.h"
+
+#include <algorithm>
+#include <chrono>
+
+void TileQueue::reset(int tileCount, unsigned workers) {
+    if (workers == 0) workers = 1;
+    if (workers > slotCapacity) {
+        slots.reset(new Slot[workers]);
+        slotCapacity = workers;
+    }
+    slotCount = workers;
+    int chunk = tileCount / (int)workers;
+    int rem = tileCount % (int)workers;
+    int start = 0;
+    for (unsigned w = 0; w < workers; ++w) {
+        int end = start + chunk + ((int)w < rem ? 1 : 0);
+        std::lock_guard<std::mutex> lk(slots[w].m);
+        slots[w].begin = start;
+        slots[w].end = end;
+        start = end;
+    }
+    stealCount.store(0, std::memory_order_relaxed);
+}
+
+int TileQueue::next(unsigned worker) {
+    Slot &own = slots[worker];
+    {
+        std::lock_guard<std::mutex> lk(own.m);
+        if (own.begin < own.end) return own.begin++;
+    }
+    for (unsigned k = 1; k < slotCount; ++k) {
+        Slot &victim = slots[(worker + k) % slotCount];
+        int from = 0, to = 0;
+        {
+            std::lock_guard<std::mutex> lk(victim.m);
+            int remaining = victim.end - victim.begin;
+            if (remaining <= 0) continue;
+            // take the half furthest from where the victim is working
+            from = victim.end - (remaining + 1) / 2;
+            to = victim.end;
+            victim.end = from;
+        }
+        stealCount.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lk(own.m);
+        own.begin = from + 1;
+        own.end = to;
+        return from;
+    }
+    return -1;
+}
+
+void TileQueue::buildTiles(int rows, int cols, TileSize size, std::vector<Tile> &out) {
+    out.clear();
+    int th = size.rows > 0 ? size.rows : rows;
+    int tw = size.cols > 0 ? size.cols : cols;
+    for (int r = 0; r < rows; r += th) {
+        for (int c = 0; c < cols; c += tw) {
+            out.push_back(Tile{r, std::min(r + th, rows), c, std::min(c + tw, cols)});
+        }
+    }
+}
+
+TileSize TileTuner::tune(int rows, int cols) {
+    Grid src(rows, cols), dst(rows, cols);
+    SoupOptions soup;
+    soup.seed = 0x5eed;
+    soup.density = 0.35;
+    SoupGenerator::fill(src, soup);
+    src.refreshHalo();
+
+    // cols = 0 means full-width rows (the untiled traversal)
+    static const TileSize candidates[] = {
+        {16, 128}, {16, 512}, {16, 2048}, {64, 128}, {64, 512}, {64, 2048}, {32, 0}, {128, 0},
+    };
+    std::vector<Tile> tiles;
+    TileSize best = candidates[0];
+    double bestTime = 0.0;
+    for (const TileSize &cand : candidates) {
+        TileQueue::buildTiles(rows, cols, cand, tiles);
+        double fastest = 0.0;
+        for (int rep = 0; rep < 2; ++rep) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (const Tile &t : tiles) {
+                for (int r = t.r0; r < t.r1; ++r) {
+                    StepKernel::lifeRow(src.rowPtr(r - 1) + t.c0, src.rowPtr(r) + t.c0, src.rowPtr(r + 1) + t.c0,
+                                        dst.rowPtr(r) + t.c0, t.c1 - t.c0,
+                                        LifeLikeRules::kConwayBirth, LifeLikeRules::kConwaySurvive);
+                }
+            }
+            double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            if (rep == 0 || dt < fastest) fastest = dt;
+        }
+        if (bestTime == 0.0 || fastest < bestTime) {
+            bestTime = fastest;
+            best = cand;
+        }
+    }
+    return best;
+}
+
+TileSize TileTuner::tuned() {
+    // wider than L2 so row reuse matters, small enough to tune in a few tens of ms
+    static const TileSize size = tune(128, 4096);
+    return size;
+}
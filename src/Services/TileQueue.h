@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Rectangle of cells [r0, r1) x [c0, c1) processed as one unit of work
+struct Tile {
+    int r0, r1, c0, c1;
+};
+
+struct TileSize {
+    int rows = 0;
+    int cols = 0;
+};
+
+// Work-stealing queue of tile indices for one generation.
+// reset() hands every worker a contiguous range of the (row-major) tile list,
+// so each worker walks its own band and keeps neighbour rows in cache. A
+// worker that runs out steals the upper half of another worker's remaining
+// range, which balances boards whose activity is concentrated in one area.
+// Slots are reused between generations: steady-state stepping does not allocate.
+class TileQueue {
+public:
+    void reset(int tileCount, unsigned workers);
+
+    // Next tile index for `worker`, or -1 when every tile has been handed out
+    int next(unsigned worker);
+
+    // Ranges taken from another worker since the last reset
+    uint64_t steals() const { return stealCount.load(std::memory_order_relaxed); }
+
+    // Row-major tiling of a rows x cols board; `out` keeps its capacity
+    static void buildTiles(int rows, int cols, TileSize size, std::vector<Tile> &out);
+
+private:
+    struct alignas(64) Slot {
+        std::mutex m;
+        int begin = 0;
+        int end = 0;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    unsigned slotCount = 0;
+    unsigned slotCapacity = 0;
+    std::atomic<uint64_t> stealCount{0};
+};
+
+// Picks the tile size for the life-like kernel by timing a few candidates on a
+// synthetic board once per process (first call), then returns the cached winner.
+class TileTuner {
+public:
+    static TileSize tuned();
+    // Measure the candidates now on a rows x cols random board (used by tuned())
+    static TileSize tune(int rows, int cols);
+};
@@ -36,11 +36,31 @@ void ConsoleUI::run() {
 		std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 	}
 
-	// At startup, check Input folder for .txt files and allow the user to pick one
-	auto files = service.listInputFiles();
+	// At startup, look up the pattern library (Input/ and its sub-folders) and allow the user to pick one
+	std::vector<const PatternInfo *> files;
+	if (service.refreshPatternLibrary()) files = service.getPatternLibrary().find(PatternQuery());
 	if (!files.empty()) {
+		const size_t kShown = 40;
+		// large libraries are narrowed down by name first
+		if (files.size() > kShown) {
+			std::cout << files.size() << " patterns in Input/. Search by name (empty = list all): ";
+			std::string filter;
+			std::getline(std::cin, filter);
+			if (!filter.empty()) {
+				PatternQuery q;
+				q.name = filter;
+				auto matches = service.getPatternLibrary().find(q);
+				if (!matches.empty()) files = std::move(matches);
+				else std::cout << "No pattern matches \"" << filter << "\", listing all.\n";
+			}
+		}
 		std::cout << "Found input files:\n";
-		for (size_t i = 0; i < files.size(); ++i) std::cout << "  " << (i+1) << ") " << files[i] << "\n";
+		for (size_t i = 0; i < files.size(); ++i) {
+			const PatternInfo &p = *files[i];
+			std::cout << "  " << (i+1) << ") " << p.path << "  (" << p.rows << "x" << p.cols << ", " << p.population << " cells";
+			if (!p.rule.empty()) std::cout << ", " << p.rule;
+			std::cout << ")\n";
+		}
 		std::cout << "Choose a file by number (0 = skip): ";
 		int choice = -1;
 		while (!(std::cin >> choice) || choice < 0 || choice > (int)files.size()) {
@@ -49,8 +69,8 @@ void ConsoleUI::run() {
 		}
 		std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 		if (choice > 0) {
-			if (service.loadInitialFromFile(files[choice-1])) {
-				std::cout << "Loaded " << files[choice-1] << "\n";
+			if (service.loadInitialFromFile(files[choice-1]->path)) {
+				std::cout << "Loaded " << files[choice-1]->path << "\n";
 			} else {
 				std::cout << "Failed to load file.\n";
 			}
@@ -97,7 +117,8 @@ void ConsoleUI::run() {
 		// Delegate input handling to ConsoleInput
 		static ConsoleInput inputHandler;
 		if (inputHandler.handleInput(service, quit)) {
-			// input processed; update display
+			// input processed; queued edits land before the display is updated
+			service.applyPendingEdits();
 			render();
 			//drawHelp();
 		}
@@ -0,0 +1,336 @@
+#include "HeadlessUI.h"
+#include "../Services/BatchService.h"
+#include "../Services/CheckpointService.h"
+#include "../Services/CensusService.h"
+#include "../Services/DistributedService.h"
+#include "../Services/FileService.h"
+#include "../Core/GameRules.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+HeadlessUI::HeadlessUI(GameService& svc) : service(svc) {}
+
+bool HeadlessUI::wantsHeadless(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a.size() > 2 && a[0] == '-' && a[1] == '-') return true;
+	}
+	return false;
+}
+
+void HeadlessUI::printUsage() const {
+	std::cout << "Usage: GameOfLife [--input <file> [--map <file>] | --soup <seed> [--size RxC] [--density d] [--symmetry C2|C4|D8]]\n"
+	          << "                  [--generations <n>] [--save <n> [--archive]] [--toric | --topology <name>] [--rule <B3/S23>]\n"
+	          << "                  [--checkpoint <file>] [--checkpoint-every <n>] [--resume <file>]\n"
+	          << "                  [--distributed <stripes>] [--frames <dir> [--frame-every <n>] [--frame-scale <n>] [--ppm]]\n"
+	          << "       GameOfLife --batch <manifest> [--results <file.csv>] [--threads <n>]\n";
+}
+
+int HeadlessUI::run(int argc, char** argv) {
+	std::string input, mapFile, framesDir, checkpoint, resume, rule, batch, results, symmetry;
+	int generations = -1, save = -1, checkpointEvery = 0, threads = 0;
+	int soupRows = 64, soupCols = 64, census = 0, soupSize = 16, distributed = 0;
+	int frameEvery = 1, frameScale = 1;
+	bool ppm = false;
+	bool sizeSet = false;
+	double density = 0.5;
+	long long soupSeed = -1, firstSeed = 1;
+	bool archive = false;
+	Topology topology = Topology::Bounded;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		auto next = [&](const char* name) -> const char* {
+			if (i + 1 >= argc) { std::cerr << "Missing value for " << name << "\n"; return nullptr; }
+			return argv[++i];
+		};
+		const char* v = nullptr;
+		if (a == "--headless") continue;
+		else if (a == "--toric") topology = Topology::Torus;
+		else if (a == "--topology") {
+			if (!(v = next("--topology"))) return 2;
+			if (!Grid::parseTopology(v, topology)) {
+				std::cerr << "Unknown topology " << v << " (bounded, torus, klein, projective, reflective, alive)\n";
+				return 2;
+			}
+		}
+		else if (a == "--archive") archive = true;
+		else if (a == "--input") { if (!(v = next("--input"))) return 2; input = v; }
+		else if (a == "--map") { if (!(v = next("--map"))) return 2; mapFile = v; }
+		else if (a == "--frames") { if (!(v = next("--frames"))) return 2; framesDir = v; }
+		else if (a == "--frame-every") { if (!(v = next("--frame-every"))) return 2; frameEvery = std::atoi(v); }
+		else if (a == "--frame-scale") { if (!(v = next("--frame-scale"))) return 2; frameScale = std::atoi(v); }
+		else if (a == "--ppm") ppm = true;
+		else if (a == "--generations") { if (!(v = next("--generations"))) return 2; generations = std::atoi(v); }
+		else if (a == "--save") { if (!(v = next("--save"))) return 2; save = std::atoi(v); }
+		else if (a == "--checkpoint") { if (!(v = next("--checkpoint"))) return 2; checkpoint = v; }
+		else if (a == "--checkpoint-every") { if (!(v = next("--checkpoint-every"))) return 2; checkpointEvery = std::atoi(v); }
+		else if (a == "--resume") { if (!(v = next("--resume"))) return 2; resume = v; }
+		else if (a == "--rule") { if (!(v = next("--rule"))) return 2; rule = v; }
+		else if (a == "--batch") { if (!(v = next("--batch"))) return 2; batch = v; }
+		else if (a == "--results") { if (!(v = next("--results"))) return 2; results = v; }
+		else if (a == "--threads") { if (!(v = next("--threads"))) return 2; threads = std::atoi(v); }
+		else if (a == "--soup") { if (!(v = next("--soup"))) return 2; soupSeed = std::atoll(v); }
+		else if (a == "--density") { if (!(v = next("--density"))) return 2; density = std::atof(v); }
+		else if (a == "--symmetry") { if (!(v = next("--symmetry"))) return 2; symmetry = v; }
+		else if (a == "--census") { if (!(v = next("--census"))) return 2; census = std::atoi(v); }
+		else if (a == "--seed") { if (!(v = next("--seed"))) return 2; firstSeed = std::atoll(v); }
+		else if (a == "--distributed") { if (!(v = next("--distributed"))) return 2; distributed = std::atoi(v); }
+		else if (a == "--soup-size") { if (!(v = next("--soup-size"))) return 2; soupSize = std::atoi(v); }
+		else if (a == "--size") {
+			if (!(v = next("--size"))) return 2;
+			std::string sz = v;
+			size_t x = sz.find('x');
+			soupRows = std::atoi(sz.substr(0, x).c_str());
+			soupCols = x == std::string::npos ? soupRows : std::atoi(sz.substr(x + 1).c_str());
+			sizeSet = true;
+		}
+		else if (a == "--help") { printUsage(); return 0; }
+		else { std::cerr << "Unknown option " << a << "\n"; printUsage(); return 2; }
+	}
+
+	if (!batch.empty()) return runBatch(batch, results, threads > 0 ? (unsigned)threads : 0u);
+	if (census > 0) {
+		CensusOptions opt;
+		opt.soups = census;
+		opt.firstSeed = (uint64_t)firstSeed;
+		opt.soupSize = soupSize;
+		opt.density = density;
+		if (sizeSet) { opt.boardRows = soupRows; opt.boardCols = soupCols; }
+		if (!rule.empty()) opt.rule = rule;
+		if (generations > 0) opt.maxGenerations = generations;
+		if (soupSize <= 0 || opt.boardRows <= 0 || opt.boardCols <= 0 || !SoupGenerator::parseSymmetry(symmetry, opt.symmetry)) {
+			std::cerr << "Invalid census options\n";
+			return 2;
+		}
+		return runCensus(opt, results.empty() ? "Output/census.csv" : results, threads > 0 ? (unsigned)threads : 0u);
+	}
+
+	if (!resume.empty()) {
+		// the checkpoint carries grid, rules, topology, counters and output settings
+		if (!service.resumeFromCheckpoint(resume)) {
+			std::cerr << "Failed to resume from " << resume << "\n";
+			return 1;
+		}
+		std::cout << "Resumed at iteration " << service.getIterationIndex() << "\n";
+	} else {
+		service.setTopology(topology);
+		if (soupSeed >= 0) {
+			SoupOptions soup;
+			soup.seed = (uint64_t)soupSeed;
+			soup.density = density;
+			if (soupRows <= 0 || soupCols <= 0 || !SoupGenerator::parseSymmetry(symmetry, soup.symmetry)) {
+				std::cerr << "Invalid soup options\n";
+				return 2;
+			}
+			service.setGridDimensions(soupRows, soupCols);
+			if (!service.loadSoup(soup)) {
+				std::cerr << "Invalid soup options\n";
+				return 2;
+			}
+		} else if (!input.empty()) {
+			// headless runs never reset(): stream the file in without a second copy
+			GridLoadOptions load;
+			load.backingFile = mapFile;
+			int shown = -1;
+			load.progress = [&shown](int done, int rows) {
+				int pct = (int)(100LL * done / rows);
+				if (pct != shown && rows >= 4096) std::cerr << "\rLoading: " << pct << "%" << (done == rows ? "\n" : "") << std::flush;
+				shown = pct;
+				return true;
+			};
+			if (!service.streamInitialFromFile(input, load)) {
+				std::cerr << "Failed to load " << input << "\n";
+				return 1;
+			}
+		}
+	}
+	// explicit options override what the checkpoint restored
+	if (!rule.empty() && !service.setRule(rule)) {
+		std::cerr << "Invalid rule " << rule << "\n";
+		return 2;
+	}
+	if (!service.tilingValid()) {
+		std::cerr << "Rule " << service.getRuleString() << " does not tile a " << service.getRows() << "x" << service.getCols() << " "
+		          << Grid::topologyName(service.getTopology()) << " board (torus: even rows, and even columns for triangles; no mirrored joins)\n";
+		return 2;
+	}
+	if (generations >= 0) service.setIterationTarget(generations);
+	if (save >= 0) service.setSaveIterations(save);
+	if (archive) service.setOutputMode(OutputMode::Archive);
+	if (!checkpoint.empty()) service.setCheckpoint(checkpoint, checkpointEvery);
+
+	if (distributed > 0) {
+		// the workers hold the board: frames would need a snapshot per generation
+		if (!framesDir.empty()) {
+			std::cerr << "--frames is not supported with --distributed\n";
+			return 2;
+		}
+		return runDistributed(distributed);
+	}
+
+	if (!framesDir.empty()) {
+		ImageOptions image;
+		image.scale = frameScale;
+		image.format = ppm ? ImageOptions::Format::Ppm : ImageOptions::Format::Png;
+		if (frameScale <= 0 || !service.startFrameExport(framesDir, image, frameEvery)) {
+			std::cerr << "Cannot export frames to " << framesDir << "\n";
+			return 2;
+		}
+	}
+
+	int target = service.getIterationTarget();
+	service.start();
+	GameService::AdvanceStats stats;
+	if (target == 0) stats = service.advanceUntil([](const GameService &) { return false; });
+	else stats = service.advance(target - service.getIterationIndex());
+	service.pause();
+	service.flushCheckpoints();
+	service.closeArchive();
+	if (!framesDir.empty()) {
+		service.stopFrameExport();
+		std::cout << service.getFrameExporter().framesWritten() << " frames written to " << framesDir << "\n";
+	}
+
+	std::cout << "Stopped at iteration " << service.getIterationIndex()
+	          << (stats.stop == GameService::AdvanceStop::Stabilized ? " (stable)" : "") << "\n";
+	if (stats.generations > 0) {
+		std::cout << stats.generations << " generations in " << stats.elapsedMs << " ms ("
+		          << stats.elapsedMs / stats.generations << " ms/gen), population " << stats.population << "\n";
+	}
+	return 0;
+}
+
+int HeadlessUI::runDistributed(int stripes) const {
+	uint16_t birth = 0, survive = 0;
+	if (!LifeLikeRules::parse(service.getRuleString(), birth, survive)) {
+		std::cerr << "Distributed mode needs a life-like rule on the Moore neighbourhood\n";
+		return 2;
+	}
+	DistributedService dist;
+	std::string err;
+	if (!dist.start(service.getGrid(), birth, survive, stripes, &err)) {
+		std::cerr << "Failed to start workers: " << err << "\n";
+		return 1;
+	}
+	std::cout << "Running on " << dist.stripeCount() << " worker processes\n";
+	// generations count from the service's iteration, as in the regular run
+	// (a resumed board goes on from its checkpoint); 0 generations = until stable
+	const int first = service.getIterationIndex();
+	const int target = service.getIterationTarget();
+	const std::string base = service.getOutputBase();
+	const int save = base.empty() ? 0 : service.getSaveIterations();
+	const int every = service.getCheckpointPath().empty() ? 0 : service.getCheckpointEvery();
+	const bool toArchive = service.getOutputMode() == OutputMode::Archive;
+	GenerationArchiveWriter archive;
+	int lastWritten = -1;
+	// same files as GameService: Output/<base>_<n>.txt or Output/<base>.gola
+	auto writeGeneration = [&](int gen, const Grid &g) {
+		lastWritten = gen;
+		if (!toArchive) return FileService::writeGridIteration(base, gen, g);
+		if (!archive.isOpen()) {
+			std::string path = "Output/" + base + ".gola";
+			bool otherSize = false;
+			if (!(first > 0 ? archive.openAppend(path, g.getR(), g.getC(), otherSize) : archive.open(path, g.getR(), g.getC()))) return false;
+		}
+		return archive.append(gen, g);
+	};
+
+	const int chunk = 100;
+	DistributedStats stats;
+	Grid snap;
+	int now = first;
+	while (target == 0 || now < target) {
+		// statistics come back every `chunk` generations; saved generations are
+		// gathered one by one and batches stop at each checkpoint
+		int n = now < save ? 1 : chunk;
+		if (target > 0) n = std::min(n, target - now);
+		if (every > 0) n = std::min(n, every - now % every);
+		if (!dist.advance(n, stats)) {
+			std::cerr << "A worker process failed\n";
+			return 1;
+		}
+		// a generation that changed nothing ends the run there, not at the end of the batch
+		if (stats.stableGeneration >= 0) {
+			now = first + stats.stableGeneration;
+			break;
+		}
+		now = first + stats.generation;
+		if (now <= save || (every > 0 && now % every == 0)) {
+			if (!dist.snapshot(snap)) {
+				std::cerr << "A worker process failed\n";
+				return 1;
+			}
+			if (now <= save && !writeGeneration(now, snap)) {
+				std::cerr << "Failed to write generation " << now << "\n";
+				return 1;
+			}
+			if (every > 0 && now % every == 0) {
+				GameService::State state = service.captureState();
+				state.grid = snap;
+				state.currentIteration = now;
+				if (!CheckpointService::write(service.getCheckpointPath(), state)) std::cerr << "Failed to write checkpoint " << service.getCheckpointPath() << "\n";
+			}
+		}
+		if (now % chunk == 0) std::cout << "Generation " << now << ": population " << stats.population << "\n";
+	}
+
+	Grid final;
+	if (!dist.snapshot(final)) {
+		std::cerr << "Failed to gather the final grid\n";
+		return 1;
+	}
+	dist.stop();
+	// the final board, unless it was the last saved generation
+	if (!base.empty() && lastWritten != now && !writeGeneration(now, final)) {
+		std::cerr << "Failed to write generation " << now << "\n";
+		return 1;
+	}
+	archive.close();
+	std::cout << "Stopped at generation " << now << (stats.stableGeneration >= 0 ? " (stable)" : "") << ", population " << stats.population << "\n";
+	return 0;
+}
+
+int HeadlessUI::runBatch(const std::string &manifest, const std::string &resultsCsv, unsigned threads) const {
+	std::vector<BatchJob> jobs;
+	std::string err;
+	if (!BatchService::parseManifest(manifest, jobs, &err)) {
+		std::cerr << err << "\n";
+		return 1;
+	}
+	ThreadPool pool(threads);
+	std::cout << "Running " << jobs.size() << " jobs on " << pool.size() << " threads\n";
+	auto results = BatchService::run(jobs, pool);
+	std::cout << BatchService::formatTable(results);
+	if (!resultsCsv.empty() && !BatchService::writeResultsCsv(resultsCsv, results)) {
+		std::cerr << "Failed to write " << resultsCsv << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+int HeadlessUI::runCensus(const CensusOptions &opt, const std::string &resultsCsv, unsigned threads) const {
+	uint16_t b = 0, s = 0;
+	if (!LifeLikeRules::parse(opt.rule, b, s)) {
+		std::cerr << "Invalid rule " << opt.rule << "\n";
+		return 2;
+	}
+	ThreadPool pool(threads);
+	std::cout << "Census of " << opt.soups << " soups (" << opt.rule << ") on " << pool.size() << " threads\n";
+	CensusResult census = CensusService::run(opt, pool);
+	size_t shown = 0;
+	for (const auto &e : census.entries) {
+		if (shown++ == 20) break;
+		std::cout << "  " << e.count << "\t" << e.code << "\n";
+	}
+	std::cout << census.entries.size() << " object types, " << census.unstabilised << " unstabilised soups, "
+	          << (long long)census.ms << " ms\n";
+	if (!FileService::writeCensusTable(resultsCsv, census)) {
+		std::cerr << "Failed to write " << resultsCsv << "\n";
+		return 1;
+	}
+	return 0;
+}
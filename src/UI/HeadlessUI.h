@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../Services/GameService.h"
+#include "../Services/CensusService.h"
+
+// Non-interactive front-end driven by command-line options (batch runs,
+// long simulations on servers). Used by main() when arguments are given.
+//
+//   --input <file>            initial grid (FileService text format)
+//   --generations <n>         number of iterations to run (0 = until stable)
+//   --save <n>                write the first n iterations to Output/
+//   --toric                   enable wrap-around
+//   --topology <name>         bounded, torus, klein, projective, reflective or alive (border)
+//   --checkpoint <file>       checkpoint path
+//   --checkpoint-every <n>    checkpoint period in iterations
+//   --resume <file>           restore a checkpoint and continue from it
+//   --rule <B3/S23>           life-like rule
+//   --soup <seed>             start from a random soup instead of --input
+//   --size <rows>x<cols>      soup grid size (default 64x64)
+//   --density <0..1>          soup density (default 0.5)
+//   --symmetry <C2|C4|D8>     symmetric soup
+//   --batch <manifest>        run a sweep of jobs (see BatchService)
+//   --census <soups>          soup census: count the objects left by many soups
+//   --seed <n>                first census seed (soups use seed, seed+1, ...)
+//   --soup-size <n>           side of each census soup (board size: --size, default 96x96)
+//   --results <file.csv>      CSV export of the batch / census table
+//   --threads <n>             worker threads for --batch and --census (0 = all cores)
+//   --distributed <stripes>   split the board over that many worker processes (POSIX)
+class HeadlessUI {
+public:
+	explicit HeadlessUI(GameService& svc);
+
+	// Parse arguments and run; returns the process exit code
+	int run(int argc, char** argv);
+
+	// true when argv asks for the headless front-end
+	static bool wantsHeadless(int argc, char** argv);
+
+private:
+	GameService& service;
+
+	void printUsage() const;
+	int runBatch(const std::string &manifest, const std::string &resultsCsv, unsigned threads) const;
+	int runCensus(const CensusOptions &opt, const std::string &resultsCsv, unsigned threads) const;
+	int runDistributed(int stripes) const;
+};
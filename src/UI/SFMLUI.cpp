@@ -532,18 +532,44 @@ void SFMLUI::drawGameScreen() {
     int rows = service.getRows();
     int cols = service.getCols();
 
+    // cell shapes follow the rule's neighbourhood: hexagons on offset rows
+    // (odd rows half a cell to the right), alternating up / down triangles,
+    // squares otherwise
+    const Neighborhood hood = service.getNeighborhood();
+    // triangles overlap their neighbours by half a base so the row still spans cols cells
+    const float triangleStep = cellSize * cols / (cols + 1.0f);
     for (int r = 0; r < rows; ++r) {
         for (int c = 0; c < cols; ++c) {
-            sf::RectangleShape cell({cellSize - 1.0f, cellSize - 1.0f});
-            cell.setPosition({gridOffsetX + c * cellSize, gridOffsetY + r * cellSize});
-
-            if (service.getCell(r, c)) {
-                cell.setFillColor(sf::Color::White);
+            sf::Color fill = service.getCell(r, c) ? sf::Color::White : sf::Color::Black;
+            if (hood.layout == Neighborhood::Layout::Hexagonal) {
+                // pointy-top hexagon as wide as a cell
+                float radius = cellSize / 1.732f;
+                sf::CircleShape cell(radius - 0.5f, 6);
+                cell.setOrigin({radius - 0.5f, radius - 0.5f});
+                float shift = (r & 1) ? 0.5f : 0.0f;
+                cell.setPosition({gridOffsetX + (c + 0.5f + shift) * cellSize, gridOffsetY + (r + 0.5f) * cellSize});
+                cell.setFillColor(fill);
+                window.draw(cell);
+            } else if (hood.layout == Neighborhood::Layout::Triangular) {
+                sf::ConvexShape cell(3);
+                float x = gridOffsetX + c * triangleStep, y = gridOffsetY + r * cellSize;
+                if (((r + c) & 1) == 0) {
+                    cell.setPoint(0, {x + triangleStep, y + 0.5f});
+                    cell.setPoint(1, {x + 2 * triangleStep - 0.5f, y + cellSize - 0.5f});
+                    cell.setPoint(2, {x + 0.5f, y + cellSize - 0.5f});
+                } else {
+                    cell.setPoint(0, {x + 0.5f, y + 0.5f});
+                    cell.setPoint(1, {x + 2 * triangleStep - 0.5f, y + 0.5f});
+                    cell.setPoint(2, {x + triangleStep, y + cellSize - 0.5f});
+                }
+                cell.setFillColor(fill);
+                window.draw(cell);
             } else {
-                cell.setFillColor(sf::Color::Black);
+                sf::RectangleShape cell({cellSize - 1.0f, cellSize - 1.0f});
+                cell.setPosition({gridOffsetX + c * cellSize, gridOffsetY + r * cellSize});
+                cell.setFillColor(fill);
+                window.draw(cell);
             }
-
-            window.draw(cell);
         }
     }
 
@@ -1,4 +1,5 @@
 #include "UI/ConsoleUI.h"
+#include "UI/HeadlessUI.h"
 #include "Services/GameService.h"
 #include <iostream>
 #include <limits>
@@ -9,7 +10,14 @@
 #include <chrono>
 
 
-int main() {
+int main(int argc, char** argv) {
+    // command-line options -> non-interactive run (batch, resume from checkpoint)
+    if (HeadlessUI::wantsHeadless(argc, argv)) {
+        GameService service;
+        HeadlessUI headless(service);
+        return headless.run(argc, argv);
+    }
+
    int choix;
     
     std::cout << "Entrez 1 ou 2: ";
@@ -56,9 +64,11 @@ int main() {
                 break;
             }
             
-            // Step the simulation
+            // Step the simulation (step() applies the queued edits first)
             if (service->isRunning()) {
                 service->step();
+            } else {
+                service->applyPendingEdits();
             }
             
             std::this_thread::sleep_for(std::chrono::milliseconds(service->getTickMs()));
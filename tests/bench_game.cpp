@@ -0,0 +1,354 @@
+// Micro-benchmarks for the simulation core (not part of the unit tests).
+// Usage: bench_game [name...]   (no name = run everything)
+// Each benchmark prints one line per measurement; a non-zero exit code means
+// a benchmark's invariant (e.g. zero steady-state allocations) was violated.
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../src/Core/GameRules.h"
+#include "../src/Core/Grid.h"
+#include "../src/Core/GridArena.h"
+#include "../src/Core/SoupGenerator.h"
+#include "../src/Core/StepKernel.h"
+#include "../src/Services/GameService.h"
+#include "../src/Services/TileQueue.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double msSince(clock_type::time_point t0) {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - t0).count();
+}
+
+void report(const std::string &bench, const std::string &what, double value, const std::string &unit) {
+    std::cout << bench << "\t" << what << "\t" << value << " " << unit << "\n";
+}
+
+// Grid storage: resizing to the same dimensions and copy-assigning must reuse the
+// arena block, and a running simulation must not allocate after its first step.
+bool benchArena() {
+    bool ok = true;
+    const int n = 1024;
+    const int iterations = 200;
+
+    Grid a(n, n), b(n, n);
+    for (int r = 0; r < n; r += 3) for (int c = 0; c < n; c += 2) a.setCell(r, c, true);
+
+    // the arena only counts while asked to
+    GridArena::countAllocations(true);
+    uint64_t before = GridArena::allocationCount();
+    auto t0 = clock_type::now();
+    for (int i = 0; i < iterations; ++i) b.setGridDimensions(n, n);
+    report("arena", "resize 1024x1024 (same dims)", msSince(t0) / iterations, "ms");
+    report("arena", "resize allocations", (double)(GridArena::allocationCount() - before), "");
+    ok &= GridArena::allocationCount() == before;
+
+    before = GridArena::allocationCount();
+    t0 = clock_type::now();
+    for (int i = 0; i < iterations; ++i) b = a;
+    report("arena", "copy-assign 1024x1024", msSince(t0) / iterations, "ms");
+    report("arena", "copy-assign allocations", (double)(GridArena::allocationCount() - before), "");
+    ok &= GridArena::allocationCount() == before;
+
+    GameService svc;
+    svc.setMaxThreads(1);
+    svc.setGridDimensions(512, 512);
+    SoupOptions soup;
+    soup.seed = 1;
+    soup.density = 0.4;
+    svc.loadSoup(soup);
+    svc.start();
+    svc.step(); // warm-up: the buffer gets its block here
+    before = GridArena::allocationCount();
+    t0 = clock_type::now();
+    const int steps = 50;
+    for (int i = 0; i < steps; ++i) svc.step();
+    report("arena", "step 512x512", msSince(t0) / steps, "ms");
+    report("arena", "steady-state step allocations", (double)(GridArena::allocationCount() - before), "");
+    ok &= GridArena::allocationCount() == before;
+    GridArena::countAllocations(false);
+    return ok;
+}
+
+// Full-row bands versus cache-sized tiles on a board much wider than L2
+bool benchTiles() {
+    auto t0 = clock_type::now();
+    TileSize tuned = TileTuner::tuned();
+    report("tiles", "autotune", msSince(t0), "ms");
+    report("tiles", "tuned tile rows", tuned.rows, "");
+    report("tiles", "tuned tile cols (0 = full rows)", tuned.cols, "");
+
+    const int rows = 512, cols = 8192, steps = 10;
+    auto run = [&](TileSize size, long long threshold) {
+        GameService svc;
+        svc.setGridDimensions(rows, cols);
+        SoupOptions soup;
+        soup.seed = 3;
+        soup.density = 0.4;
+        svc.loadSoup(soup);
+        svc.setTileSize(size);
+        svc.setTilingThreshold(threshold);
+        svc.start();
+        svc.step();
+        auto t = clock_type::now();
+        for (int i = 0; i < steps; ++i) svc.step();
+        double ms = msSince(t) / steps;
+        return std::make_pair(ms, svc.getGrid().hash());
+    };
+    auto bands = run(TileSize{}, (long long)rows * cols + 1);
+    auto tiled = run(tuned, 0);
+    report("tiles", "step 512x8192 row bands", bands.first, "ms");
+    report("tiles", "step 512x8192 tuned tiles", tiled.first, "ms");
+    return bands.second == tiled.second;
+}
+
+// Strong scaling from 1 worker to every core, with and without NUMA placement
+bool benchScaling() {
+    const int rows = 2048, cols = 2048, steps = 20;
+    unsigned hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < hw; n *= 2) counts.push_back(n);
+    counts.push_back(hw);
+    bool ok = true;
+    uint64_t reference = 0;
+    double base = 0.0;
+    for (int numa = 0; numa <= 1; ++numa) {
+        for (unsigned n : counts) {
+            ThreadPool pool(n);
+            GameService svc;
+            svc.setThreadPool(&pool);
+            svc.setNumaAware(numa != 0);
+            svc.setGridDimensions(rows, cols);
+            SoupOptions soup;
+            soup.seed = 9;
+            soup.density = 0.4;
+            svc.loadSoup(soup);
+            svc.start();
+            svc.step();  // places the bands / tunes the tiles outside the timing
+            auto t0 = clock_type::now();
+            for (int i = 0; i < steps; ++i) svc.step();
+            double ms = msSince(t0) / steps;
+            if (base == 0.0) base = ms;
+            std::string label = std::string(numa ? "numa" : "default") + " " + std::to_string(n) + " threads";
+            report("scaling", label + " step 2048x2048", ms, "ms");
+            report("scaling", label + " speedup", base / ms, "x");
+            uint64_t h = svc.getGrid().hash();
+            if (reference == 0) reference = h;
+            ok &= h == reference;
+        }
+    }
+    return ok;
+}
+
+// k single steps versus one temporally blocked stepN(k) on a board far above L2
+bool benchTemporal() {
+    const int rows = 4096, cols = 4096, k = 8;
+    auto run = [&](bool blocked) {
+        GameService svc;
+        svc.setGridDimensions(rows, cols);
+        SoupOptions soup;
+        soup.seed = 5;
+        soup.density = 0.4;
+        svc.loadSoup(soup);
+        svc.start();
+        svc.step();
+        auto t = clock_type::now();
+        for (int round = 0; round < 2; ++round) {
+            if (blocked) svc.stepN(k);
+            else for (int i = 0; i < k; ++i) svc.step();
+        }
+        double ms = msSince(t) / (2 * k);
+        return std::make_pair(ms, svc.getGrid().hash());
+    };
+    auto single = run(false);
+    auto blocked = run(true);
+    report("temporal", "step 4096x4096 one generation per pass", single.first, "ms/gen");
+    report("temporal", "stepN(8) 4096x4096", blocked.first, "ms/gen");
+    return single.second == blocked.second;
+}
+
+bool benchOutOfCore() {
+    const int rows = 8192, cols = 8192, gens = 4;
+    auto run = [&](bool mapped) {
+        GameService svc;
+        svc.setGridDimensions(rows, cols);
+        SoupOptions soup;
+        soup.seed = 6;
+        soup.density = 0.4;
+        svc.loadSoup(soup);
+        if (mapped && !svc.setOutOfCore((std::filesystem::temp_directory_path() / "bench_ooc.map").string())) return std::make_pair(-1.0, 0ull);
+        svc.step();
+        auto t = clock_type::now();
+        svc.advance(gens);
+        double ms = msSince(t) / gens;
+        return std::make_pair(ms, (unsigned long long)svc.getGrid().hash());
+    };
+    auto heap = run(false);
+    auto mapped = run(true);
+    report("outofcore", "step 8192x8192 on the heap", heap.first, "ms/gen");
+    report("outofcore", "step 8192x8192 memory-mapped, 3-stripe window", mapped.first, "ms/gen");
+    return mapped.first >= 0 && heap.second == mapped.second;
+}
+
+bool benchFrames() {
+    const int side = 1024, gens = 200;
+    auto dir = std::filesystem::temp_directory_path() / "bench_frames";
+    auto run = [&](bool exportFrames) {
+        GameService svc;
+        svc.setGridDimensions(side, side);
+        SoupOptions soup;
+        soup.seed = 9;
+        soup.density = 0.35;
+        svc.loadSoup(soup);
+        svc.setOutputBase("bench");
+        if (exportFrames) svc.startFrameExport(dir.string(), ImageOptions());
+        auto t = clock_type::now();
+        svc.advance(gens);
+        double stepMs = msSince(t) / gens;
+        svc.stopFrameExport();
+        double totalMs = msSince(t) / gens;
+        return std::make_pair(stepMs, totalMs);
+    };
+    auto plain = run(false);
+    auto exported = run(true);
+    std::filesystem::remove_all(dir);
+    report("frames", "step 1024x1024 without export", plain.first, "ms/gen");
+    report("frames", "step 1024x1024 exporting PNG frames (simulation thread)", exported.first, "ms/gen");
+    report("frames", "including draining the writer", exported.second, "ms/gen");
+    return true;
+}
+
+bool benchObstacles() {
+    const int side = 2048, gens = 40;
+    // obstacles every `every` rows (0 = none), in one column
+    auto run = [&](int every) {
+        GameService svc;
+        svc.setGridDimensions(side, side);
+        SoupOptions soup;
+        soup.seed = 11;
+        soup.density = 0.35;
+        svc.loadSoup(soup);
+        for (int r = 0; every > 0 && r < side; r += every) svc.setObstacle(r, side / 2, true);
+        svc.step();
+        auto t = clock_type::now();
+        svc.advance(gens);
+        return msSince(t) / gens;
+    };
+    report("obstacles", "step 2048x2048 without obstacles", run(0), "ms/gen");
+    report("obstacles", "obstacle on one row in 64", run(64), "ms/gen");
+    report("obstacles", "obstacle wall (every row)", run(1), "ms/gen");
+    return true;
+}
+
+bool benchTopologies() {
+    const int side = 2048, gens = 20;
+    const Topology all[] = {Topology::Bounded, Topology::Torus, Topology::KleinBottle,
+                            Topology::ProjectivePlane, Topology::Reflective, Topology::AliveBorder};
+    for (Topology t : all) {
+        GameService svc;
+        svc.setGridDimensions(side, side);
+        svc.setTopology(t);
+        SoupOptions soup;
+        soup.seed = 13;
+        soup.density = 0.35;
+        svc.loadSoup(soup);
+        svc.step();
+        auto start = clock_type::now();
+        svc.advance(gens);
+        report("topology", std::string("step 2048x2048 ") + Grid::topologyName(t), msSince(start) / gens, "ms/gen");
+    }
+    return true;
+}
+
+bool benchNeighborhoods() {
+    const int side = 2048, gens = 20;
+    const char *rules[] = {"B3/S23", "B2/S34H", "B2/S13T", "B1/S12V", "B3/S23N5F"};
+    for (const char *rule : rules) {
+        GameService svc;
+        svc.setGridDimensions(side, side);
+        if (!svc.setRule(rule)) return false;
+        SoupOptions soup;
+        soup.seed = 17;
+        soup.density = 0.35;
+        svc.loadSoup(soup);
+        svc.step();
+        auto start = clock_type::now();
+        svc.advance(gens);
+        report("neighborhood", std::string("step 2048x2048 ") + rule, msSince(start) / gens, "ms/gen");
+    }
+    return true;
+}
+
+// rule-specialised row kernels against the generic table-driven one, row by row
+bool benchRuleKernels() {
+    const int side = 2048, passes = 20;
+    Grid src(side, side), a(side, side), b(side, side);
+    SoupOptions soup;
+    soup.seed = 19;
+    soup.density = 0.4;
+    SoupGenerator::fill(src, soup);
+    src.refreshHalo();
+    const char *rules[] = {"B3/S23", "B36/S23", "B2/S", "B3678/S34678", "B36/S245"};
+    bool ok = true;
+    for (const char *rule : rules) {
+        uint16_t birth = 0, survive = 0;
+        LifeLikeRules::parse(rule, birth, survive);
+        StepKernel::RowKernel kernel = StepKernel::ruleRow(birth, survive, false);
+        auto t = clock_type::now();
+        for (int p = 0; p < passes; ++p) {
+            for (int r = 0; r < side; ++r) StepKernel::lifeRow(src.rowPtr(r - 1), src.rowPtr(r), src.rowPtr(r + 1), a.rowPtr(r), side, birth, survive);
+        }
+        double generic = msSince(t) / passes;
+        t = clock_type::now();
+        for (int p = 0; p < passes; ++p) {
+            for (int r = 0; r < side; ++r) kernel(src.rowPtr(r - 1), src.rowPtr(r), src.rowPtr(r + 1), b.rowPtr(r), side, birth, survive, nullptr);
+        }
+        double fixed = msSince(t) / passes;
+        std::string label = std::string(rule) + (StepKernel::hasSpecialisedRule(birth, survive) ? " specialised" : " generic fallback");
+        report("rulekernels", std::string(rule) + " generic kernel 2048x2048", generic, "ms/gen");
+        report("rulekernels", label + " 2048x2048", fixed, "ms/gen");
+        ok &= a.equals(b);
+    }
+    return ok;
+}
+
+struct Bench {
+    const char *name;
+    std::function<bool()> run;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<Bench> benches = {
+        {"arena", benchArena},
+        {"tiles", benchTiles},
+        {"scaling", benchScaling},
+        {"temporal", benchTemporal},
+        {"outofcore", benchOutOfCore},
+        {"frames", benchFrames},
+        {"obstacles", benchObstacles},
+        {"topology", benchTopologies},
+        {"neighborhood", benchNeighborhoods},
+        {"rulekernels", benchRuleKernels},
+    };
+    bool ok = true;
+    for (const auto &b : benches) {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; ++i) if (std::strcmp(argv[i], b.name) == 0) selected = true;
+        if (!selected) continue;
+        bool passed = b.run();
+        if (!passed) std::cout << b.name << "\tFAILED\n";
+        ok &= passed;
+    }
+    return ok ? 0 : 1;
+}
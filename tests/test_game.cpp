@@ -4,8 +4,24 @@
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
+#include <random>
+#include <thread>
 #include "../src/Services/GameService.h"
 #include "../src/Services/FileService.h"
+#include "../src/Services/BatchService.h"
+#include "../src/Core/GameRules.h"
+#include "../src/Core/SoupGenerator.h"
+#include "../src/Core/StepKernel.h"
+#include "../src/Services/CensusService.h"
+#include "../src/Services/TileQueue.h"
+#include "../src/Services/DistributedService.h"
+#include "../src/Core/QuadTree.h"
+#include "../src/Services/BlockCodec.h"
+#include "../src/Services/GenerationArchive.h"
+#include "../src/Services/PatternLibrary.h"
+#include "../src/Services/ThreadPool.h"
+#include "../src/Services/FrameExporter.h"
 
 static std::string gridToString(const Grid &g) {
     std::ostringstream oss;
@@ -24,6 +40,122 @@ static void dumpExpectedActual(const Grid &expected, const Grid &actual) {
     std::cout << "ACTUAL:\n" << gridToString(actual) << "\n";
 }
 
+// Minimal zlib decoder for the PNG checks: stored and fixed Huffman blocks
+// only, which is all DeflateStream writes. False on anything else, on a
+// truncated stream or on a wrong Adler-32.
+static bool inflateZlib(const std::vector<uint8_t> &in, std::vector<uint8_t> &out) {
+    if (in.size() < 6 || (in[0] & 0x0F) != 8 || ((in[0] << 8) | in[1]) % 31 != 0) return false;
+    static const int lenBase[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const int lenExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int distBase[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                   1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const int distExtra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    size_t pos = 2;
+    uint32_t bitBuf = 0;
+    int bitCount = 0;
+    bool bad = false;
+    auto bits = [&](int n) {
+        while (bitCount < n) {
+            if (pos >= in.size()) { bad = true; return 0u; }
+            bitBuf |= (uint32_t)in[pos++] << bitCount;
+            bitCount += 8;
+        }
+        uint32_t v = bitBuf & ((1u << n) - 1);
+        bitBuf >>= n;
+        bitCount -= n;
+        return v;
+    };
+    // Huffman codes are packed most significant bit first
+    auto code = [&](int n) {
+        uint32_t v = 0;
+        for (int i = 0; i < n; ++i) v = v << 1 | bits(1);
+        return v;
+    };
+    auto symbol = [&]() {
+        uint32_t c = code(7);
+        if (c <= 0x17) return (int)c + 256;
+        c = c << 1 | bits(1);
+        if (c >= 0x30 && c <= 0xBF) return (int)c - 0x30;
+        if (c >= 0xC0 && c <= 0xC7) return (int)c - 0xC0 + 280;
+        c = c << 1 | bits(1);
+        if (c >= 0x190) return (int)c - 0x190 + 144;
+        return -1;
+    };
+    for (bool last = false; !last;) {
+        last = bits(1) != 0;
+        uint32_t type = bits(2);
+        if (bad) return false;
+        if (type == 0) {
+            // stored: the rest of the current byte is padding
+            bitBuf = 0;
+            bitCount = 0;
+            if (pos + 4 > in.size()) return false;
+            size_t len = in[pos] | in[pos + 1] << 8;
+            if ((len ^ (size_t)(in[pos + 2] | in[pos + 3] << 8)) != 0xFFFF || pos + 4 + len > in.size()) return false;
+            out.insert(out.end(), in.begin() + (long)pos + 4, in.begin() + (long)(pos + 4 + len));
+            pos += 4 + len;
+        } else if (type == 1) {
+            for (;;) {
+                int s = symbol();
+                if (bad || s < 0 || s > 285) return false;
+                if (s < 256) { out.push_back((uint8_t)s); continue; }
+                if (s == 256) break;
+                size_t length = (size_t)lenBase[s - 257] + bits(lenExtra[s - 257]);
+                uint32_t d = code(5);
+                if (d > 29) return false;
+                size_t dist = (size_t)distBase[d] + bits(distExtra[d]);
+                if (bad || dist > out.size()) return false;
+                for (size_t i = 0; i < length; ++i) out.push_back(out[out.size() - dist]);
+            }
+        } else {
+            return false;
+        }
+    }
+    // byte-aligned big-endian Adler-32 of the decoded data
+    if (pos + 4 > in.size()) return false;
+    uint32_t adler = (uint32_t)in[pos] << 24 | (uint32_t)in[pos + 1] << 16 | (uint32_t)in[pos + 2] << 8 | in[pos + 3];
+    return adler == DeflateStream::adler32(out.data(), out.size());
+}
+
+// Decode a 2-bit palette PNG as FrameExporter writes it into 0xRRGGBB pixels
+static bool decodePng(const std::vector<uint8_t> &png, int &width, int &height, std::vector<uint32_t> &pixels) {
+    auto be32 = [&png](size_t p) { return (uint32_t)png[p] << 24 | (uint32_t)png[p + 1] << 16 | (uint32_t)png[p + 2] << 8 | png[p + 3]; };
+    std::vector<uint8_t> idat;
+    std::vector<uint32_t> palette;
+    width = height = 0;
+    for (size_t p = 8; p + 12 <= png.size();) {
+        uint32_t len = be32(p);
+        if (p + 12 + len > png.size()) return false;
+        std::string type(png.begin() + (long)p + 4, png.begin() + (long)p + 8);
+        const size_t data = p + 8;
+        if (type == "IHDR") {
+            width = (int)be32(data);
+            height = (int)be32(data + 4);
+            if (png[data + 8] != 2 || png[data + 9] != 3) return false;
+        } else if (type == "PLTE") {
+            for (size_t i = 0; i + 3 <= len; i += 3) palette.push_back((uint32_t)png[data + i] << 16 | (uint32_t)png[data + i + 1] << 8 | png[data + i + 2]);
+        } else if (type == "IDAT") {
+            idat.insert(idat.end(), png.begin() + (long)data, png.begin() + (long)(data + len));
+        }
+        p += 12 + len;
+    }
+    std::vector<uint8_t> raw;
+    if (width <= 0 || height <= 0 || !inflateZlib(idat, raw)) return false;
+    const size_t rowBytes = 1 + ((size_t)width * 2 + 7) / 8;
+    if (raw.size() != rowBytes * (size_t)height) return false;
+    pixels.assign((size_t)width * height, 0);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *row = raw.data() + (size_t)y * rowBytes;
+        if (row[0] != 0) return false;   // filter "none" only
+        for (int x = 0; x < width; ++x) {
+            size_t index = (row[1 + x / 4] >> (6 - 2 * (x % 4))) & 3;
+            if (index >= palette.size()) return false;
+            pixels[(size_t)y * width + x] = palette[index];
+        }
+    }
+    return true;
+}
+
 
 TEST_CASE("blinker", "[evolution]") {
     auto t0 = std::chrono::steady_clock::now();
@@ -187,3 +319,1730 @@ TEST_CASE("file_io", "[io]") {
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
     std::cout << "[FIN] entree_sortie_fichier (" << ms << " ms)\n";
 }
+
+TEST_CASE("step_profiler", "[profiling]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] step_profiler\n";
+    GameService svc;
+    svc.setGridDimensions(8,8);
+    svc.setCell(2,1,true);
+    svc.setCell(2,2,true);
+    svc.setCell(2,3,true);
+
+    // disabled by default: nothing is recorded
+    svc.step();
+    REQUIRE( svc.getProfiler().getStepCount() == 0 );
+
+    svc.setProfilingEnabled(true);
+    svc.step();
+    svc.step();
+    const StepProfiler &prof = svc.getProfiler();
+    REQUIRE( prof.getStepCount() == 2 );
+    REQUIRE( prof.getPhaseStats(StepProfiler::Phase::Compute).calls == 2 );
+    REQUIRE( prof.getPhaseStats(StepProfiler::Phase::Equals).calls == 2 );
+    REQUIRE( !prof.getThreadStats().empty() );
+    REQUIRE( prof.toJson().find("\"compute\"") != std::string::npos );
+    REQUIRE( prof.toChromeTrace().find("\"ph\": \"X\"") != std::string::npos );
+    std::cout << prof.toCsv();
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] step_profiler (" << ms << " ms)\n";
+}
+
+TEST_CASE("checkpoint_resume", "[checkpoint]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] checkpoint_resume\n";
+    std::string path = (std::filesystem::temp_directory_path() / "gol_test.ckpt").string();
+
+    // uninterrupted reference run: glider on a torus, checkpoint every 3 iterations
+    GameService ref;
+    ref.setGridDimensions(8,8);
+    ref.setToric(true);
+    ref.setCell(0,1,true);
+    ref.setCell(1,2,true);
+    ref.setCell(2,0,true);
+    ref.setCell(2,1,true);
+    ref.setCell(2,2,true);
+    ref.setObstacle(6,6,true);
+    ref.setCheckpoint(path, 3);
+    ref.advance(3);
+    ref.flushCheckpoints();
+    ref.setCheckpoint(path, 0); // keep the iteration-3 checkpoint
+    ref.advance(4);
+
+    // resumed run continues from iteration 3
+    GameService resumed;
+    REQUIRE( resumed.resumeFromCheckpoint(path) );
+    REQUIRE( resumed.getIterationIndex() == 3 );
+    REQUIRE( resumed.isToric() );
+    resumed.advance(4);
+    std::cout << "Reprise checkpoint (attendu vs obtenu):\n";
+    dumpExpectedActual(ref.getGrid(), resumed.getGrid());
+    REQUIRE( resumed.getIterationIndex() == ref.getIterationIndex() );
+    REQUIRE( ref.getGrid().equals(resumed.getGrid()) );
+    std::filesystem::remove(path);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] checkpoint_resume (" << ms << " ms)\n";
+}
+
+TEST_CASE("batch_runner", "[batch]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] batch_runner\n";
+    uint16_t b = 0, s = 0;
+    REQUIRE( LifeLikeRules::parse("B36/S23", b, s) );
+    REQUIRE( LifeLikeRules::format(b, s) == "B36/S23" );
+    REQUIRE( !LifeLikeRules::parse("B9/S23", b, s) );
+
+    std::string blinker = (std::filesystem::temp_directory_path() / "gol_batch_blinker.txt").string();
+    {
+        std::ofstream ofs(blinker);
+        ofs << "5 5\n0 0 0 0 0\n0 0 0 0 0\n0 1 1 1 0\n0 0 0 0 0\n0 0 0 0 0\n";
+    }
+    std::vector<BatchJob> jobs(3);
+    REQUIRE( BatchService::parseJobLine("name=blinker input=" + blinker + " gens=50", jobs[0]) );
+    REQUIRE( BatchService::parseJobLine("name=soup seed=7 size=24x32 density=0.4 gens=400 toric=1", jobs[1]) );
+    REQUIRE( BatchService::parseJobLine("name=highlife seed=7 size=24x32 rule=B36/S23 gens=400", jobs[2]) );
+
+    ThreadPool pool(3);
+    auto results = BatchService::run(jobs, pool);
+    std::cout << BatchService::formatTable(results);
+    REQUIRE( results.size() == 3 );
+    REQUIRE( results[0].ok );
+    REQUIRE( results[0].period == 2 );
+    REQUIRE( results[0].population == 3 );
+    REQUIRE( results[1].ok );
+    REQUIRE( results[1].rows == 24 );
+    REQUIRE( results[1].cols == 32 );
+    REQUIRE( results[2].rule == "B36/S23" );
+    // same seed and rule must give the same outcome
+    BatchResult again = BatchService::runJob(jobs[1], pool, false);
+    REQUIRE( again.population == results[1].population );
+    REQUIRE( again.generations == results[1].generations );
+    std::filesystem::remove(blinker);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] batch_runner (" << ms << " ms)\n";
+}
+
+TEST_CASE("soup_generator", "[soup]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] soup_generator\n";
+    // reproducible: same seed -> same bits, different seed -> different bits
+    size_t wpr = 0;
+    auto a = SoupGenerator::generateBits(64, 100, 42, 0.375, SoupSymmetry::NONE, wpr);
+    auto b = SoupGenerator::generateBits(64, 100, 42, 0.375, SoupSymmetry::NONE, wpr);
+    auto c = SoupGenerator::generateBits(64, 100, 43, 0.375, SoupSymmetry::NONE, wpr);
+    REQUIRE( wpr == 2 );
+    REQUIRE( a == b );
+    REQUIRE( a != c );
+
+    // density is respected on a large sample
+    auto tg = std::chrono::steady_clock::now();
+    auto big = SoupGenerator::generateBits(2048, 2048, 1, 0.3, SoupSymmetry::NONE, wpr);
+    auto tgEnd = std::chrono::steady_clock::now();
+    size_t alive = 0;
+    for (uint64_t w : big) alive += (size_t)__builtin_popcountll(w);
+    double ratio = (double)alive / (2048.0 * 2048.0);
+    std::cout << "Soupe 2048x2048 densite 0.3: " << ratio << " ("
+              << std::chrono::duration_cast<std::chrono::microseconds>(tgEnd - tg).count() << " us)\n";
+    REQUIRE( ratio > 0.29 );
+    REQUIRE( ratio < 0.31 );
+
+    // D8 soup in a sub-region of a grid
+    Grid g(12, 12);
+    SoupOptions opt;
+    opt.seed = 5;
+    opt.row = 2; opt.col = 2; opt.height = 7; opt.width = 7;
+    opt.symmetry = SoupSymmetry::D8;
+    REQUIRE( SoupGenerator::fill(g, opt) );
+    for (int r = 0; r < 7; ++r) for (int cc = 0; cc < 7; ++cc) {
+        bool v = g.getCell(2 + r, 2 + cc);
+        REQUIRE( v == g.getCell(2 + cc, 2 + r) );
+        REQUIRE( v == g.getCell(2 + 6 - r, 2 + cc) );
+        REQUIRE( v == g.getCell(2 + r, 2 + 6 - cc) );
+    }
+    for (int i = 0; i < 12; ++i) { REQUIRE( !g.getCell(0, i) ); REQUIRE( !g.getCell(i, 11) ); }
+    opt.width = 6;
+    REQUIRE( !SoupGenerator::fill(g, opt) );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] soup_generator (" << ms << " ms)\n";
+}
+
+TEST_CASE("soup_census", "[census]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] soup_census\n";
+    uint16_t b = LifeLikeRules::kConwayBirth, s = LifeLikeRules::kConwaySurvive;
+    CensusService::Cells block = {{10,10},{10,11},{11,10},{11,11}};
+    CensusService::Cells blinker = {{5,4},{5,5},{5,6}};
+    CensusService::Cells glider = {{0,1},{1,2},{2,0},{2,1},{2,2}};
+    auto iBlock = CensusService::classify(block, b, s, 16);
+    auto iBlinker = CensusService::classify(blinker, b, s, 16);
+    auto iGlider = CensusService::classify(glider, b, s, 16);
+    std::cout << "EXPECTED: xs4_33 xp2_7 xq4_153\n";
+    std::cout << "ACTUAL:   " << iBlock.code << " " << iBlinker.code << " " << iGlider.code << "\n";
+    REQUIRE( iBlock.code == "xs4_33" );
+    REQUIRE( iBlock.kind == "still" );
+    REQUIRE( iBlinker.code == "xp2_7" );
+    REQUIRE( iBlinker.period == 2 );
+    REQUIRE( iGlider.kind == "spaceship" );
+    REQUIRE( iGlider.code == "xq4_153" );
+
+    // two objects far apart are separated, touching cells are not
+    CensusService::Cells both = block;
+    both.insert(both.end(), blinker.begin(), blinker.end());
+    REQUIRE( CensusService::separateObjects(both).size() == 2 );
+    REQUIRE( CensusService::separateObjects(glider).size() == 1 );
+
+    // small reproducible census
+    ThreadPool pool(2);
+    CensusOptions opt;
+    opt.soups = 4;
+    opt.boardRows = opt.boardCols = 48;
+    opt.soupSize = 10;
+    opt.maxGenerations = 1500;
+    CensusResult r1 = CensusService::run(opt, pool);
+    CensusResult r2 = CensusService::run(opt, pool);
+    REQUIRE( r1.rule == "B3/S23" );
+    REQUIRE( r1.entries.size() == r2.entries.size() );
+    for (size_t i = 0; i < r1.entries.size(); ++i) {
+        REQUIRE( r1.entries[i].code == r2.entries[i].code );
+        REQUIRE( r1.entries[i].count == r2.entries[i].count );
+    }
+    for (size_t i = 0; i < r1.entries.size() && i < 5; ++i) std::cout << r1.entries[i].count << " " << r1.entries[i].code << "\n";
+    std::cout << "Recensement " << opt.soups << " soupes: " << (long long)r1.ms << " ms\n";
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] soup_census (" << ms << " ms)\n";
+}
+
+TEST_CASE("flyweight_cells", "[grid]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] flyweight_cells\n";
+    Grid g(64, 64);
+    Cell::countAllocations(true);
+    uint64_t before = Cell::threadAllocationCount();
+    for (int r = 0; r < 64; ++r) for (int c = 0; c < 64; ++c) g.setCell(r, c, (r + c) % 3 == 0);
+    Grid copy(g);
+    g.setObstacle(1, 1, true);
+    g.setCell(1, 1, true);
+    uint64_t allocs = Cell::threadAllocationCount() - before;
+    std::cout << "EXPECTED allocations: 0\n";
+    std::cout << "ACTUAL allocations:   " << allocs << "\n";
+    REQUIRE( allocs == 0 );
+    REQUIRE( Cell::createAlive()->isAlive() );
+    REQUIRE( Cell::threadAllocationCount() - before == 1 );
+    Cell::countAllocations(false);
+    // the counter only runs on demand
+    Cell::createDead();
+    REQUIRE( Cell::threadAllocationCount() - before == 1 );
+    // every cell in the same state is the same shared object
+    REQUIRE( &g.getCellObject(0, 0) == &g.getCellObject(0, 3) );
+    REQUIRE( &g.getCellObject(0, 0) == &Cell::shared(true) );
+    REQUIRE( &g.getCellObject(0, 1) == &Cell::shared(false) );
+    REQUIRE( g.getCellObject(1, 1).getType() == Cell::Type::Obstacle );
+    REQUIRE( g.getCellObject(1, 1).isAlive() );
+    g.setObstacle(1, 1, false);
+    REQUIRE( g.getCell(1, 1) );
+    REQUIRE( !g.isObstacle(1, 1) );
+    // copies are independent
+    REQUIRE( copy.equals(g) == false );
+    g.setCell(1, 1, false);
+    REQUIRE( copy.equals(g) );
+    REQUIRE( Cell::shared(true, Cell::Type::Obstacle).toString() == "A" );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] flyweight_cells (" << ms << " ms)\n";
+}
+
+TEST_CASE("grid_arena", "[grid]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] grid_arena\n";
+    Grid a(100, 80), b(100, 80);
+    a.setCell(3, 4, true);
+    a.setObstacle(5, 6, true);
+    GridArena::countAllocations(true);
+    uint64_t before = GridArena::allocationCount();
+    b = a;                          // same size: bulk copy into the existing block
+    b.setGridDimensions(100, 80);   // same size: block reused and cleared
+    b = a;
+    b.setGridDimensions(50, 40);    // smaller: still fits
+    b = a;
+    uint64_t allocs = GridArena::allocationCount() - before;
+    std::cout << "EXPECTED allocations: 0\n";
+    std::cout << "ACTUAL allocations:   " << allocs << "\n";
+    REQUIRE( allocs == 0 );
+    REQUIRE( b.equals(a) );
+    REQUIRE( b.getCell(3, 4) );
+    REQUIRE( b.isObstacle(5, 6) );
+    b.setGridDimensions(100, 80);
+    REQUIRE( !b.getCell(3, 4) );
+    REQUIRE( !b.isObstacle(5, 6) );
+    b.setGridDimensions(200, 200);  // larger: one new block
+    REQUIRE( GridArena::allocationCount() - before == 1 );
+
+    // a running simulation reuses its buffers after the first step
+    GameService svc;
+    svc.setMaxThreads(1);
+    svc.setGridDimensions(64, 64);
+    svc.loadPreset(0);
+    svc.start();
+    svc.step();
+    before = GridArena::allocationCount();
+    svc.advance(10);
+    REQUIRE( GridArena::allocationCount() == before );
+    GridArena::countAllocations(false);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] grid_arena (" << ms << " ms)\n";
+}
+
+TEST_CASE("grid_move_and_shared_initial", "[grid]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] grid_move_and_shared_initial\n";
+    Grid a(30, 40);
+    a.setCell(2, 3, true);
+    a.setObstacle(4, 5, true);
+    GridArena::countAllocations(true);
+    uint64_t before = GridArena::allocationCount();
+    Grid b(std::move(a));
+    Grid c;
+    c = std::move(b);
+    REQUIRE( GridArena::allocationCount() - before == 1 ); // only `c`'s default 20x20 block
+    REQUIRE( c.getR() == 30 );
+    REQUIRE( c.getC() == 40 );
+    REQUIRE( c.getCell(2, 3) );
+    REQUIRE( c.isObstacle(4, 5) );
+    REQUIRE( a.getR() == 0 );
+    REQUIRE( b.getR() == 0 );
+    a = c;                          // a moved-from grid is still usable
+    REQUIRE( a.equals(c) );
+
+    // loading a file: one parse into the scratch grid plus the initial snapshot
+    std::string path = "Input/_move_test.txt";
+    std::filesystem::create_directories("Input");
+    {
+        std::ofstream ofs(path);
+        ofs << "200 300\n";
+        for (int r = 0; r < 200; ++r) {
+            for (int cc = 0; cc < 300; ++cc) ofs << (((r * 7 + cc) % 5) == 0 ? "1 " : "0 ");
+            ofs << "\n";
+        }
+    }
+    GameService svc;
+    before = GridArena::allocationCount();
+    REQUIRE( svc.loadInitialFromFile(path) );
+    uint64_t allocs = GridArena::allocationCount() - before;
+    std::cout << "EXPECTED allocations: <= 2\n";
+    std::cout << "ACTUAL allocations:   " << allocs << "\n";
+    REQUIRE( allocs <= 2 );
+    REQUIRE( svc.getRows() == 200 );
+    REQUIRE( svc.getCell(0, 0) );
+
+    // snapshots are shared, not copied, and survive stepping
+    auto initial = svc.getInitialGrid();
+    REQUIRE( initial );
+    GameService::State st = svc.captureState();
+    REQUIRE( st.initialGrid == initial );
+    svc.start();
+    svc.step();
+    REQUIRE( !svc.getGrid().equals(*initial) );
+    svc.reset();
+    REQUIRE( svc.getGrid().equals(*initial) );
+
+    // a failed load leaves the live grid alone
+    REQUIRE( !svc.loadInitialFromFile("Input/_does_not_exist.txt") );
+    REQUIRE( svc.getRows() == 200 );
+    REQUIRE( svc.getGrid().equals(*initial) );
+    std::filesystem::remove(path);
+    GridArena::countAllocations(false);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] grid_move_and_shared_initial (" << ms << " ms)\n";
+}
+
+TEST_CASE("halo_kernel_matches_rules", "[kernel]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] halo_kernel_matches_rules\n";
+    for (int toric = 0; toric <= 1; ++toric) {
+        for (const char *rule : {"B3/S23", "B36/S125"}) {
+            GameService svc;
+            svc.setMaxThreads(3);
+            svc.setGridDimensions(37, 53);
+            svc.setToric(toric != 0);
+            REQUIRE( svc.setRule(rule) );
+            SoupOptions soup;
+            soup.seed = 11;
+            soup.density = 0.35;
+            svc.loadSoup(soup);
+            svc.setObstacle(5, 0, true);
+            svc.setObstacle(36, 52, true);
+            svc.setCell(36, 52, true);
+            svc.start();
+
+            uint16_t b = 0, s = 0;
+            REQUIRE( LifeLikeRules::parse(rule, b, s) );
+            LifeLikeRules reference(b, s);
+            Grid expected = svc.getGrid();
+            for (int gen = 0; gen < 12; ++gen) {
+                Grid next(expected.getR(), expected.getC());
+                next.setToric(expected.isToric());
+                for (int r = 0; r < expected.getR(); ++r) for (int c = 0; c < expected.getC(); ++c) {
+                    next.setObstacle(r, c, expected.isObstacle(r, c));
+                    next.setCell(r, c, reference.computeNextState(expected, r, c));
+                }
+                expected = next;
+                svc.step();
+                REQUIRE( svc.getGrid().equals(expected) );
+            }
+            std::cout << "toric=" << toric << " " << rule << " population " << svc.getGrid().population() << "\n";
+            REQUIRE( svc.isObstacle(36, 52) );
+            REQUIRE( svc.getCell(36, 52) );
+        }
+    }
+
+    // halo contents: wrap-around copies (corners included) or dead cells
+    Grid g(4, 5);
+    g.setCell(0, 0, true);
+    g.setCell(3, 4, true);
+    g.setToric(true);
+    g.refreshHalo();
+    REQUIRE( g.rowPtr(-1)[-1] == 1 );   // corner = (3,4)
+    REQUIRE( g.rowPtr(4)[5] == 1 );     // corner = (0,0)
+    REQUIRE( g.rowPtr(0)[5] == 1 );     // right of (0,4) = (0,0)
+    g.setToric(false);
+    g.refreshHalo();
+    REQUIRE( g.rowPtr(-1)[-1] == 0 );
+    REQUIRE( g.rowPtr(0)[5] == 0 );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] halo_kernel_matches_rules (" << ms << " ms)\n";
+}
+
+TEST_CASE("tiled_step", "[kernel]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] tiled_step\n";
+    // every tile is handed out exactly once, even when one worker drains the others
+    std::vector<Tile> tiles;
+    TileQueue::buildTiles(100, 70, TileSize{16, 32}, tiles);
+    REQUIRE( tiles.size() == 7 * 3 );
+    REQUIRE( tiles.back().r1 == 100 );
+    REQUIRE( tiles.back().c1 == 70 );
+    TileQueue queue;
+    queue.reset((int)tiles.size(), 4);
+    std::vector<int> seen(tiles.size(), 0);
+    for (int i = queue.next(0); i >= 0; i = queue.next(0)) ++seen[(size_t)i];
+    for (int n : seen) REQUIRE( n == 1 );
+    REQUIRE( queue.steals() > 0 );
+
+    // tiled and banded stepping give the same boards
+    for (int toric = 0; toric <= 1; ++toric) {
+        GameService banded, tiled;
+        for (GameService *svc : {&banded, &tiled}) {
+            svc->setMaxThreads(3);
+            svc->setGridDimensions(90, 130);
+            svc->setToric(toric != 0);
+            SoupOptions soup;
+            soup.seed = 21;
+            soup.density = 0.4;
+            svc->loadSoup(soup);
+            svc->start();
+        }
+        banded.setTilingThreshold(1LL << 40);
+        tiled.setTilingThreshold(0);
+        tiled.setTileSize(TileSize{8, 24});
+        for (int gen = 0; gen < 20; ++gen) {
+            banded.step();
+            tiled.step();
+            REQUIRE( tiled.getGrid().equals(banded.getGrid()) );
+        }
+    }
+    TileSize tuned = TileTuner::tuned();
+    std::cout << "Tuiles choisies: " << tuned.rows << "x" << tuned.cols << "\n";
+    REQUIRE( tuned.rows > 0 );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] tiled_step (" << ms << " ms)\n";
+}
+
+TEST_CASE("numa_bands", "[kernel]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] numa_bands\n";
+    ThreadPool pool(3);
+    for (int toric = 0; toric <= 1; ++toric) {
+        GameService plain, numa;
+        for (GameService *svc : {&plain, &numa}) {
+            svc->setThreadPool(&pool);
+            svc->setGridDimensions(61, 47);
+            svc->setToric(toric != 0);
+            SoupOptions soup;
+            soup.seed = 8;
+            soup.density = 0.45;
+            svc->loadSoup(soup);
+            // obstacles must survive the placement of the bands and every swap
+            svc->setObstacle(0, 0, true);
+            svc->setObstacle(30, 20, true);
+            svc->setObstacle(60, 46, true);
+            svc->start();
+        }
+        numa.setNumaAware(true);
+        for (int gen = 0; gen < 25; ++gen) {
+            plain.step();
+            numa.step();
+            REQUIRE( numa.getGrid().equals(plain.getGrid()) );
+            REQUIRE( numa.isRunning() == plain.isRunning() );
+        }
+        REQUIRE( numa.isObstacle(30, 20) );
+        REQUIRE( numa.isObstacle(60, 46) );
+        // placement survives reset and resizing re-places the bands
+        numa.reset();
+        plain.reset();
+        numa.step();
+        plain.step();
+        REQUIRE( numa.getGrid().equals(plain.getGrid()) );
+    }
+    // a still life is detected as stable from the per-band comparison
+    GameService still;
+    still.setThreadPool(&pool);
+    still.setNumaAware(true);
+    still.setGridDimensions(12, 12);
+    still.setCell(5, 5, true); still.setCell(5, 6, true);
+    still.setCell(6, 5, true); still.setCell(6, 6, true);
+    still.start();
+    still.step();
+    REQUIRE( !still.isRunning() );
+
+    // the bands run on a dedicated pool: the caller's pool stays unpinned
+    REQUIRE( !pool.workersPinned() );
+    REQUIRE( !pool.pinAttempted() );
+    // node cpulists as sysfs writes them; pinning is tried only once
+    REQUIRE( ThreadPool::parseCpuList("0-3,8,10-11\n") == std::vector<int>({0, 1, 2, 3, 8, 10, 11}) );
+    REQUIRE( ThreadPool::parseCpuList("").empty() );
+    ThreadPool pinned(2);
+    bool first = pinned.pinWorkers();
+    REQUIRE( pinned.pinAttempted() );
+    REQUIRE( pinned.pinWorkers() == first );
+    REQUIRE( pinned.workersPinned() == first );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] numa_bands (" << ms << " ms)\n";
+}
+
+TEST_CASE("temporal_blocking", "[kernel]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] temporal_blocking\n";
+    // stepN(k) must be bit-identical to k step() calls, across band edges,
+    // torus wrap, obstacles and worker counts
+    for (int toric = 0; toric <= 1; ++toric) {
+        for (int k : {2, 3, 7}) {
+            for (int bandRows : {0, 5, 11}) {
+                GameService single, blocked;
+                for (GameService *svc : {&single, &blocked}) {
+                    svc->setMaxThreads(3);
+                    svc->setGridDimensions(43, 37);
+                    svc->setToric(toric != 0);
+                    SoupOptions soup;
+                    soup.seed = 40 + (unsigned)k;
+                    soup.density = 0.4;
+                    svc->loadSoup(soup);
+                    svc->setObstacle(20, 10, true);
+                    svc->setObstacle(0, 36, true);
+                    svc->start();
+                }
+                blocked.setTemporalBandRows(bandRows);
+                for (int round = 0; round < 3; ++round) {
+                    for (int i = 0; i < k; ++i) single.step();
+                    blocked.stepN(k);
+                    REQUIRE( blocked.getGrid().equals(single.getGrid()) );
+                    REQUIRE( blocked.getIterationIndex() == single.getIterationIndex() );
+                }
+            }
+        }
+    }
+    // a blinker is never stable, a block becomes stable during the range
+    GameService osc;
+    osc.setGridDimensions(10, 10);
+    osc.setCell(4, 3, true); osc.setCell(4, 4, true); osc.setCell(4, 5, true);
+    osc.start();
+    osc.stepN(4);
+    REQUIRE( osc.isRunning() );
+    REQUIRE( osc.getCell(4, 4) );
+    REQUIRE( osc.getCell(4, 3) );
+    GameService still;
+    still.setGridDimensions(10, 10);
+    still.setCell(2, 2, true); still.setCell(2, 3, true); still.setCell(3, 2, true);
+    still.start();
+    still.stepN(5);
+    std::cout << "EXPECTED: bloc stable, 5 iterations\n";
+    std::cout << "ACTUAL: running=" << still.isRunning() << " iterations=" << still.getIterationIndex() << "\n";
+    REQUIRE( !still.isRunning() );
+    REQUIRE( still.getIterationIndex() == 5 );
+    REQUIRE( still.getCell(3, 3) );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] temporal_blocking (" << ms << " ms)\n";
+}
+
+TEST_CASE("advance_stats", "[service]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] advance_stats\n";
+    // n generations in one call, same board as n step() calls
+    GameService single, multi;
+    for (GameService *svc : {&single, &multi}) {
+        svc->setGridDimensions(16, 16);
+        svc->setToric(true);
+        svc->loadPreset(1);
+        svc->start();
+    }
+    for (int i = 0; i < 12; ++i) single.step();
+    GameService::AdvanceStats stats = multi.advance(12);
+    REQUIRE( stats.stop == GameService::AdvanceStop::Completed );
+    REQUIRE( stats.generations == 12 );
+    REQUIRE( stats.population == 5 );
+    REQUIRE( multi.getIterationIndex() == 12 );
+    REQUIRE( multi.getGrid().equals(single.getGrid()) );
+    REQUIRE( multi.advance(0).generations == 0 );
+
+    // stabilisation ends the run early: three cells become a block
+    GameService still;
+    still.setGridDimensions(10, 10);
+    still.setCell(2, 2, true); still.setCell(2, 3, true); still.setCell(3, 2, true);
+    still.start();
+    stats = still.advance(50);
+    std::cout << "EXPECTED: stable apres 2 generations, population 4\n";
+    std::cout << "ACTUAL: " << stats.generations << " generations, population " << stats.population << "\n";
+    REQUIRE( stats.stop == GameService::AdvanceStop::Stabilized );
+    REQUIRE( stats.generations == 2 );
+    REQUIRE( stats.population == 4 );
+    REQUIRE( !still.isRunning() );
+
+    // predicate and deadline
+    stats = multi.advanceUntil([](const GameService &s) { return s.getIterationIndex() >= 20; });
+    REQUIRE( stats.stop == GameService::AdvanceStop::Predicate );
+    REQUIRE( stats.generations == 8 );
+    stats = multi.advanceUntil(std::chrono::steady_clock::now(), 100);
+    REQUIRE( stats.stop == GameService::AdvanceStop::Deadline );
+    REQUIRE( stats.generations == 1 );
+    stats = multi.advanceUntil(std::chrono::steady_clock::now() + std::chrono::hours(1), 7);
+    REQUIRE( stats.stop == GameService::AdvanceStop::Completed );
+    REQUIRE( stats.generations == 7 );
+    REQUIRE( multi.getIterationIndex() == 28 );
+
+    // one plan for the whole run, on bands and on tiles: same boards as step(),
+    // an edit posted mid-run is picked up, and the stable generation is exact
+    for (long long threshold : {1LL << 40, 0LL}) {
+        GameService stepped, advanced;
+        for (GameService *svc : {&stepped, &advanced}) {
+            svc->setMaxThreads(3);
+            svc->setTilingThreshold(threshold);
+            svc->setTileSize(TileSize{8, 16});
+            svc->setGridDimensions(40, 50);
+            SoupOptions soup;
+            soup.seed = 5;
+            soup.density = 0.35;
+            svc->loadSoup(soup);
+            svc->start();
+        }
+        for (int i = 0; i < 15; ++i) stepped.step();
+        stats = advanced.advance(15);
+        REQUIRE( stats.generations == 15 );
+        REQUIRE( advanced.getGrid().equals(stepped.getGrid()) );
+
+        GameService *target = &advanced;
+        stats = advanced.advanceUntil([target](const GameService &s) {
+            if (s.getIterationIndex() == 17) target->postPreset(1);
+            return false;
+        }, 6);
+        stepped.step(); stepped.step();
+        stepped.postPreset(1);
+        for (int i = 0; i < 4; ++i) stepped.step();
+        REQUIRE( stats.generations == 6 );
+        REQUIRE( advanced.getGrid().getR() == 20 );
+        REQUIRE( advanced.getGrid().equals(stepped.getGrid()) );
+
+        GameService block;
+        block.setTilingThreshold(threshold);
+        block.setTileSize(TileSize{4, 4});
+        block.setGridDimensions(12, 12);
+        block.setCell(5, 5, true); block.setCell(5, 6, true); block.setCell(6, 5, true);
+        block.start();
+        stats = block.advance(50);
+        REQUIRE( stats.stop == GameService::AdvanceStop::Stabilized );
+        REQUIRE( stats.generations == 2 );
+        REQUIRE( stats.population == 4 );
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] advance_stats (" << ms << " ms)\n";
+}
+
+TEST_CASE("distributed_stripes", "[distributed]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] distributed_stripes\n";
+#ifdef _WIN32
+    DistributedService unsupported;
+    REQUIRE( !unsupported.start(Grid(8, 8), LifeLikeRules::kConwayBirth, LifeLikeRules::kConwaySurvive, 2) );
+#else
+    // worker processes exchanging halo rows give the same board as one process,
+    // including the torus wrap between the last and the first stripe
+    for (int toric = 0; toric <= 1; ++toric) {
+        for (int stripes : {1, 2, 3}) {
+            GameService local;
+            local.setGridDimensions(29, 41);
+            local.setToric(toric != 0);
+            SoupOptions soup;
+            soup.seed = 77;
+            soup.density = 0.4;
+            local.loadSoup(soup);
+            local.setObstacle(10, 0, true);
+            local.start();
+
+            DistributedService dist;
+            std::string err;
+            REQUIRE( dist.start(local.getGrid(), LifeLikeRules::kConwayBirth, LifeLikeRules::kConwaySurvive, stripes, &err) );
+            REQUIRE( dist.stripeCount() == stripes );
+            DistributedStats stats;
+            for (int round = 0; round < 3; ++round) {
+                local.advance(5);
+                REQUIRE( dist.advance(5, stats) );
+                REQUIRE( stats.generation == 5 * (round + 1) );
+                REQUIRE( stats.population == local.getGrid().population() );
+                Grid snap;
+                REQUIRE( dist.snapshot(snap) );
+                REQUIRE( snap.equals(local.getGrid()) );
+                REQUIRE( snap.isObstacle(10, 0) );
+            }
+            dist.stop();
+            REQUIRE( !dist.isRunning() );
+        }
+    }
+    // a still life reports no change
+    Grid block(12, 12);
+    block.setCell(5, 5, true); block.setCell(5, 6, true);
+    block.setCell(6, 5, true); block.setCell(6, 6, true);
+    DistributedService still;
+    REQUIRE( still.start(block, LifeLikeRules::kConwayBirth, LifeLikeRules::kConwaySurvive, 4) );
+    DistributedStats stats;
+    REQUIRE( still.advance(3, stats) );
+    std::cout << "EXPECTED: population 4, aucun changement\n";
+    std::cout << "ACTUAL: population " << stats.population << ", changed=" << stats.changed << "\n";
+    REQUIRE( stats.population == 4 );
+    REQUIRE( !stats.changed );
+    REQUIRE( stats.stripePopulation.size() == 4 );
+    REQUIRE( stats.stableGeneration == 1 );
+
+    // an L tromino across a stripe boundary becomes a block at generation 1,
+    // so generation 2 is the first one to change nothing, even inside a batch of 100
+    Grid tromino(12, 12);
+    tromino.setCell(5, 5, true); tromino.setCell(6, 5, true); tromino.setCell(6, 6, true);
+    DistributedService settling;
+    REQUIRE( settling.start(tromino, LifeLikeRules::kConwayBirth, LifeLikeRules::kConwaySurvive, 2) );
+    DistributedStats settled;
+    REQUIRE( settling.advance(100, settled) );
+    std::cout << "EXPECTED: stable at generation 2 ACTUAL: " << settled.stableGeneration << "\n";
+    REQUIRE( settled.stableGeneration == 2 );
+    REQUIRE( settled.generation == 100 );
+    REQUIRE( settled.population == 4 );
+#endif
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] distributed_stripes (" << ms << " ms)\n";
+}
+
+TEST_CASE("edit_queue", "[service]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] edit_queue\n";
+    // commands come out in push order and are applied before the generation
+    GameService svc;
+    svc.setGridDimensions(10, 10);
+    svc.postCells({CellEdit{4, 3, CellEdit::Op::Alive}, CellEdit{4, 4, CellEdit::Op::Alive}, CellEdit{4, 5, CellEdit::Op::Alive}});
+    svc.postCells({CellEdit{0, 0, CellEdit::Op::Alive}});
+    svc.postCells({CellEdit{0, 0, CellEdit::Op::Toggle}, CellEdit{7, 7, CellEdit::Op::Obstacle}, CellEdit{50, 50, CellEdit::Op::Alive}});
+    REQUIRE( svc.hasPendingEdits() );
+    REQUIRE( !svc.getCell(4, 4) );
+    svc.start();
+    svc.step();
+    REQUIRE( !svc.hasPendingEdits() );
+    // the blinker was painted before stepping, so it has turned vertical
+    REQUIRE( svc.getCell(3, 4) );
+    REQUIRE( svc.getCell(5, 4) );
+    REQUIRE( !svc.getCell(4, 3) );
+    REQUIRE( !svc.getCell(0, 0) );
+    REQUIRE( svc.isObstacle(7, 7) );
+    svc.postResize(6, 8);
+    svc.postCells({CellEdit{1, 1, CellEdit::Op::Alive}});
+    REQUIRE( svc.applyPendingEdits() == 2 );
+    REQUIRE( svc.getRows() == 6 );
+    REQUIRE( svc.getCols() == 8 );
+    REQUIRE( svc.getCell(1, 1) );
+    svc.postPreset(4);
+    svc.applyPendingEdits();
+    REQUIRE( svc.getGrid().population() == 4 );
+
+    // a paint stroke takes the opposite of its first cell as seen when applied,
+    // even if that cell changed after the stroke was drawn
+    svc.setGridDimensions(6, 6);
+    svc.postCells({CellEdit{2, 2, CellEdit::Op::Alive}});
+    svc.postCells({CellEdit{2, 2, CellEdit::Op::Paint}, CellEdit{2, 3, CellEdit::Op::Paint}, CellEdit{9, 9, CellEdit::Op::Paint}});
+    svc.applyPendingEdits();
+    REQUIRE( !svc.getCell(2, 2) );
+    REQUIRE( !svc.getCell(2, 3) );
+    svc.postCells({CellEdit{2, 2, CellEdit::Op::Paint}, CellEdit{2, 3, CellEdit::Op::Paint}});
+    svc.applyPendingEdits();
+    REQUIRE( svc.getCell(2, 2) );
+    REQUIRE( svc.getCell(2, 3) );
+
+    // several producers painting while the simulation thread keeps stepping;
+    // with no rule step() only applies the edits
+    GameService board;
+    board.setRuleType(GameService::RuleType::BASIC);
+    board.setGridDimensions(64, 64);
+    const int producers = 4, strokes = 200;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&board, p]() {
+            for (int i = 0; i < strokes; ++i) {
+                std::vector<CellEdit> stroke;
+                int row = p * 16 + i % 16;
+                for (int c = 0; c < 8; ++c) stroke.push_back(CellEdit{row, (i / 16) % 8 * 8 + c, CellEdit::Op::Alive});
+                board.postCells(std::move(stroke));
+            }
+        });
+    }
+    for (int i = 0; i < 100; ++i) board.step();
+    for (auto &t : threads) t.join();
+    board.applyPendingEdits();
+    std::cout << "EXPECTED: population 4096\n";
+    std::cout << "ACTUAL: population " << board.getGrid().population() << "\n";
+    REQUIRE( board.getGrid().population() == 64 * 64 );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] edit_queue (" << ms << " ms)\n";
+}
+
+TEST_CASE("macrocell_format", "[file]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] macrocell_format\n";
+    auto dir = std::filesystem::temp_directory_path();
+    std::string path = (dir / "gol_test.mc").string();
+
+    // round trip of a dense region (live corners keep the bounding box equal to the region)
+    Grid g(45, 70);
+    SoupOptions soup;
+    soup.seed = 12;
+    soup.density = 0.3;
+    SoupGenerator::fill(g, soup);
+    g.setCell(0, 0, true);
+    g.setCell(44, 69, true);
+    REQUIRE( FileService::writeMacrocell(path, g, 0, 0, -1, -1, "B3/S23") );
+    Grid back;
+    std::string rule;
+    REQUIRE( FileService::readMacrocell(path, back, &rule) );
+    REQUIRE( rule == "B3/S23" );
+    REQUIRE( back.equals(g) );
+    // .mc files also go through the generic loader
+    Grid generic;
+    REQUIRE( FileService::readGridFromFile(path, generic) );
+    REQUIRE( generic.equals(g) );
+
+    // identical subtrees are stored once
+    Grid tiled(256, 256);
+    for (int r = 0; r < 256; r += 8) {
+        for (int c = 0; c < 256; c += 8) { tiled.setCell(r + 1, c + 2, true); tiled.setCell(r + 3, c + 3, true); }
+    }
+    QuadTree tree;
+    tree.fromGrid(tiled, 0, 0, 256, 256);
+    REQUIRE( tree.rootLevel() == 8 );
+    REQUIRE( tree.nodeCount() == 7 );   // empty node, one leaf, one node per level 4..8
+    REQUIRE( tree.population(tree.root()) == (uint64_t)tiled.population() );
+
+    // a 2^40 x 2^40 board fits in a few lines
+    QuadTree huge;
+    QuadTree::Id id = huge.leaf(0x0000000000070204ull);   // glider
+    for (int level = 4; level <= 40; ++level) id = huge.node(level, id, 0, 0, id);
+    huge.setRoot(id, 40);
+    REQUIRE( FileService::writeMacrocell(path, huge) );
+    std::cout << "Taille du fichier macrocell 2^40 x 2^40: " << std::filesystem::file_size(path) << " octets\n";
+    REQUIRE( std::filesystem::file_size(path) < 1024 );
+    QuadTree hugeBack;
+    REQUIRE( FileService::readMacrocell(path, hugeBack) );
+    REQUIRE( hugeBack.rootLevel() == 40 );
+    REQUIRE( hugeBack.population(hugeBack.root()) == 5ull << 37 );
+    uint64_t far = (1ull << 40) - 8;
+    REQUIRE( hugeBack.cell(far + 0, far + 2) );
+    REQUIRE( !hugeBack.cell(far + 0, far + 1) );
+    Grid tooBig;
+    REQUIRE( !FileService::readMacrocell(path, tooBig) );
+
+    // a small pattern at the far corner of a level-63 plane loads around its bounding box
+    QuadTree edge;
+    QuadTree::Id corner = edge.leaf(0x0000000000070204ull);
+    for (int level = 4; level <= 63; ++level) corner = edge.node(level, 0, 0, 0, corner);
+    edge.setRoot(corner, 63);
+    REQUIRE( FileService::writeMacrocell(path, edge) );
+    Grid edgeBack;
+    REQUIRE( FileService::readMacrocell(path, edgeBack) );
+    std::cout << "EXPECTED: 3x3, population 5 ACTUAL: " << edgeBack.getR() << "x" << edgeBack.getC()
+              << ", population " << edgeBack.population() << "\n";
+    REQUIRE( edgeBack.getR() == 3 );
+    REQUIRE( edgeBack.getC() == 3 );
+    REQUIRE( edgeBack.population() == 5 );
+    REQUIRE( edgeBack.getCell(2, 2) );
+
+    // hand-written file: leaf lines, a level-4 node and a comment
+    {
+        std::ofstream ofs(path);
+        ofs << "[M2] (golly 4.2)\n#C glider and blinker\n.*$..*$***$\n$$$$$$$***$\n4 1 0 0 2\n";
+    }
+    Grid small;
+    REQUIRE( FileService::readMacrocell(path, small) );
+    std::cout << "EXPECTED: 16x11, population 8\n";
+    std::cout << "ACTUAL: " << small.getR() << "x" << small.getC() << ", population " << small.population() << "\n";
+    REQUIRE( small.getR() == 16 );
+    REQUIRE( small.getC() == 11 );
+    REQUIRE( small.population() == 8 );
+    REQUIRE( small.getCell(0, 1) );
+    REQUIRE( small.getCell(2, 0) );
+    REQUIRE( small.getCell(15, 10) );
+    std::filesystem::remove(path);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] macrocell_format (" << ms << " ms)\n";
+}
+
+TEST_CASE("generation_archive", "[file]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] generation_archive\n";
+
+    // codec round trips: empty, tiny, incompressible, long runs and repeats
+    std::vector<std::vector<uint8_t>> inputs(5);
+    inputs[1] = {1, 2, 3};
+    std::mt19937 rng(7);
+    for (int i = 0; i < 10000; ++i) inputs[2].push_back((uint8_t)rng());
+    inputs[3].assign(100000, 0);
+    for (int i = 0; i < 50000; ++i) inputs[4].push_back((uint8_t)("glider-gun "[i % 11]));
+    for (const auto &in : inputs) {
+        std::vector<uint8_t> packed;
+        BlockCodec::compress(in.data(), in.size(), packed);
+        std::vector<uint8_t> back(in.size());
+        REQUIRE( BlockCodec::decompress(packed.data(), packed.size(), back.data(), back.size()) );
+        REQUIRE( back == in );
+        REQUIRE( packed.size() <= in.size() + in.size() / 255 + 16 );
+    }
+    std::vector<uint8_t> zeros;
+    BlockCodec::compress(inputs[3].data(), inputs[3].size(), zeros);
+    REQUIRE( zeros.size() < 1000 );
+    // truncated input is rejected, not overrun
+    std::vector<uint8_t> out(inputs[3].size());
+    REQUIRE( !BlockCodec::decompress(zeros.data(), zeros.size() - 1, out.data(), out.size()) );
+
+    // every generation of a soup goes to one archive; any one reads back alone
+    GameService svc;
+    svc.setGridDimensions(96, 80);
+    SoupOptions soup;
+    soup.seed = 3;
+    soup.density = 0.35;
+    REQUIRE( svc.loadSoup(soup) );
+    svc.setObstacle(10, 10, true);
+    svc.setOutputBase("test_archive");
+    svc.setOutputMode(OutputMode::Archive);
+    svc.setSaveIterations(40);
+    std::vector<Grid> expected;
+    for (int i = 0; i < 40; ++i) {
+        svc.step();
+        expected.push_back(svc.getGrid());
+    }
+    svc.closeArchive();
+    std::string path = "Output/test_archive.gola";
+    GenerationArchiveReader reader;
+    REQUIRE( reader.open(path) );
+    REQUIRE( reader.hadIndex() );
+    REQUIRE( reader.getFrames().size() == 40 );
+    Grid g;
+    for (int gen : {40, 1, 17}) {
+        REQUIRE( reader.readGeneration(gen, g) );
+        REQUIRE( g.equals(expected[gen - 1]) );
+        REQUIRE( g.isObstacle(10, 10) );
+    }
+    REQUIRE( !reader.readGeneration(41, g) );
+    uint64_t raw = (uint64_t)40 * 96 * 80;
+    // a soup barely compresses past its bit packing; the win is against text output
+    std::cout << "EXPECTED: archive smaller than " << raw / 4 << " bytes (text output: " << raw << "+)\n";
+    std::cout << "ACTUAL: " << std::filesystem::file_size(path) << " bytes\n";
+    REQUIRE( std::filesystem::file_size(path) < raw / 4 );
+
+    // an archive cut short (no index) still yields its complete frames
+    uint64_t cut = reader.getFrames()[30].offset + 5;
+    reader = GenerationArchiveReader();
+    std::filesystem::resize_file(path, cut);
+    REQUIRE( reader.open(path) );
+    REQUIRE( !reader.hadIndex() );
+    REQUIRE( reader.getFrames().size() == 30 );
+    REQUIRE( reader.readGeneration(30, g) );
+    REQUIRE( g.equals(expected[29]) );
+    std::filesystem::remove(path);
+
+    // a run resumed from a checkpoint keeps the generations archived before it
+    {
+        GameService first;
+        first.setGridDimensions(40, 30);
+        REQUIRE( first.loadSoup(soup) );
+        first.setOutputBase("test_archive");
+        first.setOutputMode(OutputMode::Archive);
+        first.setSaveIterations(100);
+        for (int i = 0; i < 10; ++i) first.step();
+        Grid before = first.getGrid();
+        REQUIRE( first.saveCheckpoint("Output/test_archive.ckpt") );
+        for (int i = 0; i < 5; ++i) first.step();
+        first.closeArchive();
+
+        GameService resumed;
+        REQUIRE( resumed.resumeFromCheckpoint("Output/test_archive.ckpt") );
+        resumed.setOutputMode(OutputMode::Archive);
+        for (int i = 0; i < 10; ++i) resumed.step();
+        Grid after = resumed.getGrid();
+        // a resize rolls over to a second file instead of truncating the first
+        resumed.setGridDimensions(12, 12);
+        for (int c = 4; c < 7; ++c) resumed.getGrid().setCell(5, c, true);   // blinker
+        resumed.step();
+        resumed.closeArchive();
+
+        REQUIRE( reader.open(path) );
+        std::cout << "EXPECTED: 25 frames (15 before the resume, 10 after) ACTUAL: " << reader.getFrames().size() << "\n";
+        REQUIRE( reader.getFrames().size() == 25 );
+        REQUIRE( reader.readGeneration(10, g) );
+        REQUIRE( g.equals(before) );
+        REQUIRE( reader.readGeneration(20, g) );
+        REQUIRE( g.equals(after) );
+        GenerationArchiveReader rolled;
+        REQUIRE( rolled.open("Output/test_archive-1.gola") );
+        REQUIRE( rolled.getRows() == 12 );
+        REQUIRE( rolled.getFrames().size() == 1 );
+    }
+    reader = GenerationArchiveReader();
+    std::filesystem::remove(path);
+    std::filesystem::remove("Output/test_archive-1.gola");
+    std::filesystem::remove("Output/test_archive.ckpt");
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] generation_archive (" << ms << " ms)\n";
+}
+
+TEST_CASE("streaming_loader", "[file]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] streaming_loader\n";
+    auto dir = std::filesystem::temp_directory_path();
+    std::string path = (dir / "gol_stream.txt").string();
+
+    // every token form, CRLF endings, short/long rows and a missing last row
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << "4 5\r\n"
+            << "1 0 A D 1\r\n"
+            << "-1 +0 x 02 1z 9 9\r\n"
+            << "\t1   a\r\n";
+    }
+    Grid g;
+    REQUIRE( FileService::readGridFromFile(path, g) );
+    std::string expected = "10AA1\n10011\n1A000\n00000";
+    std::cout << "EXPECTED:\n" << expected << "\n";
+    std::cout << "ACTUAL:\n" << gridToString(g) << "\n";
+    REQUIRE( gridToString(g) == expected );
+    REQUIRE( !g.getCell(0, 3) );
+    REQUIRE( g.getCell(0, 2) );
+
+    // a larger file, read in several chunks, reports progress by bands
+    const int rows = 3000, cols = 400;
+    Grid ref(rows, cols);
+    SoupOptions soup;
+    soup.seed = 5;
+    soup.density = 0.4;
+    SoupGenerator::fill(ref, soup);
+    ref.setObstacle(7, 9, true);
+    REQUIRE( FileService::writeGridIteration("gol_stream_big", 0, ref, dir.string()) );
+    std::string big = (dir / "gol_stream_big_out-0.txt").string();
+    std::vector<int> reports;
+    GridLoadOptions opt;
+    opt.bandRows = 500;
+    opt.progress = [&reports](int done, int total) { reports.push_back(done); return total == rows; };
+    REQUIRE( FileService::streamGridFromFile(big, g, opt) );
+    REQUIRE( g.equals(ref) );
+    REQUIRE( reports.size() >= 2 );
+    REQUIRE( reports.back() == rows );
+    REQUIRE( std::is_sorted(reports.begin(), reports.end()) );
+    opt.progress = [](int, int) { return false; };
+    REQUIRE( !FileService::streamGridFromFile(big, g, opt) );
+
+#ifndef _WIN32
+    // memory-mapped board: the service simulates on it and reset() re-reads the file
+    GameService svc;
+    GridLoadOptions mapped;
+    mapped.backingFile = (dir / "gol_stream.map").string();
+    REQUIRE( svc.streamInitialFromFile(big, mapped) );
+    REQUIRE( svc.getGrid().isMapped() );
+    REQUIRE( !std::filesystem::exists(mapped.backingFile) );
+    REQUIRE( svc.getGrid().equals(ref) );
+    GameService heap;
+    heap.setInitialGrid(ref);
+    svc.advance(5);
+    heap.advance(5);
+    REQUIRE( svc.getGrid().equals(heap.getGrid()) );
+    REQUIRE( svc.reset() );
+    REQUIRE( svc.getIterationIndex() == 0 );
+    REQUIRE( svc.getGrid().equals(ref) );
+
+    // a scratch file that cannot be mapped fails the load instead of being ignored
+    GameService unmappable;
+    GridLoadOptions nowhere;
+    nowhere.backingFile = (dir / "gol_no_such_dir" / "gol_stream.map").string();
+    REQUIRE( !unmappable.streamInitialFromFile(big, nowhere) );
+    REQUIRE( !unmappable.getGrid().isMapped() );
+    REQUIRE( unmappable.getGrid().getR() == 20 );
+#endif
+    // reset() reports a streamed input that is gone, and tries it again later
+    GameService streamed;
+    REQUIRE( streamed.streamInitialFromFile(path, GridLoadOptions()) );
+    std::filesystem::remove(path);
+    REQUIRE( !streamed.reset() );
+    REQUIRE( streamed.getGrid().getR() == 20 );
+    REQUIRE( streamed.getGrid().population() == 0 );
+    {
+        std::ofstream ofs(path);
+        ofs << "2 2\n1 1\n1 1\n";
+    }
+    REQUIRE( streamed.reset() );
+    REQUIRE( streamed.getGrid().population() == 4 );
+    std::filesystem::remove(path);
+    std::filesystem::remove(big);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] streaming_loader (" << ms << " ms)\n";
+}
+
+TEST_CASE("out_of_core_stripes", "[kernel]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] out_of_core_stripes\n";
+#ifndef _WIN32
+    std::string backing = (std::filesystem::temp_directory_path() / "gol_ooc.map").string();
+    for (bool toric : {false, true}) {
+        Grid start(100, 90);
+        SoupOptions soup;
+        soup.seed = toric ? 8 : 9;
+        soup.density = 0.4;
+        SoupGenerator::fill(start, soup);
+        start.setObstacle(50, 3, true);
+        GameService ref, ooc;
+        for (GameService *s : {&ref, &ooc}) {
+            s->setInitialGrid(start);
+            s->setToric(toric);
+        }
+        REQUIRE( ooc.setOutOfCore(backing) );
+        REQUIRE( ooc.isOutOfCore() );
+        REQUIRE( ooc.getGrid().equals(start) );
+        // stripes that do not divide the board, down to a single row
+        for (int stripe : {7, 1, 0}) {
+            ooc.setStripeRows(stripe);
+            ref.advance(10);
+            ooc.advance(10);
+            REQUIRE( ooc.getGrid().equals(ref.getGrid()) );
+            REQUIRE( ooc.getIterationIndex() == ref.getIterationIndex() );
+        }
+        REQUIRE( ooc.isOutOfCore() );
+        std::cout << "EXPECTED: " << ref.getGrid().hash() << "\n";
+        std::cout << "ACTUAL: " << ooc.getGrid().hash() << "\n";
+    }
+
+    // stabilisation is detected from the stripes' change flags
+    GameService block;
+    block.setGridDimensions(40, 40);
+    block.setCell(10, 10, true); block.setCell(10, 11, true);
+    block.setCell(11, 10, true); block.setCell(11, 11, true);
+    REQUIRE( block.setOutOfCore(backing) );
+    block.setStripeRows(6);
+    auto stats = block.advance(5);
+    REQUIRE( stats.stop == GameService::AdvanceStop::Stabilized );
+    REQUIRE( block.getGrid().population() == 4 );
+    // and back to the heap
+    REQUIRE( block.setOutOfCore("") );
+    REQUIRE( !block.isOutOfCore() );
+    REQUIRE( block.getGrid().population() == 4 );
+    // a scratch file that cannot be mapped leaves both generations on the heap
+    std::filesystem::create_directories(backing + ".next");
+    REQUIRE( !block.setOutOfCore(backing) );
+    REQUIRE( !block.isOutOfCore() );
+    REQUIRE( !block.getGrid().isMapped() );
+    REQUIRE( block.getGrid().population() == 4 );
+    std::filesystem::remove_all(backing + ".next");
+#endif
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] out_of_core_stripes (" << ms << " ms)\n";
+}
+
+TEST_CASE("pattern_library", "[file]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] pattern_library\n";
+    auto root = std::filesystem::temp_directory_path() / "gol_library";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "oscillators" / "p2");
+    std::filesystem::create_directories(root / "ships");
+    std::string index = (root / ".library.idx").string();
+
+    auto writeText = [](const std::filesystem::path &p, const std::string &body) { std::ofstream(p) << body; };
+    writeText(root / "block.txt", "4 4\n0 0 0 0\n0 1 1 0\n0 1 1 0\n0 0 0 0\n");
+    writeText(root / "oscillators" / "p2" / "blinker.txt", "3 3\n0 1 0\n0 1 0\n0 1 0\n");
+    writeText(root / "oscillators" / "notes.md", "not a pattern\n");
+    writeText(root / "ships" / "broken.txt", "no header\n");
+    Grid glider(3, 3);
+    glider.setCell(0, 1, true); glider.setCell(1, 2, true);
+    glider.setCell(2, 0, true); glider.setCell(2, 1, true); glider.setCell(2, 2, true);
+    REQUIRE( FileService::writeMacrocell((root / "ships" / "glider.mc").string(), glider, 0, 0, -1, -1, "B3/S23") );
+
+    ThreadPool pool(3);
+    PatternLibrary lib;
+    REQUIRE( lib.load(root.string(), index, pool) );
+    std::cout << "EXPECTED: 4 files, 0 reused, 4 parsed\n";
+    std::cout << "ACTUAL: " << lib.lastScan().files << " files, " << lib.lastScan().reused << " reused, " << lib.lastScan().parsed << " parsed\n";
+    REQUIRE( lib.lastScan().files == 4 );
+    REQUIRE( lib.lastScan().parsed == 4 );
+    REQUIRE( std::filesystem::exists(index) );
+
+    const PatternInfo *blinker = lib.findByName("blinker");
+    REQUIRE( blinker != nullptr );
+    REQUIRE( blinker->rows == 3 );
+    REQUIRE( blinker->population == 3 );
+    const PatternInfo *g = lib.findByName("glider");
+    REQUIRE( g != nullptr );
+    REQUIRE( g->format == PatternInfo::Format::Macrocell );
+    REQUIRE( g->rule == "B3/S23" );
+    REQUIRE( g->rows == 3 );
+    REQUIRE( g->cols == 3 );
+    REQUIRE( g->population == 5 );
+    REQUIRE( lib.findByName("broken") != nullptr );
+    REQUIRE( !lib.findByName("broken")->valid );
+    REQUIRE( lib.findByName("notes") == nullptr );
+
+    PatternQuery q;
+    REQUIRE( lib.find(q).size() == 3 );
+    q.name = "LIN";
+    REQUIRE( lib.find(q).size() == 1 );
+    q = PatternQuery();
+    q.rule = "b3/s23";
+    REQUIRE( lib.find(q).size() == 1 );
+    q = PatternQuery();
+    q.minPopulation = 4;
+    q.maxRows = 3;
+    REQUIRE( lib.find(q).size() == 1 );
+
+    // warm start: nothing parsed; then one file changes and one disappears
+    PatternLibrary warm;
+    REQUIRE( warm.load(root.string(), index, pool) );
+    REQUIRE( warm.lastScan().reused == 4 );
+    REQUIRE( warm.lastScan().parsed == 0 );
+    REQUIRE( warm.findByName("blinker")->hash == blinker->hash );
+    writeText(root / "block.txt", "4 5\n0 0 0 0 0\n0 1 1 0 0\n0 1 1 0 0\n0 0 0 0 0\n");
+    std::filesystem::remove(root / "ships" / "broken.txt");
+    REQUIRE( warm.load(root.string(), index, pool) );
+    REQUIRE( warm.lastScan().files == 3 );
+    REQUIRE( warm.lastScan().parsed == 1 );
+    REQUIRE( warm.findByName("block")->cols == 5 );
+    PatternLibrary again;
+    REQUIRE( again.load(root.string(), index, pool) );
+    REQUIRE( again.lastScan().parsed == 0 );
+    REQUIRE( again.findByName("broken") == nullptr );
+    REQUIRE( !lib.load((root / "missing").string(), index, pool) );
+    std::filesystem::remove_all(root);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] pattern_library (" << ms << " ms)\n";
+}
+
+TEST_CASE("frame_export", "[file]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] frame_export\n";
+    auto dir = std::filesystem::temp_directory_path() / "gol_frames";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto readAll = [](const std::filesystem::path &p) {
+        std::ifstream ifs(p, std::ios::binary);
+        return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    };
+    auto be32 = [](const uint8_t *p) { return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]; };
+
+    // reference checksums
+    const uint8_t digits[] = "123456789";
+    REQUIRE( DeflateStream::crc32(digits, 9) == 0xCBF43926u );
+    const uint8_t wiki[] = "Wikipedia";
+    REQUIRE( DeflateStream::adler32(wiki, 9) == 0x11E60398u );
+
+    Grid g(3, 70);
+    g.setCell(0, 0, true);
+    g.setCell(2, 69, true);
+    g.setObstacle(1, 1, true);
+    ImageOptions opt;
+    opt.scale = 2;
+    opt.format = ImageOptions::Format::Ppm;
+    REQUIRE( FileService::writeImage((dir / "g.ppm").string(), g, opt) );
+    auto ppm = readAll(dir / "g.ppm");
+    std::string header = "P6\n140 6\n255\n";
+    REQUIRE( ppm.size() == header.size() + 140 * 6 * 3 );
+    REQUIRE( std::equal(header.begin(), header.end(), ppm.begin()) );
+    auto pixel = [&](int x, int y) {
+        const uint8_t *p = ppm.data() + header.size() + ((size_t)y * 140 + x) * 3;
+        return (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+    };
+    REQUIRE( pixel(1, 1) == opt.alive );
+    REQUIRE( pixel(2, 0) == opt.dead );
+    REQUIRE( pixel(3, 3) == opt.obstacle );
+    REQUIRE( pixel(139, 5) == opt.alive );
+
+    // PNG: valid chunk sequence and CRCs, 2-bit palette image, long runs compress
+    opt.format = ImageOptions::Format::Png;
+    opt.scale = 1;
+    Grid big(512, 512);
+    big.setCell(100, 100, true);
+    REQUIRE( FileService::writeImage((dir / "big.png").string(), big, opt) );
+    auto png = readAll(dir / "big.png");
+    REQUIRE( png.size() > 8 );
+    REQUIRE( png[1] == 'P' );
+    std::vector<std::string> chunks;
+    size_t p = 8;
+    while (p + 12 <= png.size()) {
+        uint32_t len = be32(png.data() + p);
+        REQUIRE( p + 12 + len <= png.size() );
+        chunks.push_back(std::string(png.begin() + (long)p + 4, png.begin() + (long)p + 8));
+        REQUIRE( DeflateStream::crc32(png.data() + p + 4, len + 4) == be32(png.data() + p + 8 + len) );
+        if (chunks.back() == "IHDR") {
+            REQUIRE( be32(png.data() + p + 8) == 512u );
+            REQUIRE( png[p + 16] == 2 );
+            REQUIRE( png[p + 17] == 3 );
+        }
+        p += 12 + len;
+    }
+    REQUIRE( p == png.size() );
+    REQUIRE( chunks == std::vector<std::string>({"IHDR", "PLTE", "IDAT", "IEND"}) );
+    std::cout << "EXPECTED: PNG 512x512 much smaller than its 65536 raw bytes\n";
+    std::cout << "ACTUAL: " << png.size() << " bytes\n";
+    REQUIRE( png.size() < 4096 );
+
+    // decoded back, pixel for pixel: every colour at scale 1 and 3, and the
+    // large board whose stream spans several blocks and long matches
+    auto sameImage = [&opt](const std::vector<uint8_t> &file, const Grid &grid, int scale) {
+        int w = 0, h = 0;
+        std::vector<uint32_t> px;
+        if (!decodePng(file, w, h, px) || w != grid.getC() * scale || h != grid.getR() * scale) return false;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                int r = y / scale, c = x / scale;
+                uint32_t want = grid.isObstacle(r, c) ? opt.obstacle : grid.getCell(r, c) ? opt.alive : opt.dead;
+                if (px[(size_t)y * w + x] != want) return false;
+            }
+        }
+        return true;
+    };
+    REQUIRE( sameImage(png, big, 1) );
+    std::vector<uint8_t> corrupt = png;
+    corrupt[corrupt.size() / 2] ^= 0x10;
+    REQUIRE( !sameImage(corrupt, big, 1) );
+    Grid tiny(5, 11);
+    tiny.setCell(0, 0, true);
+    tiny.setCell(2, 5, true);
+    tiny.setCell(4, 10, true);
+    tiny.setObstacle(1, 3, true);
+    tiny.setObstacle(3, 9, true);
+    for (int scale : {1, 3}) {
+        opt.scale = scale;
+        REQUIRE( FileService::writeImage((dir / "tiny.png").string(), tiny, opt) );
+        REQUIRE( sameImage(readAll(dir / "tiny.png"), tiny, scale) );
+    }
+    opt.scale = 1;
+
+    // sequence written in the background by the service
+    GameService svc;
+    svc.setGridDimensions(64, 64);
+    SoupOptions soup;
+    soup.seed = 4;
+    REQUIRE( svc.loadSoup(soup) );
+    svc.setOutputBase("seq");
+    REQUIRE( svc.startFrameExport(dir.string(), opt, 2) );
+    svc.advance(10);
+    svc.stepN(4);
+    svc.stopFrameExport();
+    REQUIRE( svc.getFrameExporter().framesWritten() == 7 );
+    REQUIRE( svc.getFrameExporter().writeFailures() == 0 );
+    REQUIRE( std::filesystem::exists(dir / "seq_2.png") );
+    REQUIRE( std::filesystem::exists(dir / "seq_14.png") );
+    REQUIRE( !std::filesystem::exists(dir / "seq_3.png") );
+    REQUIRE( sameImage(readAll(dir / "seq_14.png"), svc.getGrid(), 1) );
+    std::filesystem::remove_all(dir);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] frame_export (" << ms << " ms)\n";
+}
+
+TEST_CASE("obstacle_layer", "[obstacle]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] obstacle_layer\n";
+
+    // rows without obstacles have no mask; cell bytes only hold the alive bit
+    Grid a(16, 40);
+    REQUIRE( a.obstacleMask() == nullptr );
+    a.setCell(3, 7, true);
+    a.setObstacle(3, 7, true);
+    a.setObstacle(9, 0, true);
+    REQUIRE( a.obstacleMask() != nullptr );
+    REQUIRE( a.obstacleMask()->count() == 2 );
+    REQUIRE( a.obstacleMask()->row(3) != nullptr );
+    REQUIRE( a.obstacleMask()->row(4) == nullptr );
+    REQUIRE( a.rowPtr(3)[7] == Grid::kAlive );
+    REQUIRE( a.getCell(3, 7) );
+
+    // copies share the layer; the first edit copies it once
+    Grid b(a);
+    REQUIRE( b.obstacleMask() == a.obstacleMask() );
+    b.setObstacle(9, 0, false);
+    REQUIRE( b.obstacleMask() != a.obstacleMask() );
+    REQUIRE( a.isObstacle(9, 0) );
+    REQUIRE( !b.isObstacle(9, 0) );
+    REQUIRE( b.obstacleMask()->row(9) == nullptr );
+    REQUIRE( !a.equals(b) );
+    b.setObstacle(3, 7, false);
+    REQUIRE( b.obstacleMask() == nullptr );
+
+    // stepping keeps the very same layer: nothing is rebuilt per generation
+    GameService svc;
+    svc.setGridDimensions(32, 32);
+    svc.setToric(true);
+    for (int c = 10; c < 13; ++c) svc.getGrid().setCell(15, c, true);
+    svc.setObstacle(14, 11, true);
+    svc.getGrid().setCell(14, 11, true);
+    svc.setObstacle(0, 31, true);
+    const ObstacleMask *layer = svc.getGrid().obstacleMask();
+    svc.advance(6);
+    svc.stepN(4);
+    std::cout << "EXPECTED: same obstacle layer after 10 generations, alive obstacle kept\n";
+    std::cout << "ACTUAL: " << (svc.getGrid().obstacleMask() == layer ? "same" : "rebuilt")
+              << ", (14,11) " << (svc.getGrid().getCell(14, 11) ? "alive" : "dead") << "\n";
+    REQUIRE( svc.getGrid().obstacleMask() == layer );
+    REQUIRE( svc.isObstacle(14, 11) );
+    REQUIRE( svc.getGrid().getCell(14, 11) );
+    REQUIRE( svc.isObstacle(0, 31) );
+    REQUIRE( !svc.getGrid().getCell(0, 31) );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] obstacle_layer (" << ms << " ms)\n";
+}
+
+TEST_CASE("topologies", "[toric]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] topologies\n";
+    const Topology all[] = {Topology::Bounded, Topology::Torus, Topology::KleinBottle,
+                            Topology::ProjectivePlane, Topology::Reflective, Topology::AliveBorder};
+
+    // the halo holds exactly what getCell maps outside positions to
+    for (Topology t : all) {
+        Grid g(6, 9);
+        SoupOptions soup;
+        soup.seed = 21;
+        soup.density = 0.5;
+        SoupGenerator::fill(g, soup);
+        g.setTopology(t);
+        g.refreshHalo();
+        for (int r = -1; r <= g.getR(); ++r) {
+            for (int c = -1; c <= g.getC(); ++c) {
+                bool inside = r >= 0 && r < g.getR() && c >= 0 && c < g.getC();
+                if (inside) continue;
+                bool expected = t == Topology::Bounded ? false : g.getCell(r, c);
+                if ((g.rowPtr(r)[c] != 0) != expected) {
+                    std::cout << Grid::topologyName(t) << " halo (" << r << "," << c << ") EXPECTED " << expected
+                              << " ACTUAL " << (int)g.rowPtr(r)[c] << "\n";
+                }
+                REQUIRE( (g.rowPtr(r)[c] != 0) == expected );
+            }
+        }
+    }
+
+    // which cell each glued edge shows, on a 4x5 board
+    Grid g(4, 5);
+    g.setCell(0, 1, true);
+    g.setTopology(Topology::KleinBottle);
+    g.refreshHalo();
+    REQUIRE( g.rowPtr(4)[3] == 1 );     // below (3,3): (0,1), columns mirrored
+    REQUIRE( g.rowPtr(-1)[1] == 0 );
+    g.setCell(0, 1, false);
+    g.setCell(1, 0, true);
+    g.setTopology(Topology::ProjectivePlane);
+    g.refreshHalo();
+    REQUIRE( g.rowPtr(2)[5] == 1 );     // right of (2,4): (1,0), rows mirrored
+    g.setCell(1, 0, false);
+    g.setCell(0, 0, true);
+    g.setTopology(Topology::Reflective);
+    g.refreshHalo();
+    REQUIRE( g.rowPtr(-1)[-1] == 1 );
+    REQUIRE( g.rowPtr(-1)[0] == 1 );
+    REQUIRE( g.rowPtr(4)[0] == 0 );
+    REQUIRE( g.getTopology() == Topology::Reflective );
+    REQUIRE( !g.isToric() );
+
+    // optimized step (halo + kernel, several threads) against the per-cell rules
+    for (Topology t : all) {
+        GameService svc;
+        svc.setMaxThreads(3);
+        svc.setGridDimensions(29, 41);
+        svc.setTopology(t);
+        SoupOptions soup;
+        soup.seed = 12;
+        soup.density = 0.4;
+        svc.loadSoup(soup);
+        svc.setObstacle(0, 40, true);
+        svc.start();
+        ConwayRules reference;
+        Grid expected = svc.getGrid();
+        for (int gen = 0; gen < 10; ++gen) {
+            Grid next(expected);
+            for (int r = 0; r < expected.getR(); ++r) for (int c = 0; c < expected.getC(); ++c) {
+                next.setCell(r, c, reference.computeNextState(expected, r, c));
+            }
+            expected = next;
+        }
+        svc.stepN(10);
+        std::cout << Grid::topologyName(t) << ": EXPECTED population " << expected.population()
+                  << " ACTUAL " << svc.getGrid().population() << "\n";
+        REQUIRE( svc.getGrid().equals(expected) );
+        REQUIRE( svc.getTopology() == t );
+    }
+
+    // batch manifests and checkpoints carry the topology
+    BatchJob job;
+    REQUIRE( BatchService::parseJobLine("name=k seed=3 size=16x16 topology=klein gens=5", job) );
+    REQUIRE( job.topology == Topology::KleinBottle );
+    REQUIRE( !BatchService::parseJobLine("name=x topology=sphere", job) );
+    GameService svc;
+    svc.setTopology(Topology::ProjectivePlane);
+    auto dir = std::filesystem::temp_directory_path() / "gol_topologies";
+    std::filesystem::create_directories(dir);
+    std::string ckpt = (dir / "p.ckpt").string();
+    REQUIRE( svc.saveCheckpoint(ckpt) );
+    GameService resumed;
+    REQUIRE( resumed.resumeFromCheckpoint(ckpt) );
+    REQUIRE( resumed.getTopology() == Topology::ProjectivePlane );
+    std::filesystem::remove_all(dir);
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] topologies (" << ms << " ms)\n";
+}
+
+TEST_CASE("neighborhoods", "[rules]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] neighborhoods\n";
+
+    // rule strings round-trip with their neighbourhood suffix
+    uint16_t b = 0, s = 0;
+    Neighborhood n;
+    REQUIRE( LifeLikeRules::parse("B2/S34H", b, s, n) );
+    REQUIRE( n == Neighborhood::hexagonal() );
+    REQUIRE( LifeLikeRules::format(b, s, n) == "B2/S34H" );
+    REQUIRE( LifeLikeRules::parse("b1/s1v", b, s, n) );
+    REQUIRE( n == Neighborhood::vonNeumann() );
+    REQUIRE( LifeLikeRules::parse("B3/S23N5F", b, s, n) );
+    REQUIRE( n == Neighborhood::custom(0x5F) );
+    REQUIRE( LifeLikeRules::format(b, s, n) == "B3/S23N5F" );
+    REQUIRE( LifeLikeRules::parse("23/3T", b, s, n) );
+    REQUIRE( n == Neighborhood::triangular() );
+    REQUIRE( LifeLikeRules::parse("B3/S23", b, s, n) );
+    REQUIRE( n.isMoore() );
+    REQUIRE( !LifeLikeRules::parse("B3/S23Q", b, s, n) );
+    REQUIRE( !LifeLikeRules::parse("B3/S23N5", b, s, n) );
+    // the Moore-only form refuses the others
+    REQUIRE( !LifeLikeRules::parse("B2/S34H", b, s) );
+
+    // hand-checked counts: cell (1,1) with all 8 neighbours alive
+    Grid full(3, 3);
+    for (int r = 0; r < 3; ++r) for (int c = 0; c < 3; ++c) full.setCell(r, c, r != 1 || c != 1);
+    // a rule whose only birth count is `count` shows what the mask counts
+    auto bornWith = [&](Neighborhood hood, int count) {
+        return LifeLikeRules(1u << count, 0, hood).computeNextState(full, 1, 1);
+    };
+    REQUIRE( bornWith(Neighborhood::moore(), 8) );
+    REQUIRE( bornWith(Neighborhood::vonNeumann(), 4) );
+    REQUIRE( bornWith(Neighborhood::hexagonal(), 6) );
+    REQUIRE( bornWith(Neighborhood::triangular(), 3) );
+    REQUIRE( bornWith(Neighborhood::custom(0x03), 2) );
+
+    // specialised kernels (rows, tiles, several threads) against the per-cell rules
+    const char *rules[] = {"B2/S34H", "B1/S12V", "B2/S13T", "B3/S23N5F", "B36/S125H"};
+    const Topology tops[] = {Topology::Bounded, Topology::Torus, Topology::Reflective};
+    for (const char *rule : rules) {
+        for (Topology t : tops) {
+            for (int tiled = 0; tiled <= 1; ++tiled) {
+                GameService svc;
+                svc.setMaxThreads(3);
+                svc.setGridDimensions(30, 41);
+                svc.setTopology(t);
+                if (tiled) {
+                    svc.setTileSize(TileSize{7, 13});
+                    svc.setTilingThreshold(0);
+                }
+                REQUIRE( svc.setRule(rule) );
+                REQUIRE( svc.getRuleString() == rule );
+                SoupOptions soup;
+                soup.seed = 31;
+                soup.density = 0.4;
+                svc.loadSoup(soup);
+                svc.setObstacle(3, 5, true);
+                svc.start();
+                LifeLikeRules::parse(rule, b, s, n);
+                LifeLikeRules reference(b, s, n);
+                Grid expected = svc.getGrid();
+                for (int gen = 0; gen < 8; ++gen) {
+                    Grid next(expected);
+                    for (int r = 0; r < expected.getR(); ++r) for (int c = 0; c < expected.getC(); ++c) {
+                        next.setCell(r, c, expected.isObstacle(r, c) ? expected.getCell(r, c) : reference.computeNextState(expected, r, c));
+                    }
+                    expected = next;
+                }
+                svc.stepN(8);
+                std::cout << rule << " " << Grid::topologyName(t) << (tiled ? " tiles" : " rows") << ": EXPECTED population "
+                          << expected.population() << " ACTUAL " << svc.getGrid().population() << "\n";
+                REQUIRE( svc.getGrid().equals(expected) );
+            }
+        }
+    }
+
+    // the neighbourhood follows the service's rule and its checkpoints
+    GameService svc;
+    svc.setNeighborhood(Neighborhood::hexagonal());
+    REQUIRE( svc.getRuleType() == GameService::RuleType::LIFE_LIKE );
+    REQUIRE( svc.getRuleString() == "B3/S23H" );
+    auto dir = std::filesystem::temp_directory_path() / "gol_neighborhoods";
+    std::filesystem::create_directories(dir);
+    std::string ckpt = (dir / "h.ckpt").string();
+    REQUIRE( svc.saveCheckpoint(ckpt) );
+    GameService resumed;
+    REQUIRE( resumed.resumeFromCheckpoint(ckpt) );
+    REQUIRE( resumed.getNeighborhood() == Neighborhood::hexagonal() );
+    REQUIRE( resumed.getRuleString() == "B3/S23H" );
+    std::filesystem::remove_all(dir);
+    svc.setRuleType(GameService::RuleType::CONWAY);
+    REQUIRE( svc.getNeighborhood().isMoore() );
+
+    // wrapped boards must stay valid tilings: odd hexagonal rows or odd
+    // triangular sides do not close a torus, mirrored joins never do
+    REQUIRE( Neighborhood::hexagonal().fits(10, 7, Topology::Torus) );
+    REQUIRE( !Neighborhood::hexagonal().fits(9, 8, Topology::Torus) );
+    REQUIRE( Neighborhood::triangular().fits(10, 8, Topology::Torus) );
+    REQUIRE( !Neighborhood::triangular().fits(10, 7, Topology::Torus) );
+    REQUIRE( !Neighborhood::triangular().fits(9, 8, Topology::Torus) );
+    REQUIRE( !Neighborhood::hexagonal().fits(10, 10, Topology::KleinBottle) );
+    REQUIRE( !Neighborhood::triangular().fits(10, 10, Topology::ProjectivePlane) );
+    REQUIRE( Neighborhood::hexagonal().fits(9, 7, Topology::Bounded) );
+    REQUIRE( Neighborhood::triangular().fits(9, 7, Topology::Reflective) );
+    REQUIRE( Neighborhood::vonNeumann().fits(9, 7, Topology::KleinBottle) );
+    GameService hex;
+    REQUIRE( hex.setRule("B2/S34H") );
+    hex.setGridDimensions(9, 8);
+    hex.setTopology(Topology::Torus);
+    REQUIRE( !hex.tilingValid() );
+    hex.setGridDimensions(8, 9);
+    REQUIRE( hex.tilingValid() );
+    BatchJob oddHex;
+    oddHex.rule = "B2/S34H";
+    oddHex.rows = 9;
+    oddHex.cols = 8;
+    oddHex.topology = Topology::Torus;
+    ThreadPool pool(1);
+    REQUIRE( BatchService::runJob(oddHex, pool, false).error.find("does not tile") != std::string::npos );
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] neighborhoods (" << ms << " ms)\n";
+}
+
+TEST_CASE("rule_kernels", "[kernel]") {
+    auto t0 = std::chrono::steady_clock::now();
+    std::cout << "[DEBUT] rule_kernels\n";
+
+    // the compiled-in rules and a fallback one
+    const char *rules[] = {"B3/S23", "B36/S23", "B2/S", "B3678/S34678", "B36/S245"};
+    const bool specialised[] = {true, true, true, true, false};
+    std::mt19937 rng(7);
+    for (int i = 0; i < 5; ++i) {
+        uint16_t birth = 0, survive = 0;
+        REQUIRE( LifeLikeRules::parse(rules[i], birth, survive) );
+        REQUIRE( StepKernel::hasSpecialisedRule(birth, survive) == specialised[i] );
+        // widths below, at and past the 16-cell blocks
+        for (int cols : {1, 15, 16, 17, 53}) {
+            Grid g(3, cols);
+            for (int r = 0; r < 3; ++r) for (int c = 0; c < cols; ++c) g.setCell(r, c, rng() & 1);
+            g.setToric(true);
+            g.refreshHalo();
+            std::vector<uint8_t> obstacles((size_t)cols, 0);
+            for (int c = 0; c < cols; c += 3) obstacles[(size_t)c] = 0xFF;
+            for (int masked = 0; masked <= 1; ++masked) {
+                const uint8_t *mask = masked ? obstacles.data() : nullptr;
+                std::vector<uint8_t> expected((size_t)cols), actual((size_t)cols);
+                StepKernel::lifeRow(g.rowPtr(0), g.rowPtr(1), g.rowPtr(2), expected.data(), cols, birth, survive, mask);
+                StepKernel::ruleRow(birth, survive, masked != 0)(g.rowPtr(0), g.rowPtr(1), g.rowPtr(2), actual.data(), cols, birth, survive, mask);
+                if (expected != actual) std::cout << rules[i] << " width " << cols << (masked ? " masked" : "") << ": kernels differ\n";
+                REQUIRE( expected == actual );
+            }
+        }
+    }
+
+    // the service resolves the kernel with the rule and keeps matching the per-cell rules
+    for (const char *rule : rules) {
+        GameService svc;
+        svc.setMaxThreads(2);
+        svc.setGridDimensions(37, 45);
+        svc.setToric(true);
+        REQUIRE( svc.setRule(rule) );
+        SoupOptions soup;
+        soup.seed = 4;
+        soup.density = 0.45;
+        svc.loadSoup(soup);
+        svc.setObstacle(10, 10, true);
+        svc.start();
+        uint16_t birth = 0, survive = 0;
+        LifeLikeRules::parse(rule, birth, survive);
+        LifeLikeRules reference(birth, survive);
+        Grid expected = svc.getGrid();
+        for (int gen = 0; gen < 6; ++gen) {
+            Grid next(expected);
+            for (int r = 0; r < expected.getR(); ++r) for (int c = 0; c < expected.getC(); ++c) {
+                next.setCell(r, c, expected.isObstacle(r, c) ? expected.getCell(r, c) : reference.computeNextState(expected, r, c));
+            }
+            expected = next;
+        }
+        for (int gen = 0; gen < 3; ++gen) svc.step();
+        svc.stepN(3);
+        std::cout << rule << ": EXPECTED population " << expected.population() << " ACTUAL " << svc.getGrid().population() << "\n";
+        REQUIRE( svc.getGrid().equals(expected) );
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::cout << "[FIN] rule_kernels (" << ms << " ms)\n";
+}